@@ -0,0 +1,274 @@
+#include "EffectChain.h"
+#include "Host/PluginInstanceFormat.h"
+#include "Host/PluginInstanceProxy.h"
+
+#include "Host/PluginInstanceIncludedHeader.inl"
+
+namespace
+{
+    using Constructor = std::function<std::unique_ptr<juce::AudioPluginInstance>()>;
+    using UpdateKind = juce::AudioProcessorGraph::UpdateKind;
+
+    struct FactoryEntry
+    {
+        juce::String name;
+        Constructor constructor;
+        bool isEffect;
+    };
+
+    // The Host's internal plugin list, looked up by name like PluginInstanceFormat does.
+    const std::vector<FactoryEntry> &GetFactory()
+    {
+        static const std::vector<FactoryEntry> factory = []
+        {
+            const std::vector<Constructor> constructors{
+#include "Host/PluginInstanceFactoryCreation.inl"
+            };
+
+            std::vector<FactoryEntry> entries;
+            for (const auto &constructor : constructors)
+            {
+                const auto instance = constructor();
+                entries.push_back({ instance->getName(), constructor, dynamic_cast<PluginInstanceProxy *>(instance.get()) != nullptr });
+            }
+            return entries;
+        }();
+
+        return factory;
+    }
+
+    std::unique_ptr<juce::AudioPluginInstance> CreateInstance(const juce::String &name, bool effectsOnly)
+    {
+        for (const auto &entry : GetFactory())
+            if ((entry.isEffect || !effectsOnly) && entry.name.equalsIgnoreCase(name))
+                return entry.constructor();
+
+        return nullptr;
+    }
+
+    // Same format as the Host writes, only the bus layouts that exist are applied.
+    void ReadBusLayoutFromXml(juce::AudioProcessor::BusesLayout &layout, const juce::XmlElement &xml, bool isInput)
+    {
+        auto &buses = isInput ? layout.inputBuses : layout.outputBuses;
+
+        if (auto *busesXml = xml.getChildByName(isInput ? "INPUTS" : "OUTPUTS"))
+        {
+            for (auto *bus : busesXml->getChildWithTagNameIterator("BUS"))
+            {
+                const int index = bus->getIntAttribute("index");
+                const auto set = bus->getStringAttribute("layout");
+
+                if (index < buses.size() && set.isNotEmpty())
+                    buses.getReference(index) = juce::AudioChannelSet::fromAbbreviatedString(set);
+            }
+        }
+    }
+
+    bool ApplySettings(juce::AudioProcessor &processor, const std::vector<std::pair<juce::String, float>> &settings, juce::String &error)
+    {
+        for (const auto &[name, value] : settings)
+        {
+            bool found = false;
+            for (auto *parameter : processor.getParameters())
+            {
+                auto *ranged = dynamic_cast<juce::RangedAudioParameter *>(parameter);
+                if (ranged != nullptr && ranged->getName(128).equalsIgnoreCase(name))
+                {
+                    ranged->setValueNotifyingHost(ranged->convertTo0to1(value));
+                    found = true;
+                }
+            }
+
+            if (!found)
+            {
+                error = processor.getName() + " has no parameter \"" + name + "\"";
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+std::unique_ptr<EffectChain> EffectChain::FromFile(const juce::File &file, juce::String &error)
+{
+    auto xml = juce::parseXMLIfTagMatches(file, "FILTERGRAPH");
+    if (xml == nullptr)
+    {
+        error = file.getFullPathName() + " is not a filter graph";
+        return nullptr;
+    }
+
+    std::unique_ptr<EffectChain> chain(new EffectChain());
+    chain->mFilterGraph = std::move(xml);
+    return chain;
+}
+
+std::unique_ptr<EffectChain> EffectChain::FromText(const juce::String &text, juce::String &error)
+{
+    std::unique_ptr<EffectChain> chain(new EffectChain());
+
+    for (const auto &token : juce::StringArray::fromTokens(text, ">", "\""))
+    {
+        Effect effect;
+        effect.name = token.upToFirstOccurrenceOf("(", false, false).trim();
+
+        const auto arguments = token.fromFirstOccurrenceOf("(", false, false).upToLastOccurrenceOf(")", false, false);
+        for (const auto &argument : juce::StringArray::fromTokens(arguments, ",", "\""))
+        {
+            if (argument.trim().isEmpty())
+                continue;
+
+            if (!argument.containsChar('='))
+            {
+                error = "Expected name=value in \"" + token.trim() + "\"";
+                return nullptr;
+            }
+
+            effect.settings.emplace_back(argument.upToFirstOccurrenceOf("=", false, false).trim().unquoted(),
+                                         argument.fromFirstOccurrenceOf("=", false, false).trim().getFloatValue());
+        }
+
+        if (effect.name.isEmpty())
+            continue;
+
+        // Fail on a typo before any file is opened.
+        auto instance = CreateInstance(effect.name, true);
+        if (instance == nullptr)
+        {
+            error = "Unknown effect \"" + effect.name + "\"";
+            return nullptr;
+        }
+
+        if (!ApplySettings(static_cast<PluginInstanceProxy &>(*instance).getInnerProcessor(), effect.settings, error))
+            return nullptr;
+
+        chain->mEffects.push_back(std::move(effect));
+    }
+
+    if (chain->mEffects.empty())
+    {
+        error = "The chain has no effects";
+        return nullptr;
+    }
+
+    return chain;
+}
+
+juce::StringArray EffectChain::GetEffectNames()
+{
+    juce::StringArray names;
+    for (const auto &entry : GetFactory())
+        if (entry.isEffect)
+            names.add(entry.name);
+
+    return names;
+}
+
+std::unique_ptr<juce::AudioProcessorGraph> EffectChain::CreateGraph(int numChannels, juce::String &error) const
+{
+    auto graph = std::make_unique<juce::AudioProcessorGraph>();
+
+    // The IO nodes take their channel count from the graph.
+    graph->setPlayConfigDetails(numChannels, numChannels, graph->getSampleRate(), graph->getBlockSize());
+
+    const bool created = mFilterGraph != nullptr ? CreateFilterGraph(*graph, error)
+                                                 : CreateSeriesGraph(*graph, numChannels, error);
+    if (!created)
+        return nullptr;
+
+    return graph;
+}
+
+bool EffectChain::CreateFilterGraph(juce::AudioProcessorGraph &graph, juce::String &error) const
+{
+    for (auto *filter : mFilterGraph->getChildWithTagNameIterator("FILTER"))
+    {
+        juce::PluginDescription description;
+        for (auto *e : filter->getChildIterator())
+            if (description.loadFromXml(*e))
+                break;
+
+        auto instance = description.pluginFormatName == PluginInstanceFormat::getIdentifier()
+                            ? CreateInstance(description.name, false)
+                            : nullptr;
+        if (instance == nullptr)
+        {
+            error = "Only the built-in effects can be rendered, \"" + description.name + "\" is not one of them";
+            return false;
+        }
+
+        if (auto *layoutXml = filter->getChildByName("LAYOUT"))
+        {
+            auto layout = instance->getBusesLayout();
+            ReadBusLayoutFromXml(layout, *layoutXml, true);
+            ReadBusLayoutFromXml(layout, *layoutXml, false);
+            instance->setBusesLayout(layout);
+        }
+
+        auto node = graph.addNode(std::move(instance), juce::AudioProcessorGraph::NodeID((juce::uint32)filter->getIntAttribute("uid")), UpdateKind::none);
+        if (node == nullptr)
+            continue;
+
+        if (auto *state = filter->getChildByName("STATE"))
+        {
+            juce::MemoryBlock m;
+            m.fromBase64Encoding(state->getAllSubText());
+            node->getProcessor()->setStateInformation(m.getData(), (int)m.getSize());
+        }
+    }
+
+    // Connections to channels the file does not have are refused and skipped.
+    for (auto *e : mFilterGraph->getChildWithTagNameIterator("CONNECTION"))
+    {
+        graph.addConnection({ { juce::AudioProcessorGraph::NodeID((juce::uint32)e->getIntAttribute("srcFilter")), e->getIntAttribute("srcChannel") },
+                              { juce::AudioProcessorGraph::NodeID((juce::uint32)e->getIntAttribute("dstFilter")), e->getIntAttribute("dstChannel") } },
+                            UpdateKind::none);
+    }
+
+    return true;
+}
+
+bool EffectChain::CreateSeriesGraph(juce::AudioProcessorGraph &graph, int numChannels, juce::String &error) const
+{
+    using IOProcessor = juce::AudioProcessorGraph::AudioGraphIOProcessor;
+
+    auto previous = graph.addNode(std::make_unique<IOProcessor>(IOProcessor::audioInputNode), {}, UpdateKind::none);
+    const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+
+    auto connect = [&](juce::AudioProcessorGraph::Node::Ptr destination)
+    {
+        const int numConnected = juce::jmin(previous->getProcessor()->getTotalNumOutputChannels(),
+                                            destination->getProcessor()->getTotalNumInputChannels());
+
+        for (int channel = 0; channel < numConnected; ++channel)
+            graph.addConnection({ { previous->nodeID, channel }, { destination->nodeID, channel } }, UpdateKind::none);
+
+        previous = destination;
+    };
+
+    for (const auto &effect : mEffects)
+    {
+        auto instance = CreateInstance(effect.name, true);
+        if (instance == nullptr || !ApplySettings(static_cast<PluginInstanceProxy &>(*instance).getInnerProcessor(), effect.settings, error))
+            return false;
+
+        // Every effect runs at the width of the file; generators have no input bus.
+        auto layout = instance->getBusesLayout();
+        if (!layout.inputBuses.isEmpty())
+            layout.inputBuses.getReference(0) = channelSet;
+        if (!layout.outputBuses.isEmpty())
+            layout.outputBuses.getReference(0) = channelSet;
+
+        if (!instance->setBusesLayout(layout))
+        {
+            error = effect.name + " does not support " + juce::String(numChannels) + " channels";
+            return false;
+        }
+
+        connect(graph.addNode(std::move(instance), {}, UpdateKind::none));
+    }
+
+    connect(graph.addNode(std::make_unique<IOProcessor>(IOProcessor::audioOutputNode), {}, UpdateKind::none));
+    return true;
+}
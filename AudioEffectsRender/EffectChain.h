@@ -0,0 +1,47 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Description of what to run over every file, and a factory for the graphs
+// that run it. Each file gets its own graph, so renders do not share state
+// and can run on separate threads.
+//
+// A chain comes either from a .filtergraph saved by the Host, rendered as
+// laid out there, or from a line of text like
+//
+//     SimpleEQ(lowCutFreq=120) > Reverb(room size=0.8, dry/wet=0.3)
+//
+// whose effects are connected in series on every channel of the file.
+// Parameters are set by name (case insensitive) to plain values, e.g. a
+// choice index or milliseconds. Only the built-in effects can be used; they
+// are created from the Host's factory list.
+class EffectChain
+{
+public:
+    static std::unique_ptr<EffectChain> FromFile(const juce::File &file, juce::String &error);
+    static std::unique_ptr<EffectChain> FromText(const juce::String &text, juce::String &error);
+
+    // Names accepted in a text chain.
+    static juce::StringArray GetEffectNames();
+
+    // Builds a graph with numChannels inputs and outputs. The graph is not
+    // prepared; as AudioProcessorGraph only rebuilds its render sequence on
+    // the message thread, prepareToPlay() has to be called there too.
+    std::unique_ptr<juce::AudioProcessorGraph> CreateGraph(int numChannels, juce::String &error) const;
+
+private:
+    struct Effect
+    {
+        juce::String name;
+        std::vector<std::pair<juce::String, float>> settings;
+    };
+
+    EffectChain() = default;
+
+    bool CreateFilterGraph(juce::AudioProcessorGraph &graph, juce::String &error) const;
+    bool CreateSeriesGraph(juce::AudioProcessorGraph &graph, int numChannels, juce::String &error) const;
+
+    std::unique_ptr<juce::XmlElement> mFilterGraph;
+    std::vector<Effect> mEffects;
+
+    JUCE_DECLARE_NON_COPYABLE(EffectChain)
+};
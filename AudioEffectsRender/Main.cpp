@@ -0,0 +1,208 @@
+#include "EffectChain.h"
+#include "RenderJob.h"
+
+static void PrintUsage()
+{
+    std::cout << "AudioEffectsRender (--graph <file.filtergraph> | --chain \"<Effect>(<parameter>=<value>, ...) > ...\")\n"
+                 "                   [--output <directory>] [--block 4096] [--threads <count>] [--bits 24] [--tail <seconds>]\n"
+                 "                   <file or directory>...\n"
+                 "AudioEffectsRender --list\n";
+}
+
+struct InputFile
+{
+    juce::File file;
+    // Where the result goes, relative to the output directory.
+    juce::String outputPath;
+};
+
+// Positional arguments are everything that is neither an option nor an
+// option's value. Files inside a directory keep their path below it.
+static std::vector<InputFile> GetInputFiles(const juce::ArgumentList &args, const juce::AudioFormatManager &formats)
+{
+    static const juce::StringArray valueOptions{ "--graph", "--chain", "--output", "--block", "--threads", "--bits", "--tail" };
+
+    auto getOutputPath = [](const juce::File &file, const juce::File &root)
+    {
+        const auto relative = root == juce::File() ? file.getFileName() : file.getRelativePathFrom(root);
+        return relative.upToLastOccurrenceOf(file.getFileExtension(), false, false) + ".wav";
+    };
+
+    std::vector<InputFile> files;
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const auto &argument = args[i];
+        if (argument.isOption())
+        {
+            if (valueOptions.contains(argument.text) && !argument.text.containsChar('='))
+                ++i;
+            continue;
+        }
+
+        const auto file = argument.resolveAsFile();
+        if (file.isDirectory())
+        {
+            for (const auto &entry : juce::RangedDirectoryIterator(file, true, formats.getWildcardForAllFormats()))
+                files.push_back({ entry.getFile(), getOutputPath(entry.getFile(), file) });
+        }
+        else
+        {
+            files.push_back({ file, getOutputPath(file, {}) });
+        }
+    }
+
+    return files;
+}
+
+// Jobs run side by side, so two inputs writing the same output, like x.wav
+// and x.flac, would overwrite each other. Lists every clash.
+static bool CheckOutputsAreUnique(const std::vector<InputFile> &files, const juce::File &outputDirectory)
+{
+    std::map<juce::String, juce::File> outputs;
+    bool unique = true;
+
+    for (const auto &input : files)
+    {
+        auto key = outputDirectory.getChildFile(input.outputPath).getFullPathName();
+        if (!juce::File::areFileNamesCaseSensitive())
+            key = key.toLowerCase();
+
+        const auto inserted = outputs.emplace(key, input.file);
+        if (!inserted.second)
+        {
+            std::cerr << input.file.getFullPathName() << " and " << inserted.first->second.getFullPathName()
+                      << " would both be rendered to " << input.outputPath << std::endl;
+            unique = false;
+        }
+    }
+
+    return unique;
+}
+
+int main(int argc, char *argv[])
+{
+    // The graphs rebuild on the message thread, which is this one.
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--list"))
+    {
+        for (const auto &name : EffectChain::GetEffectNames())
+            std::cout << name << std::endl;
+        return 0;
+    }
+
+    juce::String error;
+    std::unique_ptr<EffectChain> chain;
+    if (args.containsOption("--graph"))
+        chain = EffectChain::FromFile(args.getExistingFileForOption("--graph"), error);
+    else if (args.containsOption("--chain"))
+        chain = EffectChain::FromText(args.getValueForOption("--chain"), error);
+    else
+        error = "Either --graph or --chain is needed";
+
+    if (chain == nullptr)
+    {
+        std::cerr << error << std::endl;
+        PrintUsage();
+        return 1;
+    }
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    const auto files = GetInputFiles(args, formats);
+    if (files.empty())
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    RenderSettings settings;
+    settings.outputDirectory = args.containsOption("--output") ? args.getFileForOption("--output") : juce::File::getCurrentWorkingDirectory();
+    settings.blockSize = args.containsOption("--block") ? juce::jmax(1, args.getValueForOption("--block").getIntValue()) : 4096;
+    settings.bitsPerSample = args.containsOption("--bits") ? args.getValueForOption("--bits").getIntValue() : 24;
+    settings.tailSeconds = args.containsOption("--tail") ? args.getValueForOption("--tail").getDoubleValue() : 0.0;
+    const int numThreads = args.containsOption("--threads") ? juce::jmax(1, args.getValueForOption("--threads").getIntValue())
+                                                            : juce::SystemStats::getNumCpus();
+
+    if (!CheckOutputsAreUnique(files, settings.outputDirectory))
+        return 1;
+
+    if (!settings.outputDirectory.createDirectory())
+    {
+        std::cerr << "Cannot create " << settings.outputDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    juce::CriticalSection lock;
+    juce::WaitableEvent jobFinished;
+    int numFailed = 0;
+    double totalAudioSeconds = 0.0;
+
+    auto onFinished = [&](const RenderResult &result)
+    {
+        {
+            const juce::ScopedLock sl(lock);
+
+            if (result.error.isNotEmpty())
+            {
+                std::cout << result.input.getFileName() << ": " << result.error << std::endl;
+                ++numFailed;
+            }
+            else
+            {
+                std::cout << result.input.getFileName().paddedRight(' ', 40)
+                          << juce::String(result.audioSeconds, 1) << " s in " << juce::String(result.renderSeconds, 2) << " s, "
+                          << juce::String(result.GetRealTimeFactor(), 1) << "x real time" << std::endl;
+                totalAudioSeconds += result.audioSeconds;
+            }
+        }
+
+        jobFinished.signal();
+    };
+
+    juce::ThreadPool pool(numThreads);
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    for (const auto &input : files)
+    {
+        const auto &file = input.file;
+
+        // Only keep as many graphs alive as there are threads to run them.
+        while (pool.getNumJobs() >= numThreads)
+            jobFinished.wait(100);
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+        if (reader == nullptr)
+        {
+            const juce::ScopedLock sl(lock);
+            std::cout << file.getFileName() << ": not a readable audio file" << std::endl;
+            ++numFailed;
+            continue;
+        }
+
+        auto graph = chain->CreateGraph((int)reader->numChannels, error);
+        if (graph == nullptr)
+        {
+            const juce::ScopedLock sl(lock);
+            std::cout << file.getFileName() << ": " << error << std::endl;
+            ++numFailed;
+            continue;
+        }
+
+        graph->setNonRealtime(true);
+        graph->prepareToPlay(reader->sampleRate, settings.blockSize);
+        pool.addJob(new RenderJob(std::move(reader), std::move(graph), file, settings.outputDirectory.getChildFile(input.outputPath), settings, onFinished), true);
+    }
+
+    while (pool.getNumJobs() > 0)
+        jobFinished.wait(100);
+
+    const auto elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    std::cout << (int)files.size() - numFailed << " of " << files.size() << " files, " << juce::String(totalAudioSeconds, 1) << " s of audio in "
+              << juce::String(elapsed, 2) << " s on " << numThreads << " threads, "
+              << juce::String(elapsed > 0.0 ? totalAudioSeconds / elapsed : 0.0, 1) << "x real time" << std::endl;
+
+    return numFailed == 0 ? 0 : 1;
+}
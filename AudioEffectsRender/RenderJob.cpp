@@ -0,0 +1,106 @@
+#include "RenderJob.h"
+
+RenderJob::RenderJob(std::unique_ptr<juce::AudioFormatReader> reader, std::unique_ptr<juce::AudioProcessorGraph> graph,
+                     const juce::File &input, const juce::File &output, const RenderSettings &settings, Callback onFinished)
+    : juce::ThreadPoolJob(input.getFileName()),
+      mReader(std::move(reader)),
+      mGraph(std::move(graph)),
+      mInput(input),
+      mOutput(output),
+      mSettings(settings),
+      mOnFinished(std::move(onFinished))
+{
+}
+
+juce::ThreadPoolJob::JobStatus RenderJob::runJob()
+{
+    RenderResult result;
+    result.input = mInput;
+    result.output = mOutput;
+
+    Render(result);
+
+    // The graph goes before the callback so its memory is back when the next file is queued.
+    mGraph->releaseResources();
+    mGraph.reset();
+    mReader.reset();
+
+    mOnFinished(result);
+    return jobHasFinished;
+}
+
+bool RenderJob::Render(RenderResult &result)
+{
+    if (result.output == mInput)
+    {
+        result.error = "the output would overwrite the input";
+        return false;
+    }
+
+    const int numChannels = (int)mReader->numChannels;
+    const double sampleRate = mReader->sampleRate;
+    const int blockSize = mSettings.blockSize;
+
+    if (!result.output.getParentDirectory().createDirectory())
+    {
+        result.error = "cannot create " + result.output.getParentDirectory().getFullPathName();
+        return false;
+    }
+
+    result.output.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(result.output);
+    if (!stream->openedOk())
+    {
+        result.error = "cannot write " + result.output.getFullPathName();
+        return false;
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(juce::WavAudioFormat().createWriterFor(stream.get(), sampleRate, (unsigned int)numChannels,
+                                                                                          mSettings.bitsPerSample, {}, 0));
+    if (writer == nullptr)
+    {
+        result.error = "cannot write " + juce::String(mSettings.bitsPerSample) + " bit WAV";
+        return false;
+    }
+    stream.release();
+
+    juce::AudioSampleBuffer buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    const auto totalSamples = mReader->lengthInSamples + (juce::int64)(mSettings.tailSeconds * sampleRate);
+    // The graph delays everything by its latency, so that much more is
+    // rendered and the start is dropped, which keeps the output aligned with
+    // the input.
+    const auto latency = (juce::int64)mGraph->getLatencySamples();
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    for (juce::int64 position = 0; position < totalSamples + latency; position += blockSize)
+    {
+        if (shouldExit())
+        {
+            result.error = "cancelled";
+            return false;
+        }
+
+        const int numSamples = (int)juce::jmin((juce::int64)blockSize, totalSamples + latency - position);
+        juce::AudioSampleBuffer block(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+        // Reads past the end of the file, for the tail, fill with silence.
+        mReader->read(&block, 0, numSamples, position, true, true);
+        mGraph->processBlock(block, midi);
+        midi.clear();
+
+        const int skipped = (int)juce::jlimit((juce::int64)0, (juce::int64)numSamples, latency - position);
+        if (skipped < numSamples && !writer->writeFromAudioSampleBuffer(block, skipped, numSamples - skipped))
+        {
+            result.error = "write failed";
+            return false;
+        }
+    }
+
+    writer.reset();
+
+    result.renderSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    result.audioSeconds = (double)totalSamples / sampleRate;
+    return true;
+}
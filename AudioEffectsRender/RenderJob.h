@@ -0,0 +1,49 @@
+#pragma once
+#include <JuceHeader.h>
+
+struct RenderSettings
+{
+    juce::File outputDirectory;
+    int blockSize = 4096;
+    int bitsPerSample = 24;
+    double tailSeconds = 0.0;
+};
+
+struct RenderResult
+{
+    juce::File input;
+    juce::File output;
+    juce::String error;
+    double audioSeconds = 0.0;
+    double renderSeconds = 0.0;
+
+    // Seconds of audio rendered per second of wall time.
+    double GetRealTimeFactor() const { return renderSeconds > 0.0 ? audioSeconds / renderSeconds : 0.0; }
+};
+
+// Streams one file through its own, already prepared graph on a pool thread
+// and writes the result as WAV to output, creating its folder if needed. The rendered length is the file plus the
+// tail, read and written a block at a time, with the graph's latency
+// compensated so the output lines up with the input.
+class RenderJob : public juce::ThreadPoolJob
+{
+public:
+    using Callback = std::function<void(const RenderResult &)>;
+
+    RenderJob(std::unique_ptr<juce::AudioFormatReader> reader, std::unique_ptr<juce::AudioProcessorGraph> graph,
+              const juce::File &input, const juce::File &output, const RenderSettings &settings, Callback onFinished);
+
+    JobStatus runJob() override;
+
+private:
+    bool Render(RenderResult &result);
+
+    std::unique_ptr<juce::AudioFormatReader> mReader;
+    std::unique_ptr<juce::AudioProcessorGraph> mGraph;
+    const juce::File mInput;
+    const juce::File mOutput;
+    const RenderSettings mSettings;
+    const Callback mOnFinished;
+
+    JUCE_DECLARE_NON_COPYABLE(RenderJob)
+};
@@ -1,4 +1,5 @@
 #include "PluginProcessor.h"
+#include "Common/Utils.h"
 #include "PluginEditor.h"
 
 
@@ -120,26 +121,7 @@ void AudioPlayerAudioProcessor::releaseResources()
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool AudioPlayerAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-#if JucePlugin_IsMidiEffect
-	juce::ignoreUnused(layouts);
-	return true;
-#else
-	// This is the place where you check if the layout is supported.
-	// In this template code we only support mono or stereo.
-	// Some plugin hosts, such as certain GarageBand versions, will only
-	// load plugins that support stereo bus layouts.
-	if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-		&& layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-		return false;
-
-	// This checks if the input layout matches the output layout
-#if ! JucePlugin_IsSynth
-	if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-		return false;
-#endif
-
-	return true;
-#endif
+	return IsMatchingBusesLayout(layouts);
 }
 #endif
 
@@ -194,13 +176,20 @@ void AudioPlayerAudioProcessor::setStateInformation(const void* data, int sizeIn
 
 void AudioPlayerAudioProcessor::LoadFile(juce::File& file)
 {
-	auto reader = mFormatManager.createReaderFor(file);
-	if (reader)
+	// Uncompressed files are mapped rather than read into every instance, so
+	// instances playing the same file share one mapping. Compressed files are
+	// streamed from disk as before.
+	AssetOptions options;
+	options.memoryMapped = true;
+
+	auto asset = AssetCache::GetInstance().Load(file, options);
+	auto newSource = asset != nullptr ? asset->CreateSource() : nullptr;
+	if (newSource != nullptr)
 	{
-		auto newSource = std::make_unique<juce::AudioFormatReaderSource>(reader, true);
 		mTransportSource.stop();
-		mTransportSource.setSource(newSource.get(), 0, nullptr, reader->sampleRate);
+		mTransportSource.setSource(newSource.get(), 0, nullptr, asset->GetSampleRate());
 		mReaderSource.reset(newSource.release());
+		mAsset = std::move(asset);
 	}
 }
 
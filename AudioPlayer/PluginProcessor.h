@@ -1,6 +1,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "Common/AssetCache.h"
 
 class AudioPlayerAudioProcessor : public juce::AudioProcessor
 {
@@ -46,7 +47,9 @@ public:
 	juce::AudioProcessorValueTreeState mApvts;
 
 private:
-	std::unique_ptr<juce::AudioFormatReaderSource> mReaderSource;
+	// The source reads the asset's data, so it is declared after it and destroyed first.
+	std::shared_ptr<const AudioAsset> mAsset;
+	std::unique_ptr<juce::PositionableAudioSource> mReaderSource;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioPlayerAudioProcessor)
 };
@@ -0,0 +1,58 @@
+#include "Baseline.h"
+
+static const BenchmarkResult *FindResult(const std::vector<BenchmarkResult> &results, const BenchmarkResult &match)
+{
+    for (const auto &result : results)
+        if (result.name == match.name && result.sampleRate == match.sampleRate && result.blockSize == match.blockSize)
+            return &result;
+
+    return nullptr;
+}
+
+int CompareWithBaseline(const std::vector<BenchmarkResult> &results, const std::vector<BenchmarkResult> &baseline, double thresholdPercent)
+{
+    int numRegressions = 0;
+
+    std::cout << juce::String("case").paddedRight(' ', 64)
+              << juce::String("baseline").paddedLeft(' ', 10)
+              << juce::String("current").paddedLeft(' ', 10)
+              << juce::String("change").paddedLeft(' ', 10) << "  status" << std::endl;
+
+    for (const auto &result : results)
+    {
+        const auto name = result.name + " @ " + juce::String(result.sampleRate / 1000.0, 1) + "k/" + juce::String(result.blockSize);
+        std::cout << name.paddedRight(' ', 64);
+
+        const auto *reference = FindResult(baseline, result);
+        if (reference == nullptr)
+        {
+            std::cout << juce::String("-").paddedLeft(' ', 10)
+                      << juce::String(result.samplesPerSecond * 1e-6, 2).paddedLeft(' ', 10)
+                      << juce::String("-").paddedLeft(' ', 10) << "  new" << std::endl;
+            continue;
+        }
+
+        const auto change = 100.0 * (result.samplesPerSecond / reference->samplesPerSecond - 1.0);
+        const auto separated = result.samplesPerSecondHigh < reference->samplesPerSecondLow
+                            || result.samplesPerSecondLow > reference->samplesPerSecondHigh;
+
+        juce::String status = "ok";
+        if (change < -thresholdPercent)
+        {
+            status = separated ? "SLOWER" : "noisy";
+            if (separated)
+                ++numRegressions;
+        }
+        else if (change > thresholdPercent && separated)
+        {
+            status = "faster";
+        }
+
+        std::cout << juce::String(reference->samplesPerSecond * 1e-6, 2).paddedLeft(' ', 10)
+                  << juce::String(result.samplesPerSecond * 1e-6, 2).paddedLeft(' ', 10)
+                  << (juce::String(change, 1) + "%").paddedLeft(' ', 10) << "  " << status << std::endl;
+    }
+
+    std::cout << numRegressions << " regression(s) beyond " << thresholdPercent << "% (Msamples/s, median of the runs)" << std::endl;
+    return numRegressions;
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include "Benchmark.h"
+
+// Compares results with a baseline recorded earlier on the same machine and
+// prints a table of the changes per case. A case regresses when its median
+// throughput dropped by more than thresholdPercent and its confidence
+// interval no longer overlaps the baseline's, so a single noisy case does not
+// fail the gate. Returns the number of regressions.
+int CompareWithBaseline(const std::vector<BenchmarkResult> &results, const std::vector<BenchmarkResult> &baseline, double thresholdPercent);
@@ -0,0 +1,127 @@
+#include "Benchmark.h"
+
+Benchmark::Benchmark(const juce::String &name)
+    : mName(name)
+{
+    GetRegistry().push_back(this);
+}
+
+std::vector<Benchmark *> &Benchmark::GetRegistry()
+{
+    static std::vector<Benchmark *> registry;
+    return registry;
+}
+
+static double MeasureSamplesPerSecond(Benchmark &benchmark, int blockSize, double minSeconds)
+{
+    juce::int64 numSamples = 0;
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    auto elapsed = 0.0;
+
+    do
+    {
+        for (int i = 0; i < 64; ++i)
+            benchmark.Process(blockSize);
+
+        numSamples += 64 * (juce::int64)blockSize;
+        elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    } while (elapsed < minSeconds);
+
+    return (double)numSamples / elapsed;
+}
+
+static double Percentile(const std::vector<double> &sorted, double fraction)
+{
+    const auto position = fraction * (double)(sorted.size() - 1);
+    const auto index = (size_t)position;
+    if (index + 1 >= sorted.size())
+        return sorted.back();
+
+    return sorted[index] + (position - (double)index) * (sorted[index + 1] - sorted[index]);
+}
+
+BenchmarkResult RunBenchmark(Benchmark &benchmark, double sampleRate, int blockSize, double minSeconds, int repetitions)
+{
+    benchmark.Prepare(sampleRate, blockSize);
+
+    // Warm caches and branch predictors before timing.
+    for (int i = 0; i < 16; ++i)
+        benchmark.Process(blockSize);
+
+    std::vector<double> runs;
+    for (int i = 0; i < juce::jmax(1, repetitions); ++i)
+        runs.push_back(MeasureSamplesPerSecond(benchmark, blockSize, minSeconds));
+
+    std::sort(runs.begin(), runs.end());
+
+    BenchmarkResult result;
+    result.name = benchmark.GetName();
+    result.sampleRate = sampleRate;
+    result.blockSize = blockSize;
+    result.repetitions = (int)runs.size();
+    result.samplesPerSecond = Percentile(runs, 0.5);
+
+    // The interval used for box plot notches: median +- 1.57 IQR / sqrt(n),
+    // which needs no assumption about how the runs are distributed.
+    const auto halfWidth = 1.57 * (Percentile(runs, 0.75) - Percentile(runs, 0.25)) / std::sqrt((double)runs.size());
+    result.samplesPerSecondLow = result.samplesPerSecond - halfWidth;
+    result.samplesPerSecondHigh = result.samplesPerSecond + halfWidth;
+    return result;
+}
+
+juce::var ToJson(const std::vector<BenchmarkResult> &results)
+{
+    juce::Array<juce::var> list;
+    for (const auto &result : results)
+    {
+        auto *entry = new juce::DynamicObject();
+        entry->setProperty("name", result.name);
+        entry->setProperty("sampleRate", result.sampleRate);
+        entry->setProperty("blockSize", result.blockSize);
+        entry->setProperty("samplesPerSecond", result.samplesPerSecond);
+        entry->setProperty("samplesPerSecondLow", result.samplesPerSecondLow);
+        entry->setProperty("samplesPerSecondHigh", result.samplesPerSecondHigh);
+        entry->setProperty("repetitions", result.repetitions);
+        entry->setProperty("nsPerSample", result.GetNanosecondsPerSample());
+        entry->setProperty("realTimeFactor", result.GetRealTimeFactor());
+        list.add(juce::var(entry));
+    }
+
+    auto *root = new juce::DynamicObject();
+    root->setProperty("version", ProjectInfo::versionString);
+    root->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    root->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("results", list);
+    return juce::var(root);
+}
+
+std::vector<BenchmarkResult> FromJson(const juce::var &json)
+{
+    std::vector<BenchmarkResult> results;
+
+    if (const auto *list = json["results"].getArray())
+    {
+        for (const auto &entry : *list)
+        {
+            BenchmarkResult result;
+            result.name = entry["name"].toString();
+            result.sampleRate = entry["sampleRate"];
+            result.blockSize = entry["blockSize"];
+            result.samplesPerSecond = entry["samplesPerSecond"];
+            result.repetitions = entry.getProperty("repetitions", 1);
+            result.samplesPerSecondLow = entry.getProperty("samplesPerSecondLow", result.samplesPerSecond);
+            result.samplesPerSecondHigh = entry.getProperty("samplesPerSecondHigh", result.samplesPerSecond);
+            results.push_back(result);
+        }
+    }
+
+    return results;
+}
+
+void FillWithNoise(float *data, int numSamples, juce::int64 seed)
+{
+    juce::Random random(seed);
+    for (int i = 0; i < numSamples; ++i)
+        data[i] = random.nextFloat() * 2.0f - 1.0f;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <JuceHeader.h>
+
+// A benchmark case processes blocks of synthetic audio; the runner times how
+// many samples per second it gets through. Cases register themselves by being
+// constructed as static objects.
+class Benchmark
+{
+public:
+    explicit Benchmark(const juce::String &name);
+    virtual ~Benchmark() = default;
+
+    virtual void Prepare(double sampleRate, int blockSize) = 0;
+    virtual void Process(int blockSize) = 0;
+
+    const juce::String &GetName() const { return mName; }
+
+    static std::vector<Benchmark *> &GetRegistry();
+
+private:
+    const juce::String mName;
+
+    JUCE_DECLARE_NON_COPYABLE(Benchmark)
+};
+
+// With several repetitions, samplesPerSecond is their median and the
+// interval is an approximate 95% confidence interval of that median.
+struct BenchmarkResult
+{
+    juce::String name;
+    double sampleRate = 0.0;
+    int blockSize = 0;
+    double samplesPerSecond = 0.0;
+    int repetitions = 1;
+    double samplesPerSecondLow = 0.0;
+    double samplesPerSecondHigh = 0.0;
+
+    double GetNanosecondsPerSample() const { return 1e9 / samplesPerSecond; }
+
+    // How many times faster than real time the case runs; below 1 it cannot keep up.
+    double GetRealTimeFactor() const { return samplesPerSecond / sampleRate; }
+};
+
+BenchmarkResult RunBenchmark(Benchmark &benchmark, double sampleRate, int blockSize, double minSeconds, int repetitions = 1);
+
+// Results with the machine they were measured on, for comparing releases.
+juce::var ToJson(const std::vector<BenchmarkResult> &results);
+std::vector<BenchmarkResult> FromJson(const juce::var &json);
+
+// Fills a channel with deterministic noise so runs are comparable.
+void FillWithNoise(float *data, int numSamples, juce::int64 seed);
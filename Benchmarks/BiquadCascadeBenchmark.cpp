@@ -0,0 +1,104 @@
+#include "Benchmark.h"
+#include "Common/BiquadCascade.h"
+
+// The ThreeBandEqualizer filter path on two channels: low cut and high cut at
+// the same slope around a peak, at 12, 24, 36 or 48 dB/Oct.
+class EqualizerCascadeBenchmark : public Benchmark
+{
+public:
+    EqualizerCascadeBenchmark(const juce::String &name, int slope, bool lanes)
+        : Benchmark(name), mNumCutSections(slope + 1), mLanes(lanes)
+    {
+    }
+
+    void Prepare(double sampleRate, int blockSize) override
+    {
+        mBuffer.setSize(2, blockSize);
+        for (int channel = 0; channel < 2; ++channel)
+            FillWithNoise(mBuffer.getWritePointer(channel), blockSize, channel);
+
+        BiquadCoefficients lowCut[4];
+        BiquadCoefficients highCut[4];
+        BiquadDesign::ButterworthHighPass(sampleRate, 80.0, 2 * mNumCutSections, lowCut);
+        BiquadDesign::ButterworthLowPass(sampleRate, 12000.0, 2 * mNumCutSections, highCut);
+        const BiquadCoefficients peak = BiquadDesign::Peak(sampleRate, 750.0, 1.0, 2.0);
+
+        if (mLanes)
+        {
+            mCascade.Prepare(2, 9, blockSize);
+            for (int i = 0; i < 4; ++i)
+            {
+                mCascade.SetSection(i, lowCut[i]);
+                mCascade.SetSection(5 + i, highCut[i]);
+                mCascade.SetSectionEnabled(i, i < mNumCutSections);
+                mCascade.SetSectionEnabled(5 + i, i < mNumCutSections);
+            }
+            mCascade.SetSection(4, peak);
+            return;
+        }
+
+        juce::dsp::ProcessSpec spec{ sampleRate, (juce::uint32)blockSize, 1 };
+        for (auto *chain : { &mLeftChain, &mRightChain })
+        {
+            SetupCutFilter(chain->get<0>(), lowCut);
+            chain->get<1>().coefficients = BiquadDesign::CreateStorage(2);
+            BiquadDesign::Apply(peak, *chain->get<1>().coefficients);
+            SetupCutFilter(chain->get<2>(), highCut);
+            chain->prepare(spec);
+        }
+    }
+
+    void Process(int numSamples) override
+    {
+        juce::dsp::AudioBlock<float> block(mBuffer.getArrayOfWritePointers(), 2, (size_t)numSamples);
+
+        if (mLanes)
+        {
+            mCascade.Process(block);
+            return;
+        }
+
+        auto leftBlock = block.getSingleChannelBlock(0);
+        auto rightBlock = block.getSingleChannelBlock(1);
+        juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
+        juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+        mLeftChain.process(leftContext);
+        mRightChain.process(rightContext);
+    }
+
+private:
+    using Filter = juce::dsp::IIR::Filter<float>;
+    using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+    using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+
+    template <int index>
+    void SetupCutStage(CutFilter &cut, const BiquadCoefficients *sections)
+    {
+        cut.template get<index>().coefficients = BiquadDesign::CreateStorage(2);
+        BiquadDesign::Apply(sections[index], *cut.template get<index>().coefficients);
+        cut.template setBypassed<index>(index >= mNumCutSections);
+    }
+
+    void SetupCutFilter(CutFilter &cut, const BiquadCoefficients *sections)
+    {
+        SetupCutStage<0>(cut, sections);
+        SetupCutStage<1>(cut, sections);
+        SetupCutStage<2>(cut, sections);
+        SetupCutStage<3>(cut, sections);
+    }
+
+    const int mNumCutSections;
+    const bool mLanes;
+    juce::AudioSampleBuffer mBuffer;
+    MonoChain mLeftChain, mRightChain;
+    BiquadCascade mCascade;
+};
+
+static EqualizerCascadeBenchmark chain12("BiquadCascade/ProcessorChain/12dB", 0, false);
+static EqualizerCascadeBenchmark lanes12("BiquadCascade/Lanes/12dB", 0, true);
+static EqualizerCascadeBenchmark chain24("BiquadCascade/ProcessorChain/24dB", 1, false);
+static EqualizerCascadeBenchmark lanes24("BiquadCascade/Lanes/24dB", 1, true);
+static EqualizerCascadeBenchmark chain36("BiquadCascade/ProcessorChain/36dB", 2, false);
+static EqualizerCascadeBenchmark lanes36("BiquadCascade/Lanes/36dB", 2, true);
+static EqualizerCascadeBenchmark chain48("BiquadCascade/ProcessorChain/48dB", 3, false);
+static EqualizerCascadeBenchmark lanes48("BiquadCascade/Lanes/48dB", 3, true);
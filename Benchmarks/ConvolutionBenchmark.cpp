@@ -0,0 +1,52 @@
+#include "Benchmark.h"
+#include "Common/PartitionedConvolver.h"
+
+// Stereo convolution with a synthetic room: exponentially decaying noise,
+// 60 dB down at the end of the response. The tail stages run on the shared
+// worker pool and the callback never waits for them, so this measures the
+// callback alone.
+class ConvolutionBenchmark : public Benchmark
+{
+public:
+    ConvolutionBenchmark(const juce::String &name, double impulseSeconds)
+        : Benchmark(name), mImpulseSeconds(impulseSeconds)
+    {
+    }
+
+    void Prepare(double sampleRate, int blockSize) override
+    {
+        const int impulseLength = (int)(mImpulseSeconds * sampleRate);
+        juce::AudioSampleBuffer response(2, impulseLength);
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            float *data = response.getWritePointer(channel);
+            FillWithNoise(data, impulseLength, 100 + channel);
+            for (int i = 0; i < impulseLength; ++i)
+                data[i] *= std::pow(0.001f, (float)i / impulseLength) * 0.05f;
+        }
+
+        mConvolver.Prepare(ConvolutionImpulse::Create(response, sampleRate), 2);
+
+        mInput.setSize(2, blockSize);
+        mBuffer.setSize(2, blockSize);
+        for (int channel = 0; channel < 2; ++channel)
+            FillWithNoise(mInput.getWritePointer(channel), blockSize, channel);
+    }
+
+    void Process(int numSamples) override
+    {
+        for (int channel = 0; channel < 2; ++channel)
+            mBuffer.copyFrom(channel, 0, mInput, channel, 0, numSamples);
+
+        mConvolver.Process(juce::dsp::AudioBlock<float>(mBuffer).getSubBlock(0, (size_t)numSamples));
+    }
+
+private:
+    const double mImpulseSeconds;
+    PartitionedConvolver mConvolver;
+    juce::AudioSampleBuffer mInput;
+    juce::AudioSampleBuffer mBuffer;
+};
+
+static ConvolutionBenchmark shortConvolution("Convolution/0.5s", 0.5);
+static ConvolutionBenchmark longConvolution("Convolution/3s", 3.0);
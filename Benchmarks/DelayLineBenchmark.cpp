@@ -0,0 +1,249 @@
+#include "Benchmark.h"
+#include "Common/DelayLine.h"
+
+// Modulated feedback delay, as in the flanger, with a 2-10 ms sweep on two
+// channels. The delay times are precomputed so only the delay line is timed.
+class ModulatedDelayBenchmark : public Benchmark
+{
+public:
+    ModulatedDelayBenchmark(const juce::String &name, Interpolation interpolation)
+        : Benchmark(name), mInterpolation(interpolation)
+    {
+    }
+
+    void Prepare(double sampleRate, int blockSize) override
+    {
+        mBuffer.setSize(2, blockSize);
+        for (int channel = 0; channel < 2; ++channel)
+            FillWithNoise(mBuffer.getWritePointer(channel), blockSize, channel);
+
+        mDelayTimes.setSize(1, blockSize);
+        for (int i = 0; i < blockSize; ++i)
+            mDelayTimes.setSample(0, i, (float)(sampleRate * (0.006 + 0.004 * std::sin(juce::MathConstants<double>::twoPi * i / blockSize))));
+
+        mMinDelay = (float)(sampleRate * 0.002);
+        mMaxDelaySamples = (int)(sampleRate * 0.02) + 1;
+    }
+
+protected:
+    const Interpolation mInterpolation;
+    juce::AudioSampleBuffer mBuffer;
+    juce::AudioSampleBuffer mDelayTimes;
+    float mMinDelay = 0.0f;
+    int mMaxDelaySamples = 0;
+};
+
+// The per-sample loop the delay effects used before the shared delay line.
+class LegacyDelayBenchmark : public ModulatedDelayBenchmark
+{
+public:
+    using ModulatedDelayBenchmark::ModulatedDelayBenchmark;
+
+    void Prepare(double sampleRate, int blockSize) override
+    {
+        ModulatedDelayBenchmark::Prepare(sampleRate, blockSize);
+        mDelayBufferSamples = mMaxDelaySamples;
+        mDelayBuffer.setSize(2, mDelayBufferSamples);
+        mDelayBuffer.clear();
+        mDelayWritePosition = 0;
+    }
+
+    void Process(int numSamples) override
+    {
+        int localWritePosition = mDelayWritePosition;
+        const float *delayTimes = mDelayTimes.getReadPointer(0);
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            float *channelData = mBuffer.getWritePointer(channel);
+            float *delayData = mDelayBuffer.getWritePointer(channel);
+            localWritePosition = mDelayWritePosition;
+
+            for (int sample = 0; sample < numSamples; ++sample)
+            {
+                const float inData = channelData[sample];
+                float outData = 0.0f;
+
+                float readPosition = fmodf(localWritePosition - delayTimes[sample] + mDelayBufferSamples, mDelayBufferSamples);
+                int localReadPosition = floorf(readPosition);
+
+                switch (mInterpolation)
+                {
+                case NEAREST_NEIGHBOUR:
+                    outData = delayData[localReadPosition % mDelayBufferSamples];
+                    break;
+                case LINEAR:
+                {
+                    float fraction = readPosition - localReadPosition;
+                    float delayed0 = delayData[(localReadPosition + 0)];
+                    float delayed1 = delayData[(localReadPosition + 1) % mDelayBufferSamples];
+                    outData = delayed0 + fraction * (delayed1 - delayed0);
+                    break;
+                }
+                case CUBIC:
+                {
+                    float fraction = readPosition - (float)localReadPosition;
+                    float fractionSqrt = fraction * fraction;
+                    float fractionCube = fractionSqrt * fraction;
+
+                    float sample0 = delayData[(localReadPosition - 1 + mDelayBufferSamples) % mDelayBufferSamples];
+                    float sample1 = delayData[(localReadPosition + 0)];
+                    float sample2 = delayData[(localReadPosition + 1) % mDelayBufferSamples];
+                    float sample3 = delayData[(localReadPosition + 2) % mDelayBufferSamples];
+
+                    float a0 = -0.5f * sample0 + 1.5f * sample1 - 1.5f * sample2 + 0.5f * sample3;
+                    float a1 = sample0 - 2.5f * sample1 + 2.0f * sample2 - 0.5f * sample3;
+                    float a2 = -0.5f * sample0 + 0.5f * sample2;
+                    float a3 = sample1;
+                    outData = a0 * fractionCube + a1 * fractionSqrt + a2 * fraction + a3;
+                    break;
+                }
+                }
+
+                channelData[sample] = inData + outData * 0.5f;
+                delayData[localWritePosition] = inData + outData * 0.5f;
+
+                if (++localWritePosition >= mDelayBufferSamples)
+                    localWritePosition -= mDelayBufferSamples;
+            }
+        }
+
+        mDelayWritePosition = localWritePosition;
+    }
+
+private:
+    juce::AudioSampleBuffer mDelayBuffer;
+    int mDelayBufferSamples = 0;
+    int mDelayWritePosition = 0;
+};
+
+class BlockDelayBenchmark : public ModulatedDelayBenchmark
+{
+public:
+    using ModulatedDelayBenchmark::ModulatedDelayBenchmark;
+
+    void Prepare(double sampleRate, int blockSize) override
+    {
+        ModulatedDelayBenchmark::Prepare(sampleRate, blockSize);
+        mDelayLine.Prepare(2, mMaxDelaySamples, blockSize);
+        mScratch.setSize(2, blockSize);
+    }
+
+    void Process(int numSamples) override
+    {
+        float *delayedData = mScratch.getWritePointer(0);
+        float *feedbackData = mScratch.getWritePointer(1);
+
+        for (int offset = 0; offset < numSamples;)
+        {
+            const int chunkSamples = mDelayLine.GetChunkSize(mMinDelay, numSamples - offset);
+
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                float *channelData = mBuffer.getWritePointer(channel, offset);
+
+                mDelayLine.SetDelay(mDelayTimes.getReadPointer(0, offset), chunkSamples);
+                mDelayLine.Read(channel, delayedData, chunkSamples, mInterpolation);
+
+                for (int sample = 0; sample < chunkSamples; ++sample)
+                {
+                    const float outData = delayedData[sample] * 0.5f;
+                    feedbackData[sample] = channelData[sample] + outData;
+                    channelData[sample] += outData;
+                }
+
+                mDelayLine.Write(channel, feedbackData, chunkSamples);
+            }
+
+            mDelayLine.Advance(chunkSamples);
+            offset += chunkSamples;
+        }
+    }
+
+private:
+    DelayLine mDelayLine;
+    juce::AudioSampleBuffer mScratch;
+};
+
+// Four chorus voices sweeping 10-20 ms on two channels, mixed into the dry signal.
+class ChorusVoicesBenchmark : public Benchmark
+{
+public:
+    ChorusVoicesBenchmark(const juce::String &name, Interpolation interpolation, bool lanes)
+        : Benchmark(name), mInterpolation(interpolation), mLanes(lanes)
+    {
+    }
+
+    void Prepare(double sampleRate, int blockSize) override
+    {
+        mBuffer.setSize(2, blockSize);
+        for (int channel = 0; channel < 2; ++channel)
+            FillWithNoise(mBuffer.getWritePointer(channel), blockSize, channel);
+
+        mVoiceDelays.setSize(mNumVoices, blockSize);
+        for (int voice = 0; voice < mNumVoices; ++voice)
+            for (int i = 0; i < blockSize; ++i)
+                mVoiceDelays.setSample(voice, i, (float)(sampleRate * (0.015 + 0.005 * std::sin(juce::MathConstants<double>::twoPi * (i / (double)blockSize + voice * 0.25)))));
+
+        mVoiceOutput.setSize(1, blockSize);
+        mDelayLine.Prepare(2, (int)(sampleRate * 0.02) + 1, blockSize, mNumVoices);
+    }
+
+    void Process(int numSamples) override
+    {
+        const float weights[mNumVoices] = { 0.5f, 0.5f, 0.5f, 0.5f };
+        const float *voiceDelays[mNumVoices] = {};
+        for (int voice = 0; voice < mNumVoices; ++voice)
+            voiceDelays[voice] = mVoiceDelays.getReadPointer(voice);
+
+        float *voiceData = mVoiceOutput.getWritePointer(0);
+
+        for (int channel = 0; channel < 2; ++channel)
+            mDelayLine.Write(channel, mBuffer.getReadPointer(channel), numSamples);
+
+        if (mLanes)
+        {
+            mDelayLine.SetVoiceDelays(voiceDelays, mNumVoices, numSamples);
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                mDelayLine.ReadVoices(channel, weights, mNumVoices, voiceData, numSamples, mInterpolation);
+                juce::FloatVectorOperations::add(mBuffer.getWritePointer(channel), voiceData, numSamples);
+            }
+        }
+        else
+        {
+            for (int voice = 0; voice < mNumVoices; ++voice)
+            {
+                mDelayLine.SetDelay(voiceDelays[voice], numSamples);
+                for (int channel = 0; channel < 2; ++channel)
+                {
+                    mDelayLine.Read(channel, voiceData, numSamples, mInterpolation);
+                    juce::FloatVectorOperations::addWithMultiply(mBuffer.getWritePointer(channel), voiceData, weights[voice], numSamples);
+                }
+            }
+        }
+
+        mDelayLine.Advance(numSamples);
+    }
+
+private:
+    static constexpr int mNumVoices = 4;
+
+    const Interpolation mInterpolation;
+    const bool mLanes;
+    DelayLine mDelayLine;
+    juce::AudioSampleBuffer mBuffer;
+    juce::AudioSampleBuffer mVoiceDelays;
+    juce::AudioSampleBuffer mVoiceOutput;
+};
+
+static LegacyDelayBenchmark legacyNearest("DelayLine/Legacy/NearestNeighbour", Interpolation::NEAREST_NEIGHBOUR);
+static BlockDelayBenchmark blockNearest("DelayLine/Block/NearestNeighbour", Interpolation::NEAREST_NEIGHBOUR);
+static LegacyDelayBenchmark legacyLinear("DelayLine/Legacy/Linear", Interpolation::LINEAR);
+static BlockDelayBenchmark blockLinear("DelayLine/Block/Linear", Interpolation::LINEAR);
+static LegacyDelayBenchmark legacyCubic("DelayLine/Legacy/Cubic", Interpolation::CUBIC);
+static BlockDelayBenchmark blockCubic("DelayLine/Block/Cubic", Interpolation::CUBIC);
+static ChorusVoicesBenchmark voicesLinear("DelayLine/ChorusVoices/PerVoice/Linear", Interpolation::LINEAR, false);
+static ChorusVoicesBenchmark lanesLinear("DelayLine/ChorusVoices/Lanes/Linear", Interpolation::LINEAR, true);
+static ChorusVoicesBenchmark voicesCubic("DelayLine/ChorusVoices/PerVoice/Cubic", Interpolation::CUBIC, false);
+static ChorusVoicesBenchmark lanesCubic("DelayLine/ChorusVoices/Lanes/Cubic", Interpolation::CUBIC, true);
@@ -0,0 +1,142 @@
+#include "ProcessorBenchmark.h"
+#include "Host/PluginInstanceIncludedHeader.inl"
+
+// Every effect processor at its defaults, plus the settings that switch
+// between code paths. Chorus and Flanger interpolation and waveform cases are
+// in ModulationBenchmark.
+namespace
+{
+    struct Case
+    {
+        juce::String name;
+        ProcessorBenchmark::Settings settings;
+    };
+
+    template <typename Processor>
+    void AddEffectBenchmarks(std::vector<std::unique_ptr<ProcessorBenchmark>> &benchmarks, const juce::String &effect, const std::vector<Case> &cases)
+    {
+        for (const auto &effectCase : cases)
+        {
+            benchmarks.push_back(std::make_unique<ProcessorBenchmark>(
+                "Effect/" + effect + "/" + effectCase.name, []
+                { return std::make_unique<Processor>(); },
+                effectCase.settings));
+        }
+    }
+
+    std::vector<std::unique_ptr<ProcessorBenchmark>> CreateEffectBenchmarks()
+    {
+        std::vector<std::unique_ptr<ProcessorBenchmark>> benchmarks;
+
+        // Without a file loaded the player only runs its transport.
+        AddEffectBenchmarks<AudioPlayerAudioProcessor>(benchmarks, "AudioPlayer", { { "Idle", {} } });
+
+        AddEffectBenchmarks<ChorusAudioProcessor>(benchmarks, "Chorus", {
+            { "2 Voices", { { "Number of Voices", 0.0f } } },
+            { "3 Voices", { { "Number of Voices", 1.0f } } },
+            { "4 Voices", { { "Number of Voices", 2.0f } } },
+            { "5 Voices", { { "Number of Voices", 3.0f } } },
+            { "Mono", { { "Stereo", 0.0f } } },
+        });
+
+        AddEffectBenchmarks<DelayAudioProcessor>(benchmarks, "Delay", {
+            { "Default", {} },
+            { "Long", { { "Time", 4.0f }, { "Feedback", 0.9f } } },
+        });
+
+        // The default is 2x with first order ADAA, "8x" is the plain tanh the effect used to run.
+        AddEffectBenchmarks<DistortionAudioProcessor>(benchmarks, "Distortion", {
+            { "Default", {} },
+            { "Driven", { { "distortion", 30.0f }, { "highpass freq", 80.0f }, { "lowpass freq", 8000.0f } } },
+            { "8x", { { "oversampling", 3.0f }, { "antialiasing", 0.0f } } },
+            { "1x ADAA2", { { "oversampling", 0.0f }, { "antialiasing", 2.0f } } },
+            { "4x ADAA1", { { "oversampling", 2.0f }, { "antialiasing", 1.0f } } },
+            { "Foldback", { { "curve", (float)Waveshapers::FOLDBACK } } },
+            { "Foldback ADAA2", { { "curve", (float)Waveshapers::FOLDBACK }, { "antialiasing", 2.0f } } },
+            { "Linear Phase", { { "oversampling filter", 1.0f } } },
+            { "8x Linear Phase", { { "oversampling", 3.0f }, { "oversampling filter", 1.0f } } },
+        });
+
+        AddEffectBenchmarks<FilterAudioProcessor>(benchmarks, "Filter", {
+            { "LowPass", { { "Filter Type", 0.0f } } },
+            { "HighPass", { { "Filter Type", 1.0f } } },
+            { "Static", { { "Smooth Sweeps", 0.0f } } },
+        });
+
+        AddEffectBenchmarks<FlangerAudioProcessor>(benchmarks, "Flanger", {
+            { "Mono", { { "Stereo", 0.0f } } },
+            { "Stereo", { { "Stereo", 1.0f } } },
+            { "Inverted", { { "Stereo", 1.0f }, { "Inverted mode", 1.0f } } },
+        });
+
+        // "Closed" never reaches the threshold, so every block takes the fast path that clears it.
+        AddEffectBenchmarks<NoiseGateAudioProcessor>(benchmarks, "NoiseGate", {
+            { "Default", {} },
+            { "Lookahead", { { "Lookahead", 3.0f } } }, // "5 ms"
+            { "Closed", { { "Threshold", 1.0f } } },
+            { "Key Filter", { { "Key Filter", 1.0f }, { "Key Frequency", 200.0f } } },
+        });
+        AddEffectBenchmarks<OscillatorAudioProcessor>(benchmarks, "Oscillator", { { "Default", {} } });
+
+        AddEffectBenchmarks<PingPongDelayAudioProcessor>(benchmarks, "PingPongDelay", {
+            { "Default", {} },
+            { "Long", { { "Time", 4.0f }, { "Feedback", 0.9f } } },
+        });
+
+        AddEffectBenchmarks<ReverbAudioProcessor>(benchmarks, "Reverb", {
+            { "Default", {} },
+            { "Frozen", { { "Freeze", 1.0f } } },
+        });
+
+        AddEffectBenchmarks<SimpleDistortionAudioProcessor>(benchmarks, "SimpleDistortion", {
+            { "Default", {} },
+            { "Inverted", { { "Invert Phase", 1.0f } } },
+        });
+
+        AddEffectBenchmarks<SimpleEQAudioProcessor>(benchmarks, "SimpleEQ", {
+            { "Default", {} },
+            { "Band", { { "lowCutFreq", 120.0f }, { "highCutFreq", 8000.0f } } },
+        });
+
+        std::vector<Case> slopes;
+        for (int slope = 0; slope < 4; ++slope)
+        {
+            slopes.push_back({ juce::String(12 + slope * 12) + "dB",
+                               { { "LowCutSlope", (float)slope }, { "HighCutSlope", (float)slope }, { "PeakGain", 6.0f } } });
+        }
+        AddEffectBenchmarks<ThreeBandEqualizerAudioProcessor>(benchmarks, "ThreeBandEqualizer", slopes);
+
+        return benchmarks;
+    }
+
+    template <typename Processor>
+    void AddIdleBenchmark(std::vector<std::unique_ptr<ProcessorBenchmark>> &benchmarks, const juce::String &effect)
+    {
+        benchmarks.push_back(std::make_unique<ProcessorBenchmark>(
+            "Idle/" + effect, []
+            { return std::make_unique<Processor>(); },
+            ProcessorBenchmark::Settings{}, ProcessorBenchmark::SILENCE));
+    }
+
+    // The effects fed silence at their defaults: once their tail has decayed
+    // they sleep, so this is the cost of an idle track. Frozen or infinite
+    // feedback settings never sleep and are covered by the Effect/ cases.
+    std::vector<std::unique_ptr<ProcessorBenchmark>> CreateIdleBenchmarks()
+    {
+        std::vector<std::unique_ptr<ProcessorBenchmark>> benchmarks;
+        AddIdleBenchmark<ChorusAudioProcessor>(benchmarks, "Chorus");
+        AddIdleBenchmark<DelayAudioProcessor>(benchmarks, "Delay");
+        AddIdleBenchmark<DistortionAudioProcessor>(benchmarks, "Distortion");
+        AddIdleBenchmark<FilterAudioProcessor>(benchmarks, "Filter");
+        AddIdleBenchmark<NoiseGateAudioProcessor>(benchmarks, "NoiseGate");
+        AddIdleBenchmark<PingPongDelayAudioProcessor>(benchmarks, "PingPongDelay");
+        AddIdleBenchmark<ReverbAudioProcessor>(benchmarks, "Reverb");
+        AddIdleBenchmark<SimpleDistortionAudioProcessor>(benchmarks, "SimpleDistortion");
+        AddIdleBenchmark<SimpleEQAudioProcessor>(benchmarks, "SimpleEQ");
+        AddIdleBenchmark<ThreeBandEqualizerAudioProcessor>(benchmarks, "ThreeBandEqualizer");
+        return benchmarks;
+    }
+}
+
+static auto effectBenchmarks = CreateEffectBenchmarks();
+static auto idleBenchmarks = CreateIdleBenchmarks();
@@ -0,0 +1,83 @@
+#include "Benchmark.h"
+#include "Common/LfoGenerator.h"
+
+// Four LFO voices at 0.5 Hz, as used by the chorus at its maximum voice count.
+static constexpr int lfoBenchmarkVoices = 4;
+
+// The per-sample Lfo() loop the modulation effects used before LfoGenerator.
+class LegacyLfoBenchmark : public Benchmark
+{
+public:
+    LegacyLfoBenchmark(const juce::String &name, Waveform waveform)
+        : Benchmark(name), mWaveform(waveform)
+    {
+    }
+
+    void Prepare(double sampleRate, int blockSize) override
+    {
+        mOutput.setSize(lfoBenchmarkVoices, blockSize);
+        mPhaseIncrement = (float)(0.5 / sampleRate);
+        mPhase = 0.0f;
+    }
+
+    void Process(int numSamples) override
+    {
+        for (int voice = 0; voice < lfoBenchmarkVoices; ++voice)
+        {
+            float *output = mOutput.getWritePointer(voice);
+            float phase = fmodf(mPhase + (float)voice / (float)lfoBenchmarkVoices, 1.0f);
+
+            for (int sample = 0; sample < numSamples; ++sample)
+            {
+                output[sample] = Lfo(phase, mWaveform);
+
+                phase += mPhaseIncrement;
+                if (phase >= 1.0f)
+                    phase -= 1.0f;
+            }
+        }
+
+        mPhase = fmodf(mPhase + mPhaseIncrement * (float)numSamples, 1.0f);
+    }
+
+private:
+    const Waveform mWaveform;
+    juce::AudioSampleBuffer mOutput;
+    float mPhaseIncrement = 0.0f;
+    float mPhase = 0.0f;
+};
+
+class BlockLfoBenchmark : public Benchmark
+{
+public:
+    BlockLfoBenchmark(const juce::String &name, Waveform waveform)
+        : Benchmark(name), mWaveform(waveform)
+    {
+    }
+
+    void Prepare(double sampleRate, int blockSize) override
+    {
+        mLfo.Prepare(lfoBenchmarkVoices, blockSize);
+        mPhaseIncrement = (float)(0.5 / sampleRate);
+        for (int voice = 0; voice < lfoBenchmarkVoices; ++voice)
+            mPhaseOffsets[voice] = (float)voice / (float)lfoBenchmarkVoices;
+    }
+
+    void Process(int numSamples) override
+    {
+        mLfo.Render(mWaveform, mPhaseIncrement, mPhaseOffsets, lfoBenchmarkVoices, numSamples);
+    }
+
+private:
+    const Waveform mWaveform;
+    LfoGenerator mLfo;
+    float mPhaseOffsets[lfoBenchmarkVoices] = {};
+    float mPhaseIncrement = 0.0f;
+};
+
+static LegacyLfoBenchmark legacySine("Lfo/Legacy/Sine", Waveform::SINE);
+static BlockLfoBenchmark blockSine("Lfo/Block/Sine", Waveform::SINE);
+static LegacyLfoBenchmark legacyTriangle("Lfo/Legacy/Triangle", Waveform::TRIANGLE);
+static BlockLfoBenchmark blockTriangle("Lfo/Block/Triangle", Waveform::TRIANGLE);
+static LegacyLfoBenchmark legacySawtooth("Lfo/Legacy/Sawtooth", Waveform::SWATOOTH);
+static BlockLfoBenchmark blockSawtooth("Lfo/Block/Sawtooth", Waveform::SWATOOTH);
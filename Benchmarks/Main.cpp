@@ -0,0 +1,110 @@
+#include "Baseline.h"
+
+namespace
+{
+    // The matrix run with --matrix: the smallest and largest blocks hosts use,
+    // at the common sample rates.
+    const std::vector<int> matrixBlockSizes = { 16, 64, 256, 1024, 4096 };
+    const std::vector<double> matrixSampleRates = { 44100.0, 48000.0, 96000.0, 192000.0 };
+
+    template <typename T>
+    std::vector<T> ParseList(const juce::String &text, std::function<T(const juce::String &)> parse)
+    {
+        std::vector<T> values;
+        for (const auto &item : juce::StringArray::fromTokens(text, ",", {}))
+            values.push_back(parse(item.trim()));
+        return values;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    const auto filter = args.getValueForOption("--filter");
+    const auto matrix = args.containsOption("--matrix");
+    const auto minSeconds = args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 0.5;
+    const auto repetitions = args.containsOption("--repetitions") ? juce::jmax(1, args.getValueForOption("--repetitions").getIntValue()) : 1;
+    const auto jsonFile = args.containsOption("--json") ? args.getFileForOption("--json") : juce::File();
+    const auto baselineFile = args.containsOption("--baseline") ? args.getFileForOption("--baseline") : juce::File();
+    const auto threshold = args.containsOption("--threshold") ? args.getValueForOption("--threshold").getDoubleValue() : 5.0;
+
+    // Read the baseline first, so a bad path fails before minutes of measuring.
+    std::vector<BenchmarkResult> baseline;
+    if (baselineFile != juce::File())
+    {
+        baseline = FromJson(juce::JSON::parse(baselineFile));
+        if (baseline.empty())
+        {
+            std::cerr << "no results in baseline " << baselineFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    // --rate and --block take comma separated lists.
+    auto sampleRates = matrix ? matrixSampleRates : std::vector<double>{ 48000.0 };
+    if (args.containsOption("--rate"))
+        sampleRates = ParseList<double>(args.getValueForOption("--rate"), [](const juce::String &s) { return s.getDoubleValue(); });
+
+    auto blockSizes = matrix ? matrixBlockSizes : std::vector<int>{ 512 };
+    if (args.containsOption("--block"))
+        blockSizes = ParseList<int>(args.getValueForOption("--block"), [](const juce::String &s) { return s.getIntValue(); });
+
+    std::vector<BenchmarkResult> results;
+    int numFailed = 0;
+
+    for (const auto sampleRate : sampleRates)
+    {
+        for (const auto blockSize : blockSizes)
+        {
+            std::cout << "sample rate " << sampleRate << ", block size " << blockSize << std::endl;
+
+            for (auto *benchmark : Benchmark::GetRegistry())
+            {
+                if (filter.isNotEmpty() && !benchmark->GetName().contains(filter))
+                    continue;
+
+                // A case that cannot be set up fails the run, the others still get measured.
+                BenchmarkResult result;
+                try
+                {
+                    result = RunBenchmark(*benchmark, sampleRate, blockSize, minSeconds, repetitions);
+                }
+                catch (const std::exception &e)
+                {
+                    std::cerr << benchmark->GetName() << " failed: " << e.what() << std::endl;
+                    ++numFailed;
+                    continue;
+                }
+
+                std::cout << result.name.paddedRight(' ', 48)
+                          << juce::String(result.samplesPerSecond * 1e-6, 2).paddedLeft(' ', 8) << " Msamples/s"
+                          << juce::String(result.GetNanosecondsPerSample(), 2).paddedLeft(' ', 10) << " ns/sample"
+                          << juce::String(result.GetRealTimeFactor(), 1).paddedLeft(' ', 10) << "x real time" << std::endl;
+                results.push_back(result);
+            }
+        }
+    }
+
+    if (jsonFile != juce::File())
+    {
+        if (!jsonFile.replaceWithText(juce::JSON::toString(ToJson(results))))
+        {
+            std::cerr << "could not write " << jsonFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        std::cout << "results written to " << jsonFile.getFullPathName() << std::endl;
+    }
+
+    if (numFailed > 0)
+    {
+        std::cerr << numFailed << " benchmark cases failed" << std::endl;
+        return 1;
+    }
+
+    if (!baseline.empty() && CompareWithBaseline(results, baseline, threshold) > 0)
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,36 @@
+#include "ProcessorBenchmark.h"
+#include "Chorus/PluginProcessor.h"
+#include "Flanger/PluginProcessor.h"
+
+namespace
+{
+    // One case per interpolation and LFO waveform, to compare the kernels
+    // the effect picks per block.
+    template <typename Processor>
+    std::vector<std::unique_ptr<ProcessorBenchmark>> CreateModulationBenchmarks(const juce::String &effect, const ProcessorBenchmark::Settings &settings)
+    {
+        std::vector<std::unique_ptr<ProcessorBenchmark>> benchmarks;
+
+        for (int interpolation = 0; interpolation < NUM_INTERPOLATIONS; ++interpolation)
+        {
+            for (int waveform = 0; waveform < NUM_WAVEFORMS; ++waveform)
+            {
+                auto caseSettings = settings;
+                caseSettings.push_back({ "Interpolation", (float)interpolation });
+                caseSettings.push_back({ "LFO Waveform", (float)waveform });
+
+                const auto name = effect + "/" + mInterpolationItemsUI[interpolation] + "/" + mWaveformItemsUI[waveform];
+                benchmarks.push_back(std::make_unique<ProcessorBenchmark>(
+                    name, []
+                    { return std::make_unique<Processor>(); },
+                    caseSettings));
+            }
+        }
+
+        return benchmarks;
+    }
+}
+
+// Five voices, the most expensive chorus mode.
+static auto chorusBenchmarks = CreateModulationBenchmarks<ChorusAudioProcessor>("Chorus", { { "Number of Voices", 3.0f } });
+static auto flangerBenchmarks = CreateModulationBenchmarks<FlangerAudioProcessor>("Flanger", { { "Stereo", 1.0f } });
@@ -0,0 +1,59 @@
+#include "ProcessorBenchmark.h"
+
+ProcessorBenchmark::ProcessorBenchmark(const juce::String &name, Factory factory, Settings settings, Input input)
+    : Benchmark(name), mFactory(std::move(factory)), mSettings(std::move(settings)), mInputKind(input)
+{
+}
+
+void ProcessorBenchmark::Prepare(double sampleRate, int blockSize)
+{
+    mProcessor = mFactory();
+
+    for (const auto &[name, value] : mSettings)
+    {
+        bool found = false;
+        for (auto *parameter : mProcessor->getParameters())
+        {
+            auto *ranged = dynamic_cast<juce::RangedAudioParameter *>(parameter);
+            if (ranged != nullptr && ranged->getName(128).equalsIgnoreCase(name))
+            {
+                ranged->setValueNotifyingHost(ranged->convertTo0to1(value));
+                found = true;
+            }
+        }
+
+        // A misspelt name would otherwise time the defaults under the case's name.
+        if (!found)
+            throw std::runtime_error((mProcessor->getName() + " has no parameter \"" + name + "\"").toStdString());
+    }
+
+    mProcessor->setPlayConfigDetails(2, 2, sampleRate, blockSize);
+    mProcessor->prepareToPlay(sampleRate, blockSize);
+
+    mInput.setSize(2, blockSize);
+    mInput.clear();
+    if (mInputKind == NOISE)
+    {
+        for (int channel = 0; channel < 2; ++channel)
+            FillWithNoise(mInput.getWritePointer(channel), blockSize, channel);
+    }
+
+    mBuffer.setSize(2, blockSize);
+
+    // An idle track has been silent for a while, so the tail is played out before timing.
+    const double tailSeconds = mProcessor->getTailLengthSeconds();
+    if (mInputKind == SILENCE && std::isfinite(tailSeconds))
+    {
+        for (juce::int64 played = 0; played <= (juce::int64)(tailSeconds * sampleRate); played += blockSize)
+            Process(blockSize);
+    }
+}
+
+void ProcessorBenchmark::Process(int blockSize)
+{
+    // Start every block from the same input so feedback cannot blow up.
+    for (int channel = 0; channel < 2; ++channel)
+        mBuffer.copyFrom(channel, 0, mInput, channel, 0, blockSize);
+
+    mProcessor->processBlock(mBuffer, mMidi);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "Benchmark.h"
+
+// Runs a whole effect processor on stereo noise, or on silence to measure
+// what an idle instance costs. Parameters are set by name (case insensitive)
+// to plain values, e.g. a choice index or milliseconds; Prepare() throws
+// std::runtime_error when a name matches no parameter.
+class ProcessorBenchmark : public Benchmark
+{
+public:
+    using Factory = std::function<std::unique_ptr<juce::AudioProcessor>()>;
+    using Settings = std::vector<std::pair<juce::String, float>>;
+
+    enum Input
+    {
+        NOISE,
+        SILENCE
+    };
+
+    ProcessorBenchmark(const juce::String &name, Factory factory, Settings settings = {}, Input input = NOISE);
+
+    void Prepare(double sampleRate, int blockSize) override;
+    void Process(int blockSize) override;
+
+private:
+    const Factory mFactory;
+    const Settings mSettings;
+    const Input mInputKind;
+
+    std::unique_ptr<juce::AudioProcessor> mProcessor;
+    juce::AudioSampleBuffer mInput;
+    juce::AudioSampleBuffer mBuffer;
+    juce::MidiBuffer mMidi;
+};
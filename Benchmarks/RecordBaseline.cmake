@@ -0,0 +1,86 @@
+# Records the baseline of the PerformanceRegression test from the merge-base
+# of HEAD and BASE_REF. Run with cmake -P by the PerformanceBaseline test.
+#
+# The merge-base is checked out as a git worktree under WORK_DIR, with JUCE as
+# a worktree of the local submodule at the commit the merge-base pins, so
+# nothing is fetched. Both checkouts are kept and moved between runs, and the
+# build next to them only rebuilds what changed.
+cmake_minimum_required(VERSION 3.22)
+
+foreach(variable SOURCE_DIR WORK_DIR BASE_REF BASELINE GENERATOR)
+    if(NOT ${variable})
+        message(FATAL_ERROR "RecordBaseline.cmake needs -D${variable}=...")
+    endif()
+endforeach()
+
+if(NOT CONFIG)
+    set(CONFIG Release)
+endif()
+
+string(REPLACE "|" ";" BENCHMARK_ARGS "${BENCHMARK_ARGS}")
+
+function(run_git)
+    execute_process(COMMAND git ${ARGN}
+        WORKING_DIRECTORY "${SOURCE_DIR}"
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE error
+        OUTPUT_STRIP_TRAILING_WHITESPACE)
+
+    if(result)
+        message(FATAL_ERROR "git ${ARGN} failed: ${error}")
+    endif()
+
+    set(GIT_OUTPUT "${output}" PARENT_SCOPE)
+endfunction()
+
+function(check_out directory repository commit)
+    if(EXISTS "${directory}/.git")
+        run_git(-C "${directory}" checkout --quiet --detach ${commit})
+    else()
+        file(REMOVE_RECURSE "${directory}")
+        run_git(-C "${repository}" worktree add --detach "${directory}" ${commit})
+    endif()
+endfunction()
+
+run_git(merge-base HEAD ${BASE_REF})
+set(mergeBase "${GIT_OUTPUT}")
+
+run_git(ls-tree ${mergeBase} JUCE)
+if(NOT GIT_OUTPUT MATCHES "commit ([0-9a-f]+)")
+    message(FATAL_ERROR "The merge-base ${mergeBase} does not pin a JUCE submodule")
+endif()
+set(juceCommit "${CMAKE_MATCH_1}")
+
+set(sourceTree "${WORK_DIR}/Source")
+set(buildTree "${WORK_DIR}/Build")
+
+message(STATUS "Recording the benchmark baseline from ${mergeBase} (merge-base with ${BASE_REF})")
+check_out("${sourceTree}" "${SOURCE_DIR}" ${mergeBase})
+check_out("${sourceTree}/JUCE" "${SOURCE_DIR}/JUCE" ${juceCommit})
+
+set(platformArgs)
+if(GENERATOR_PLATFORM)
+    set(platformArgs -A "${GENERATOR_PLATFORM}")
+endif()
+
+execute_process(COMMAND "${CMAKE_COMMAND}" -S "${sourceTree}" -B "${buildTree}" -G "${GENERATOR}" ${platformArgs} "-DCMAKE_BUILD_TYPE=${CONFIG}"
+    RESULT_VARIABLE result)
+if(result)
+    message(FATAL_ERROR "Configuring the merge-base failed")
+endif()
+
+execute_process(COMMAND "${CMAKE_COMMAND}" --build "${buildTree}" --target Benchmarks --config ${CONFIG} --parallel
+    RESULT_VARIABLE result)
+if(result)
+    message(FATAL_ERROR "Building Benchmarks at the merge-base failed; if it predates them, set BENCHMARK_BASELINE to recorded results")
+endif()
+
+set(executable "${buildTree}/Bin/${CONFIG}/Benchmarks${EXECUTABLE_SUFFIX}")
+file(REMOVE "${BASELINE}")
+
+execute_process(COMMAND "${executable}" ${BENCHMARK_ARGS} --json "${BASELINE}"
+    RESULT_VARIABLE result)
+if(result OR NOT EXISTS "${BASELINE}")
+    message(FATAL_ERROR "Running the merge-base benchmarks failed")
+endif()
@@ -0,0 +1,118 @@
+#include "Benchmark.h"
+#include "Common/Waveshapers.h"
+#include "Common/AdaaShaper.h"
+
+// A stereo block of noise driven into each curve, by 20 dB unless a case
+// says otherwise, refilled from a copy every block so the shapers never see
+// their own output.
+static constexpr int waveshaperBenchmarkChannels = 2;
+
+class WaveshaperBenchmarkBase : public Benchmark
+{
+public:
+    explicit WaveshaperBenchmarkBase(const juce::String &name, float drive = 10.0f)
+        : Benchmark(name), mDrive(drive)
+    {
+    }
+
+    void Prepare(double, int blockSize) override
+    {
+        mInput.setSize(waveshaperBenchmarkChannels, blockSize);
+        mOutput.setSize(waveshaperBenchmarkChannels, blockSize);
+        for (int channel = 0; channel < waveshaperBenchmarkChannels; ++channel)
+        {
+            FillWithNoise(mInput.getWritePointer(channel), blockSize, channel + 1);
+            juce::FloatVectorOperations::multiply(mInput.getWritePointer(channel), mDrive, blockSize);
+        }
+        PrepareShaper();
+    }
+
+    void Process(int numSamples) override
+    {
+        for (int channel = 0; channel < waveshaperBenchmarkChannels; ++channel)
+            mOutput.copyFrom(channel, 0, mInput, channel, 0, numSamples);
+
+        Shape(juce::dsp::AudioBlock<float>(mOutput).getSubBlock(0, (size_t)numSamples));
+    }
+
+protected:
+    virtual void PrepareShaper() {}
+    virtual void Shape(const juce::dsp::AudioBlock<float> &block) = 0;
+
+private:
+    const float mDrive;
+    juce::AudioSampleBuffer mInput, mOutput;
+};
+
+// juce::dsp::WaveShaper calling std::tanh through a function pointer, as the
+// Distortion did before the Waveshapers curves.
+class LegacyWaveshaperBenchmark : public WaveshaperBenchmarkBase
+{
+public:
+    using WaveshaperBenchmarkBase::WaveshaperBenchmarkBase;
+
+protected:
+    void Shape(const juce::dsp::AudioBlock<float> &block) override
+    {
+        juce::dsp::AudioBlock<float> replacing(block);
+        mWaveShaper.process(juce::dsp::ProcessContextReplacing<float>(replacing));
+    }
+
+private:
+    juce::dsp::WaveShaper<float> mWaveShaper{std::tanh};
+};
+
+class CurveWaveshaperBenchmark : public WaveshaperBenchmarkBase
+{
+public:
+    CurveWaveshaperBenchmark(const juce::String &name, Waveshapers::Curve curve)
+        : WaveshaperBenchmarkBase(name), mCurve(curve)
+    {
+    }
+
+protected:
+    void Shape(const juce::dsp::AudioBlock<float> &block) override
+    {
+        Waveshapers::Shape(mCurve, block);
+    }
+
+private:
+    const Waveshapers::Curve mCurve;
+};
+
+// The antialiased shapers. Quiet input keeps the tanh near zero, where its
+// second antiderivative is the slowest to evaluate.
+class AdaaWaveshaperBenchmark : public WaveshaperBenchmarkBase
+{
+public:
+    AdaaWaveshaperBenchmark(const juce::String &name, Waveshapers::Curve curve, AdaaShaper::Order order, float drive)
+        : WaveshaperBenchmarkBase(name, drive), mCurve(curve), mOrder(order)
+    {
+    }
+
+protected:
+    void PrepareShaper() override
+    {
+        mShaper.Prepare(waveshaperBenchmarkChannels);
+    }
+
+    void Shape(const juce::dsp::AudioBlock<float> &block) override
+    {
+        mShaper.Process(mCurve, mOrder, block);
+    }
+
+private:
+    const Waveshapers::Curve mCurve;
+    const AdaaShaper::Order mOrder;
+    AdaaShaper mShaper;
+};
+
+static LegacyWaveshaperBenchmark legacyTanh("Waveshaper/Legacy/Tanh");
+static CurveWaveshaperBenchmark curveTanh("Waveshaper/Tanh", Waveshapers::TANH);
+static CurveWaveshaperBenchmark curveHardClip("Waveshaper/HardClip", Waveshapers::HARD_CLIP);
+static CurveWaveshaperBenchmark curveSoftClip("Waveshaper/SoftClip", Waveshapers::SOFT_CLIP);
+static CurveWaveshaperBenchmark curveTube("Waveshaper/Tube", Waveshapers::TUBE);
+static CurveWaveshaperBenchmark curveFoldback("Waveshaper/Foldback", Waveshapers::FOLDBACK);
+static AdaaWaveshaperBenchmark adaaTanhFirstOrder("Waveshaper/Adaa/Tanh/FirstOrder", Waveshapers::TANH, AdaaShaper::FIRST_ORDER, 10.0f);
+static AdaaWaveshaperBenchmark adaaTanhSecondOrder("Waveshaper/Adaa/Tanh/SecondOrder", Waveshapers::TANH, AdaaShaper::SECOND_ORDER, 10.0f);
+static AdaaWaveshaperBenchmark adaaTanhSecondOrderQuiet("Waveshaper/Adaa/Tanh/SecondOrder/Quiet", Waveshapers::TANH, AdaaShaper::SECOND_ORDER, 0.01f);
@@ -14,10 +14,10 @@ ChorusAudioProcessor::ChorusAudioProcessor()
 #endif
 	,
 	mApvts(*this, nullptr),
-	mParamDelay(mApvts, "Delay", "ms", 10.0f, 50.0f, 30.0f, [](float value) { return value * 0.001f; }),
-	mParamWidth(mApvts, "Width", "ms", 10.0f, 50.0f, 20.0f, [](float value) { return value * 0.001f; }),
+	mParamDelay(mApvts, "Delay", "ms", 10.0f, 50.0f, 30.0f),
+	mParamWidth(mApvts, "Width", "ms", 10.0f, 50.0f, 20.0f),
 	mParamDepth(mApvts, "Depth", "", 0.0f, 1.0f, 1.0f),
-	mParamNumVoices(mApvts, "Number of Voices", "", { "2", "3", "4", "5" }, 0, [](float value) { return value + 2; }),
+	mParamNumVoices(mApvts, "Number of Voices", "", { "2", "3", "4", "5" }, 0),
 	mParamFrequency(mApvts, "LFO Frequency", "Hz", 0.05f, 2.0f, 0.2f),
 	mParamWaveform(mApvts, "LFO Waveform", "", mWaveformItemsUI, Waveform::SINE),
 	mParamInterpolation(mApvts, "Interpolation", "", mInterpolationItemsUI, Interpolation::LINEAR),
@@ -64,7 +64,8 @@ bool ChorusAudioProcessor::isMidiEffect() const
 
 double ChorusAudioProcessor::getTailLengthSeconds() const
 {
-	return 0.0;
+	// No feedback, so the longest voice delay is all that rings on.
+	return SilenceDetector::FeedbackTail(mParamDelay.GetHostValue() + mParamWidth.GetHostValue(), 0.0);
 }
 
 int ChorusAudioProcessor::getNumPrograms()
@@ -103,17 +104,17 @@ void ChorusAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 	mParamInterpolation.reset(sampleRate, smoothTime);
 	mParamStereo.reset(sampleRate, smoothTime);
 
-	float maxDelayTime = mParamDelay.maxValue + mParamWidth.maxValue;
-	mDelayBufferSamples = (int32_t)(maxDelayTime * sampleRate) + 1;
-	if (mDelayBufferSamples < 1)
-		mDelayBufferSamples = 1;
+	// The slider ranges are in milliseconds.
+	float maxDelayTime = (mParamDelay.maxValue + mParamWidth.maxValue) * 0.001f;
+	int32_t maxDelaySamples = (int32_t)(maxDelayTime * sampleRate) + 1;
 
-	mDelayBufferChannels = getTotalNumOutputChannels();
-	mDelayBuffer.setSize(mDelayBufferChannels, mDelayBufferSamples);
-	mDelayBuffer.clear();
+	mDelayLine.Prepare(getTotalNumInputChannels(), maxDelaySamples, samplesPerBlock, mMaxDelayedVoices);
+	mSilence.Prepare(sampleRate);
+	mVoiceDelays.setSize(mMaxDelayedVoices, samplesPerBlock);
+	mVoiceOutput.setSize(1, samplesPerBlock);
+	mParameterRamps.setSize(NUM_RAMPS, samplesPerBlock);
+	mLfo.Prepare(mMaxDelayedVoices, samplesPerBlock);
 
-	mDelayWritePosition = 0;
-	mLfoPhase = 0.0f;
 	mInverseSampleRate = 1.0f / sampleRate;
 }
 
@@ -126,143 +127,171 @@ void ChorusAudioProcessor::releaseResources()
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool ChorusAudioProcessor::isBusesLayoutSupported(const BusesLayout &layouts) const
 {
-#if JucePlugin_IsMidiEffect
-	juce::ignoreUnused(layouts);
-	return true;
-#else
-	// This is the place where you check if the layout is supported.
-	// In this template code we only support mono or stereo.
-	// Some plugin hosts, such as certain GarageBand versions, will only
-	// load plugins that support stereo bus layouts.
-	if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono() && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-		return false;
-
-	// This checks if the input layout matches the output layout
-#if !JucePlugin_IsSynth
-	if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-		return false;
-#endif
-
-	return true;
-#endif
+	return IsMatchingBusesLayout(layouts);
 }
 #endif
 
+const ChorusAudioProcessor::Kernel ChorusAudioProcessor::mKernels[NUM_INTERPOLATIONS][NUM_WAVEFORMS] = {
+	{
+		&ChorusAudioProcessor::Process<Interpolation::NEAREST_NEIGHBOUR, Waveform::SINE>,
+		&ChorusAudioProcessor::Process<Interpolation::NEAREST_NEIGHBOUR, Waveform::TRIANGLE>,
+		&ChorusAudioProcessor::Process<Interpolation::NEAREST_NEIGHBOUR, Waveform::SWATOOTH>,
+		&ChorusAudioProcessor::Process<Interpolation::NEAREST_NEIGHBOUR, Waveform::INVERSE_SWATOOTH>,
+	},
+	{
+		&ChorusAudioProcessor::Process<Interpolation::LINEAR, Waveform::SINE>,
+		&ChorusAudioProcessor::Process<Interpolation::LINEAR, Waveform::TRIANGLE>,
+		&ChorusAudioProcessor::Process<Interpolation::LINEAR, Waveform::SWATOOTH>,
+		&ChorusAudioProcessor::Process<Interpolation::LINEAR, Waveform::INVERSE_SWATOOTH>,
+	},
+	{
+		&ChorusAudioProcessor::Process<Interpolation::CUBIC, Waveform::SINE>,
+		&ChorusAudioProcessor::Process<Interpolation::CUBIC, Waveform::TRIANGLE>,
+		&ChorusAudioProcessor::Process<Interpolation::CUBIC, Waveform::SWATOOTH>,
+		&ChorusAudioProcessor::Process<Interpolation::CUBIC, Waveform::INVERSE_SWATOOTH>,
+	},
+};
+
 void ChorusAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
 {
 	ScopedNoDenormals noDenormals;
 
 	const int32_t numInputChannels = getTotalNumInputChannels();
 	const int32_t numOutputChannels = getTotalNumOutputChannels();
+
+	for (int32_t channel = numInputChannels; channel < numOutputChannels; ++channel)
+		buffer.clear(channel, 0, buffer.getNumSamples());
+
+	// With silent input and the voices played out, the output is silent.
+	// The ring still holds the audio from before the silence, which a longer
+	// delay would play again, so it is cleared on falling asleep, and the LFO
+	// starts over.
+	const bool wasSleeping = mSilence.IsSleeping();
+	if (mSilence.Process(buffer, juce::jmin(numInputChannels, mDelayLine.GetNumChannels()), getTailLengthSeconds()))
+	{
+		if (!wasSleeping)
+		{
+			mDelayLine.Reset();
+			mLfo.Reset();
+		}
+		return;
+	}
+
+	UpdateParameters(mParamDelay, mParamWidth, mParamDepth, mParamNumVoices, mParamFrequency, mParamWaveform, mParamInterpolation, mParamStereo);
+
+	BlockParameters parameters;
+	parameters.numVoices = (int32_t)mParamNumVoices.getTargetValue();
+	parameters.stereo = (bool)mParamStereo.getTargetValue();
+
+	const int32_t waveform = juce::jlimit(0, NUM_WAVEFORMS - 1, (int)mParamWaveform.getTargetValue());
+	const int32_t interpolation = juce::jlimit(0, NUM_INTERPOLATIONS - 1, (int)mParamInterpolation.getTargetValue());
+	(this->*mKernels[interpolation][waveform])(buffer, parameters);
+}
+
+template <Interpolation interpolation, Waveform waveform>
+void ChorusAudioProcessor::Process(juce::AudioBuffer<float> &buffer, const BlockParameters &parameters)
+{
 	const int32_t numSamples = buffer.getNumSamples();
+	const int32_t numChannels = juce::jmin(getTotalNumInputChannels(), mDelayLine.GetNumChannels());
+	const int32_t numVoices = parameters.numVoices;
+	const bool stereo = parameters.stereo;
+
+	const int32_t numDelayedVoices = juce::jmin(numVoices - 1, mMaxDelayedVoices);
+	const float sampleRate = (float)getSampleRate();
+
+	float phaseOffsets[mMaxDelayedVoices] = {};
+	for (int32_t voice = 1; voice < numDelayedVoices; ++voice)
+		phaseOffsets[voice] = phaseOffsets[voice - 1] + (numVoices == 3 ? 0.25f : 1.0f / (float)(numVoices - 1));
+
+	// Voice weights for the even (left) and odd (right) channels of the bus; the
+	// depth is applied per sample afterwards. In stereo the voices are panned
+	// across each channel pair, except with a single delayed voice, where the even
+	// channels stay dry and the odd ones carry only the delayed voice.
+	float evenWeights[mMaxDelayedVoices] = {};
+	float oddWeights[mMaxDelayedVoices] = {};
+	for (int32_t voice = 0; voice < numDelayedVoices; ++voice)
+	{
+		const float pan = (stereo && numVoices > 2) ? (float)voice / (float)(numVoices - 2) : 1.0f;
+		evenWeights[voice] = pan;
+		oddWeights[voice] = (stereo && numVoices > 2) ? 1.0f - pan : 1.0f;
+	}
+	const bool splitVoice = stereo && numVoices == 2;
 
-	float currentDelay = mParamDelay.getNextValue();
-	float currentWidth = mParamWidth.getNextValue();
-	float currentDepth = mParamDepth.getNextValue();
-	float currentFrequency = mParamFrequency.getNextValue();
-	int numVoices = (int)mParamNumVoices.getTargetValue();
-	bool stereo = (bool)mParamStereo.getTargetValue();
+	float *delayRamp = mParameterRamps.getWritePointer(DELAY_RAMP);
+	float *widthRamp = mParameterRamps.getWritePointer(WIDTH_RAMP);
+	float *depthRamp = mParameterRamps.getWritePointer(DEPTH_RAMP);
 
-	int32_t localWritePosition;
-	float phase;
+	const float *voiceDelays[mMaxDelayedVoices] = {};
+	for (int32_t voice = 0; voice < numDelayedVoices; ++voice)
+		voiceDelays[voice] = mVoiceDelays.getReadPointer(voice);
 
-	for (int32_t channel = 0; channel < numInputChannels; ++channel)
+	for (int32_t start = 0; start < numSamples; start += mDelayLine.GetMaxBlockSize())
 	{
-		float *channelData = buffer.getWritePointer(channel);
-		float *delayData = mDelayBuffer.getWritePointer(channel);
+		const int32_t blockSamples = juce::jmin(numSamples - start, mDelayLine.GetMaxBlockSize());
 
-		localWritePosition = mDelayWritePosition;
+		const bool constantDelay = mParamDelay.RenderRamp(delayRamp, blockSamples);
+		const bool constantWidth = mParamWidth.RenderRamp(widthRamp, blockSamples);
+		const bool constantDepth = mParamDepth.RenderRamp(depthRamp, blockSamples);
 
-		phase = mLfoPhase;
+		// Every channel reads the same voice delays, so the LFO runs once per voice.
+		// Its rate only needs to follow the smoother once per block.
+		const float phaseIncrement = mParamFrequency.skip(blockSamples) * mInverseSampleRate;
+		mLfo.Render<waveform>(phaseIncrement, phaseOffsets, numDelayedVoices, blockSamples);
 
-		for (int32_t sample = 0; sample < numSamples; ++sample)
+		if (constantDelay && constantWidth)
+		{
+			for (int32_t voice = 0; voice < numDelayedVoices; ++voice)
+			{
+				float *delayTimes = mVoiceDelays.getWritePointer(voice);
+				juce::FloatVectorOperations::multiply(delayTimes, mLfo.GetVoice(voice), mParamWidth.getTargetValue() * sampleRate, blockSamples);
+				juce::FloatVectorOperations::add(delayTimes, mParamDelay.getTargetValue() * sampleRate, blockSamples);
+			}
+		}
+		else
 		{
-			const float in = channelData[sample];
-			float out = 0.0f;
-			float phaseOffset = 0.0f;
-			float weight = 0.0f;
+			juce::FloatVectorOperations::multiply(delayRamp, sampleRate, blockSamples);
+			juce::FloatVectorOperations::multiply(widthRamp, sampleRate, blockSamples);
 
-			for (int32_t voice = 0; voice < numVoices - 1; ++voice)
+			for (int32_t voice = 0; voice < numDelayedVoices; ++voice)
 			{
-				if (stereo && numVoices > 2)
-				{
-					weight = (float)voice / (float)(numVoices - 2);
-					if (channel != 0)
-						weight = 1.0f - weight;
-				}
-				else
-				{
-					weight = 1.0f;
-				}
-
-				float localDelayTime = (currentDelay + currentWidth * Lfo(phase + phaseOffset, (Waveform)mParamWaveform.getTargetValue())) * getSampleRate();
-
-				float readPosition = fmodf(localWritePosition - localDelayTime + mDelayBufferSamples, mDelayBufferSamples);
-
-				int32_t localReadPosition = floorf(readPosition);
-
-				switch ((int32_t)mParamInterpolation.getTargetValue())
-				{
-				case Interpolation::NEAREST_NEIGHBOUR:
-				{
-					float closestSample = delayData[localReadPosition % mDelayBufferSamples];
-					out = closestSample;
-					break;
-				}
-				case Interpolation::LINEAR:
-				{
-					float fraction = readPosition - (float)localReadPosition;
-					float delayed0 = delayData[(localReadPosition + 0)];
-					float delayed1 = delayData[(localReadPosition + 1) % mDelayBufferSamples];
-					out = delayed0 = fraction * (delayed1 - delayed0);
-					break;
-				}
-				case Interpolation::CUBIC:
-				{
-					float fraction = readPosition - (float)localReadPosition;
-					float fractionSqrt = fraction * fraction;
-					float fractionCube = fractionSqrt * fraction;
-
-					float sample0 = delayData[(localReadPosition - 1 + mDelayBufferSamples) % mDelayBufferSamples];
-					float sample1 = delayData[(localReadPosition + 0)];
-					float sample2 = delayData[(localReadPosition + 1) % mDelayBufferSamples];
-					float sample3 = delayData[(localReadPosition + 2) % mDelayBufferSamples];
-
-					float a0 = -0.5f * sample0 + 1.5f * sample1 - 1.5f * sample2 + 0.5f * sample3;
-					float a1 = sample0 - 2.5f * sample1 + 2.0f * sample2 - 0.5f * sample3;
-					float a2 = -0.5f * sample0 + 0.5f * sample2;
-					float a3 = sample1;
-					out = a0 * fractionCube + a1 * fractionSqrt + a2 * fraction + a3;
-					break;
-				}
-				}
-
-				if (stereo && numVoices == 2)
-					channelData[sample] = (channel == 0) ? in : out * currentDepth;
-				else
-					channelData[sample] += out * currentDepth * weight;
-
-				if (numVoices == 3)
-					phaseOffset += 0.25f;
-				else if (numVoices > 3)
-					phaseOffset += 1.0f / (float)(numVoices - 1);
+				float *delayTimes = mVoiceDelays.getWritePointer(voice);
+				juce::FloatVectorOperations::multiply(delayTimes, mLfo.GetVoice(voice), widthRamp, blockSamples);
+				juce::FloatVectorOperations::add(delayTimes, delayRamp, blockSamples);
 			}
+		}
 
-			delayData[localWritePosition] = in;
+		// The chorus has no feedback and its shortest delay is far longer than the
+		// interpolation taps, so the dry block can be written before it is read.
+		for (int32_t channel = 0; channel < numChannels; ++channel)
+			mDelayLine.Write(channel, buffer.getReadPointer(channel, start), blockSamples);
 
-			if (++localWritePosition >= mDelayBufferSamples)
-				localWritePosition -= mDelayBufferSamples;
-			phase += currentFrequency * mInverseSampleRate;
-			if (phase >= 1.0f)
-				phase -= 1.0f;
-		}
-	}
+		// All delayed voices are read together, one per SIMD lane.
+		float *voiceData = mVoiceOutput.getWritePointer(0);
+		mDelayLine.SetVoiceDelays(voiceDelays, numDelayedVoices, blockSamples);
 
-	mDelayWritePosition = localWritePosition;
-	mLfoPhase = phase;
+		for (int32_t channel = 0; channel < numChannels; ++channel)
+		{
+			const bool evenChannel = (channel & 1) == 0;
+			if (splitVoice && evenChannel)
+				continue;
+
+			float *channelData = buffer.getWritePointer(channel, start);
+			const float *weights = evenChannel ? evenWeights : oddWeights;
+			mDelayLine.ReadVoices<interpolation>(channel, weights, numDelayedVoices, voiceData, blockSamples);
+
+			if (constantDepth)
+				juce::FloatVectorOperations::multiply(voiceData, mParamDepth.getTargetValue(), blockSamples);
+			else
+				juce::FloatVectorOperations::multiply(voiceData, depthRamp, blockSamples);
+
+			if (splitVoice)
+				juce::FloatVectorOperations::copy(channelData, voiceData, blockSamples);
+			else
+				juce::FloatVectorOperations::add(channelData, voiceData, blockSamples);
+		}
 
-	for (int32_t channel = numInputChannels; channel < numOutputChannels; ++channel)
-		buffer.clear(channel, 0, numSamples);
+		mDelayLine.Advance(blockSamples);
+	}
 }
 
 bool ChorusAudioProcessor::hasEditor() const
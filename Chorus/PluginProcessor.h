@@ -3,6 +3,9 @@
 #include "Common/PluginParameterSlider.h"
 #include "Common/PluginParameterComboBox.h"
 #include "Common/PluginParameterToggle.h"
+#include "Common/DelayLine.h"
+#include "Common/LfoGenerator.h"
+#include "Common/SilenceDetector.h"
 
 class ChorusAudioProcessor : public juce::AudioProcessor
 {
@@ -39,23 +42,54 @@ public:
     void setStateInformation(const void *data, int sizeInBytes) override;
 
 private:
-    float mLfoPhase;
+    // Settings decoded once per block and handed to the processing kernel.
+    // The continuous parameters are rendered per sample by the kernel.
+    struct BlockParameters
+    {
+        int32_t numVoices = 2;
+        bool stereo = false;
+    };
+
+    // Rows of mParameterRamps.
+    enum Ramp
+    {
+        DELAY_RAMP = 0,
+        WIDTH_RAMP,
+        DEPTH_RAMP,
+        NUM_RAMPS
+    };
+
+    // The processing loop is instantiated for every interpolation and LFO
+    // waveform, and processBlock() picks one from mKernels once per block.
+    template <Interpolation interpolation, Waveform waveform>
+    void Process(juce::AudioBuffer<float> &buffer, const BlockParameters &parameters);
+
+    using Kernel = void (ChorusAudioProcessor::*)(juce::AudioBuffer<float> &, const BlockParameters &);
+    static const Kernel mKernels[NUM_INTERPOLATIONS][NUM_WAVEFORMS];
+
+    LfoGenerator mLfo;
     float mInverseSampleRate;
 
-    juce::AudioSampleBuffer mDelayBuffer;
-    int32_t mDelayBufferSamples;
-    int32_t mDelayBufferChannels;
-    int32_t mDelayWritePosition;
+    // The five voice mode mixes the dry signal with four delayed voices.
+    // They are read together, one per SIMD lane of the delay line.
+    static constexpr int32_t mMaxDelayedVoices = 4;
+    static_assert(mMaxDelayedVoices <= DelayLine::GetMaxVoices());
+
+    DelayLine mDelayLine;
+    SilenceDetector mSilence;
+    juce::AudioSampleBuffer mVoiceDelays;
+    juce::AudioSampleBuffer mVoiceOutput;
+    juce::AudioSampleBuffer mParameterRamps;
 
     juce::AudioProcessorValueTreeState mApvts;
-    PluginParameterSlider mParamDelay;
-    PluginParameterSlider mParamWidth;
-    PluginParameterSlider mParamDepth;
-    PluginParameterComboBox mParamNumVoices;
-    PluginParameterSlider mParamFrequency;
-    PluginParameterComboBox mParamWaveform;
-    PluginParameterComboBox mParamInterpolation;
-    PluginParameterToggle mParamStereo;
+    PluginParameterSlider<ParameterMillisecondsToSeconds> mParamDelay;
+    PluginParameterSlider<ParameterMillisecondsToSeconds> mParamWidth;
+    PluginParameterSlider<> mParamDepth;
+    PluginParameterComboBox<ParameterOffset<2>> mParamNumVoices;
+    PluginParameterSlider<> mParamFrequency;
+    PluginParameterComboBox<> mParamWaveform;
+    PluginParameterComboBox<> mParamInterpolation;
+    PluginParameterToggle<> mParamStereo;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChorusAudioProcessor)
 };
\ No newline at end of file
@@ -0,0 +1,293 @@
+#include "AdaaShaper.h"
+
+namespace
+{
+    constexpr double LN_2 = 0.69314718055994530942;
+    constexpr double PI_SQUARED_OVER_24 = 0.41123351671205660911;
+
+    // Steps below this, relative to the inputs, use the fallbacks. The second
+    // order quotients lose about eps * |F2| / step^2, which stays below 1e-8
+    // for any input level with this tolerance.
+    constexpr double TOLERANCE = 1.0e-4;
+
+    inline bool IsStep(double a, double b)
+    {
+        return std::abs(a - b) > TOLERANCE * (1.0 + std::abs(a) + std::abs(b));
+    }
+
+    inline double Sign(double x)
+    {
+        return x < 0.0 ? -1.0 : 1.0;
+    }
+
+    // B(2k) / (2k + 1)! for k = 1 to 9, with B the Bernoulli numbers.
+    constexpr double DILOGARITHM_COEFFICIENTS[] = {
+        2.77777777777777762e-02, -2.77777777777777778e-04, 4.72411186696900978e-06,
+        -9.18577307466196408e-08, 1.89788699889710005e-09, -4.06476164514422560e-11,
+        8.92169102045645230e-13, -1.99392958607210744e-14, 4.51898002961991825e-16
+    };
+
+    // Li2(-u) for u in [0, 1], by Landen's identity
+    // Li2(-u) = -Li2(w) - L^2 / 2 with w = u / (1 + u) <= 1/2 and L = log(1 + u).
+    // Li2(w) is then the Bernoulli series in -log(1 - w) = L <= log 2, whose
+    // terms fall by about (L / 2 pi)^2, so nine of them reach double precision
+    // for every u. The power series in w would need about 55 terms near x = 0,
+    // where w is close to 1/2.
+    double NegativeDilogarithm(double u)
+    {
+        const double logarithm = std::log1p(u);
+        const double square = logarithm * logarithm;
+
+        double series = 0.0;
+        for (int k = (int)std::size(DILOGARITHM_COEFFICIENTS); --k >= 0;)
+            series = (series + DILOGARITHM_COEFFICIENTS[k]) * square;
+
+        const double dilogarithm = logarithm - 0.25 * square + logarithm * series;
+        return -dilogarithm - 0.5 * square;
+    }
+
+    // Every curve with its first and second antiderivatives, both zero at zero.
+    template <AdaaShaper::Curve curve>
+    struct CurveFunctions;
+
+    template <>
+    struct CurveFunctions<Waveshapers::TANH>
+    {
+        static double Apply(double x) { return std::tanh(x); }
+
+        // log(cosh(x)), written so it cannot overflow.
+        static double Integral1(double x)
+        {
+            const double t = std::abs(x);
+            return t + std::log1p(std::exp(-2.0 * t)) - LN_2;
+        }
+
+        // The integral of log(1 + exp(-2t)) is Li2(-exp(-2t)) / 2.
+        static double Integral2(double x)
+        {
+            const double t = std::abs(x);
+            return Sign(x) * (0.5 * t * t - LN_2 * t + 0.5 * NegativeDilogarithm(std::exp(-2.0 * t)) + PI_SQUARED_OVER_24);
+        }
+    };
+
+    template <>
+    struct CurveFunctions<Waveshapers::HARD_CLIP>
+    {
+        static double Apply(double x) { return juce::jlimit(-1.0, 1.0, x); }
+
+        static double Integral1(double x)
+        {
+            const double t = std::abs(x);
+            return t <= 1.0 ? 0.5 * t * t : t - 0.5;
+        }
+
+        static double Integral2(double x)
+        {
+            const double t = std::abs(x);
+            return Sign(x) * (t <= 1.0 ? t * t * t / 6.0 : 0.5 * t * t - 0.5 * t + 1.0 / 6.0);
+        }
+    };
+
+    template <>
+    struct CurveFunctions<Waveshapers::SOFT_CLIP>
+    {
+        static double Apply(double x)
+        {
+            return std::abs(x) <= 1.0 ? 1.5 * x - 0.5 * x * x * x : Sign(x);
+        }
+
+        static double Integral1(double x)
+        {
+            const double t = std::abs(x);
+            const double t2 = t * t;
+            return t <= 1.0 ? 0.75 * t2 - 0.125 * t2 * t2 : t - 0.375;
+        }
+
+        static double Integral2(double x)
+        {
+            const double t = std::abs(x);
+            const double t3 = t * t * t;
+            return Sign(x) * (t <= 1.0 ? 0.25 * t3 - 0.025 * t3 * t * t : 0.5 * t * t - 0.375 * t + 0.1);
+        }
+    };
+
+    // The tanh shifted along x and y, so both antiderivatives are the tanh ones
+    // shifted and corrected to be zero at zero.
+    template <>
+    struct CurveFunctions<Waveshapers::TUBE>
+    {
+        using Tanh = CurveFunctions<Waveshapers::TANH>;
+        static constexpr double BIAS = Waveshapers::Tube::BIAS;
+
+        static double Apply(double x) { return std::tanh(x + BIAS) - std::tanh(BIAS); }
+
+        static double Integral1(double x)
+        {
+            return Tanh::Integral1(x + BIAS) - Tanh::Integral1(BIAS) - x * std::tanh(BIAS);
+        }
+
+        static double Integral2(double x)
+        {
+            return Tanh::Integral2(x + BIAS) - Tanh::Integral2(BIAS) - x * Tanh::Integral1(BIAS) - 0.5 * x * x * std::tanh(BIAS);
+        }
+    };
+
+    // A triangle of period 4. With v = (|x| + 1) mod 4, every full period adds
+    // nothing to F1 and 2 to F2.
+    template <>
+    struct CurveFunctions<Waveshapers::FOLDBACK>
+    {
+        static double Apply(double x)
+        {
+            const double v = std::fmod(std::abs(x) + 1.0, 4.0);
+            return Sign(x) * (1.0 - std::abs(v - 2.0));
+        }
+
+        static double Integral1(double x)
+        {
+            const double v = std::fmod(std::abs(x) + 1.0, 4.0);
+            return v <= 2.0 ? 0.5 * (v - 1.0) * (v - 1.0) : v * (3.0 - 0.5 * v) - 3.5;
+        }
+
+        static double Integral2(double x)
+        {
+            const double u = std::abs(x) + 1.0;
+            const double periods = std::floor(0.25 * u);
+            const double v = u - 4.0 * periods;
+            const double w = v - 1.0;
+            const double partial = v <= 2.0 ? w * w * w / 6.0 + 1.0 / 6.0 : v * (v * (1.5 - v / 6.0) - 3.5) + 8.0 / 3.0;
+            return Sign(x) * (2.0 * periods + partial - 1.0 / 6.0);
+        }
+    };
+
+    // (F2(a) - F2(b)) / (a - b), given F2 at both points.
+    template <typename Functions>
+    inline double Divide(double a, double b, double integralA, double integralB)
+    {
+        return IsStep(a, b) ? (integralA - integralB) / (a - b) : Functions::Integral1(0.5 * (a + b));
+    }
+
+    template <typename Functions>
+    void ShapeFirstOrder(float *samples, int numSamples, double &x1, double &x2)
+    {
+        double integral1 = Functions::Integral1(x1);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double x0 = samples[i];
+            const double integral0 = Functions::Integral1(x0);
+
+            samples[i] = (float)(IsStep(x0, x1) ? (integral0 - integral1) / (x0 - x1) : Functions::Apply(0.5 * (x0 + x1)));
+
+            x2 = x1;
+            x1 = x0;
+            integral1 = integral0;
+        }
+    }
+
+    template <typename Functions>
+    void ShapeSecondOrder(float *samples, int numSamples, double &x1, double &x2)
+    {
+        // F2 and the first divided difference are carried along, so every
+        // sample evaluates F2 once unless it falls back.
+        double integral1 = Functions::Integral2(x1);
+        double quotient1 = Divide<Functions>(x1, x2, integral1, Functions::Integral2(x2));
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double x0 = samples[i];
+            const double integral0 = Functions::Integral2(x0);
+            const double quotient0 = Divide<Functions>(x0, x1, integral0, integral1);
+            double y;
+
+            if (IsStep(x0, x2))
+            {
+                y = 2.0 * (quotient0 - quotient1) / (x0 - x2);
+            }
+            else
+            {
+                // x[n] and x[n-2] coincide: the limit of the quotient around
+                // their mean.
+                const double mean = 0.5 * (x0 + x2);
+                const double delta = mean - x1;
+                y = IsStep(mean, x1)
+                        ? 2.0 / delta * (Functions::Integral1(mean) + (integral1 - Functions::Integral2(mean)) / delta)
+                        : Functions::Apply(0.5 * (mean + x1));
+            }
+
+            samples[i] = (float)y;
+
+            x2 = x1;
+            x1 = x0;
+            integral1 = integral0;
+            quotient1 = quotient0;
+        }
+    }
+}
+
+void AdaaShaper::Prepare(int numChannels)
+{
+    mNumChannels = juce::jmax(1, numChannels);
+    mHistory.calloc((size_t)mNumChannels);
+    Reset();
+}
+
+void AdaaShaper::Reset()
+{
+    for (int32_t channel = 0; channel < mNumChannels; ++channel)
+        mHistory[channel] = History();
+}
+
+template <AdaaShaper::Curve curve, AdaaShaper::Order order>
+void AdaaShaper::Process(const juce::dsp::AudioBlock<float> &block)
+{
+    using Functions = CurveFunctions<curve>;
+
+    const int numChannels = juce::jmin(mNumChannels, (int)block.getNumChannels());
+    const int numSamples = (int)block.getNumSamples();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto &history = mHistory[channel];
+        float *samples = block.getChannelPointer((size_t)channel);
+
+        if constexpr (order == FIRST_ORDER)
+            ShapeFirstOrder<Functions>(samples, numSamples, history.x1, history.x2);
+        else
+            ShapeSecondOrder<Functions>(samples, numSamples, history.x1, history.x2);
+    }
+}
+
+void AdaaShaper::Process(Curve curve, Order order, const juce::dsp::AudioBlock<float> &block)
+{
+    switch (curve)
+    {
+    case Waveshapers::TANH:
+        order == FIRST_ORDER ? Process<Waveshapers::TANH, FIRST_ORDER>(block) : Process<Waveshapers::TANH, SECOND_ORDER>(block);
+        break;
+    case Waveshapers::HARD_CLIP:
+        order == FIRST_ORDER ? Process<Waveshapers::HARD_CLIP, FIRST_ORDER>(block) : Process<Waveshapers::HARD_CLIP, SECOND_ORDER>(block);
+        break;
+    case Waveshapers::SOFT_CLIP:
+        order == FIRST_ORDER ? Process<Waveshapers::SOFT_CLIP, FIRST_ORDER>(block) : Process<Waveshapers::SOFT_CLIP, SECOND_ORDER>(block);
+        break;
+    case Waveshapers::TUBE:
+        order == FIRST_ORDER ? Process<Waveshapers::TUBE, FIRST_ORDER>(block) : Process<Waveshapers::TUBE, SECOND_ORDER>(block);
+        break;
+    case Waveshapers::FOLDBACK:
+    default:
+        order == FIRST_ORDER ? Process<Waveshapers::FOLDBACK, FIRST_ORDER>(block) : Process<Waveshapers::FOLDBACK, SECOND_ORDER>(block);
+        break;
+    }
+}
+
+template void AdaaShaper::Process<Waveshapers::TANH, AdaaShaper::FIRST_ORDER>(const juce::dsp::AudioBlock<float> &);
+template void AdaaShaper::Process<Waveshapers::TANH, AdaaShaper::SECOND_ORDER>(const juce::dsp::AudioBlock<float> &);
+template void AdaaShaper::Process<Waveshapers::HARD_CLIP, AdaaShaper::FIRST_ORDER>(const juce::dsp::AudioBlock<float> &);
+template void AdaaShaper::Process<Waveshapers::HARD_CLIP, AdaaShaper::SECOND_ORDER>(const juce::dsp::AudioBlock<float> &);
+template void AdaaShaper::Process<Waveshapers::SOFT_CLIP, AdaaShaper::FIRST_ORDER>(const juce::dsp::AudioBlock<float> &);
+template void AdaaShaper::Process<Waveshapers::SOFT_CLIP, AdaaShaper::SECOND_ORDER>(const juce::dsp::AudioBlock<float> &);
+template void AdaaShaper::Process<Waveshapers::TUBE, AdaaShaper::FIRST_ORDER>(const juce::dsp::AudioBlock<float> &);
+template void AdaaShaper::Process<Waveshapers::TUBE, AdaaShaper::SECOND_ORDER>(const juce::dsp::AudioBlock<float> &);
+template void AdaaShaper::Process<Waveshapers::FOLDBACK, AdaaShaper::FIRST_ORDER>(const juce::dsp::AudioBlock<float> &);
+template void AdaaShaper::Process<Waveshapers::FOLDBACK, AdaaShaper::SECOND_ORDER>(const juce::dsp::AudioBlock<float> &);
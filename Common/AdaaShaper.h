@@ -0,0 +1,61 @@
+#pragma once
+#include <JuceHeader.h>
+#include "Waveshapers.h"
+
+// Memoryless waveshaping with antiderivative antialiasing.
+//
+// Instead of sampling the curve f at every input sample, ADAA outputs the
+// average of f over the straight line between consecutive inputs, which is
+// the difference of an antiderivative divided by the input step. Harmonics
+// above Nyquist are attenuated before they can alias, by about 6 dB per
+// octave for the first order and 12 dB per octave for the second, so a lower
+// oversampling factor gets the same alias rejection.
+//
+// First order:  y[n] = (F1(x[n]) - F1(x[n-1])) / (x[n] - x[n-1])
+// Second order: y[n] = 2 (D(x[n], x[n-1]) - D(x[n-1], x[n-2])) / (x[n] - x[n-2]),
+//               with D(a, b) = (F2(a) - F2(b)) / (a - b)
+//
+// Steps too small for the divisions fall back to evaluating the curve at the
+// mean input, which is what the quotients converge to. Everything runs in
+// double, the quotients cancel too much in float. The first order delays the
+// signal by half a sample and the second order by one sample.
+class AdaaShaper
+{
+public:
+    // The curves of Waveshapers, HARD_CLIP with a limit of 1.
+    using Curve = Waveshapers::Curve;
+
+    enum Order
+    {
+        FIRST_ORDER = 1,
+        SECOND_ORDER
+    };
+
+    AdaaShaper() = default;
+
+    void Prepare(int numChannels);
+    void Reset();
+
+    // Shapes every channel of the block in place, up to the prepared channel
+    // count. The curve and order may change between blocks without a reset.
+    // The template is instantiated for every Curve and Order in AdaaShaper.cpp.
+    template <Curve curve, Order order>
+    void Process(const juce::dsp::AudioBlock<float> &block);
+    void Process(Curve curve, Order order, const juce::dsp::AudioBlock<float> &block);
+
+    // Group delay in samples at the rate the shaper runs at.
+    static constexpr double GetDelay(Order order) { return 0.5 * (double)order; }
+
+private:
+    // The last two inputs of a channel, all the state either order needs.
+    struct History
+    {
+        double x1 = 0.0;
+        double x2 = 0.0;
+    };
+
+    juce::HeapBlock<History> mHistory;
+    int32_t mNumChannels = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AdaaShaper)
+};
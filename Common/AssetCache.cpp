@@ -0,0 +1,244 @@
+#include "AssetCache.h"
+#include "BiquadDesign.h"
+
+namespace
+{
+    // 64 bit FNV-1a. Not cryptographic, only meant to tell files apart.
+    constexpr juce::uint64 FNV_OFFSET_BASIS = 14695981039346656037ull;
+    constexpr juce::uint64 FNV_PRIME = 1099511628211ull;
+
+    constexpr int HASH_CHUNK_SIZE = 1 << 20;
+
+    // Downsampling first low-passes below the new Nyquist frequency. Run
+    // forwards and backwards, the filter is twice as steep and has no phase
+    // shift or latency.
+    constexpr double ANTI_ALIAS_CUTOFF = 0.45;
+    constexpr int ANTI_ALIAS_ORDER = 16;
+
+    void FilterForwardsAndBackwards(float *samples, int numSamples, const BiquadCoefficients *sections, int numSections)
+    {
+        for (int direction : { 1, -1 })
+        {
+            for (int section = 0; section < numSections; ++section)
+            {
+                const auto &c = sections[section];
+                double s1 = 0.0, s2 = 0.0;
+                float *sample = direction > 0 ? samples : samples + numSamples - 1;
+                for (int i = 0; i < numSamples; ++i, sample += direction)
+                {
+                    const double x = *sample;
+                    const double y = c.b0 * x + s1;
+                    s1 = c.b1 * x - c.a1 * y + s2;
+                    s2 = c.b2 * x - c.a2 * y;
+                    *sample = (float)y;
+                }
+            }
+        }
+    }
+}
+
+std::unique_ptr<juce::PositionableAudioSource> AudioAsset::CreateSource() const
+{
+    // A mapped reader only copies out of the mapping, so sources on several
+    // threads can share it.
+    if (mMappedReader != nullptr)
+        return std::make_unique<juce::AudioFormatReaderSource>(mMappedReader.get(), false);
+
+    // A stream has a read position, so every source needs its own reader.
+    if (mStreamed)
+    {
+        if (auto reader = AssetCache::GetInstance().CreateReader(mFile))
+            return std::make_unique<juce::AudioFormatReaderSource>(reader.release(), true);
+        return nullptr;
+    }
+
+    // The source only reads the buffer it refers to.
+    return std::make_unique<juce::MemoryAudioSource>(const_cast<juce::AudioBuffer<float> &>(mBuffer), false);
+}
+
+AssetCache &AssetCache::GetInstance()
+{
+    static AssetCache instance;
+    return instance;
+}
+
+AssetCache::AssetCache()
+{
+    mFormatManager.registerBasicFormats();
+}
+
+std::shared_ptr<const AudioAsset> AssetCache::Load(const juce::File &file, const AssetOptions &options)
+{
+    const std::lock_guard<std::mutex> lock(mMutex);
+    RemoveExpired();
+
+    if (!file.existsAsFile())
+        return nullptr;
+
+    // Players keep reading the file itself, so their assets are tied to the
+    // version of the file at this path anyway, and hashing it would read all
+    // of it under the lock for nothing.
+    const auto fileKey = GetFileKey(file);
+    const juce::uint64 contentHash = options.memoryMapped ? 0 : GetContentHash(file, fileKey);
+    const auto source = options.memoryMapped ? fileKey : juce::String::toHexString((juce::int64)contentHash);
+    const auto key = source + "|" + juce::String(options.sampleRate) + "|" + juce::String(options.maxSeconds) + (options.memoryMapped ? "|mapped" : "");
+
+    if (auto asset = mAssets[key].lock())
+        return asset;
+
+    auto asset = Decode(file, options);
+    if (asset == nullptr)
+        return nullptr;
+
+    asset->mKey = key;
+    asset->mFile = file;
+    asset->mContentHash = contentHash;
+
+    mAssets[key] = asset;
+    return asset;
+}
+
+std::shared_ptr<const void> AssetCache::GetDerivedEntry(const juce::String &key, const std::function<std::shared_ptr<const void>()> &create)
+{
+    const std::lock_guard<std::mutex> lock(mMutex);
+    RemoveExpired();
+
+    if (auto data = mDerived[key].lock())
+        return data;
+
+    auto data = create();
+    mDerived[key] = data;
+    return data;
+}
+
+std::unique_ptr<juce::AudioFormatReader> AssetCache::CreateReader(const juce::File &file)
+{
+    const std::lock_guard<std::mutex> lock(mMutex);
+    return std::unique_ptr<juce::AudioFormatReader>(mFormatManager.createReaderFor(file));
+}
+
+juce::String AssetCache::GetFileKey(const juce::File &file)
+{
+    return file.getFullPathName() + "|" + juce::String(file.getSize()) + "|" + juce::String(file.getLastModificationTime().toMilliseconds());
+}
+
+juce::uint64 AssetCache::GetContentHash(const juce::File &file, const juce::String &fileKey)
+{
+    const auto known = mContentHashes.find(fileKey);
+    if (known != mContentHashes.end())
+        return known->second;
+
+    juce::uint64 hash = FNV_OFFSET_BASIS;
+    juce::FileInputStream stream(file);
+    if (stream.openedOk())
+    {
+        juce::HeapBlock<juce::uint8> chunk(HASH_CHUNK_SIZE);
+        for (int numRead; (numRead = stream.read(chunk, HASH_CHUNK_SIZE)) > 0;)
+        {
+            for (int i = 0; i < numRead; ++i)
+                hash = (hash ^ chunk[i]) * FNV_PRIME;
+        }
+    }
+
+    mContentHashes[fileKey] = hash;
+    return hash;
+}
+
+std::shared_ptr<AudioAsset> AssetCache::Decode(const juce::File &file, const AssetOptions &options)
+{
+    std::shared_ptr<AudioAsset> asset(new AudioAsset());
+
+    if (options.memoryMapped && options.maxSeconds <= 0.0)
+    {
+        if (auto *format = mFormatManager.findFormatForFileExtension(file.getFileExtension()))
+        {
+            std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format->createMemoryMappedReader(file));
+            if (mapped != nullptr && (options.sampleRate <= 0.0 || mapped->sampleRate == options.sampleRate) && mapped->mapEntireFile())
+            {
+                asset->mSampleRate = mapped->sampleRate;
+                asset->mNumChannels = (int)mapped->numChannels;
+                asset->mLength = mapped->lengthInSamples;
+                asset->mMappedReader = std::move(mapped);
+                return asset;
+            }
+        }
+    }
+
+    std::unique_ptr<juce::AudioFormatReader> reader(mFormatManager.createReaderFor(file));
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->numChannels == 0)
+        return nullptr;
+
+    const int numChannels = (int)reader->numChannels;
+
+    // Players stream what cannot be mapped, however long it is.
+    if (options.memoryMapped && options.maxSeconds <= 0.0 && (options.sampleRate <= 0.0 || reader->sampleRate == options.sampleRate))
+    {
+        asset->mSampleRate = reader->sampleRate;
+        asset->mNumChannels = numChannels;
+        asset->mLength = reader->lengthInSamples;
+        asset->mStreamed = true;
+        return asset;
+    }
+
+    juce::int64 fileLength = reader->lengthInSamples;
+    if (options.maxSeconds > 0.0)
+        fileLength = juce::jmin(fileLength, (juce::int64)(options.maxSeconds * reader->sampleRate));
+
+    // An AudioBuffer counts samples in an int. Rather than cut a file short
+    // without a word, a longer one fails to load.
+    const double resampledLength = options.sampleRate > 0.0 ? (double)fileLength * options.sampleRate / reader->sampleRate : 0.0;
+    if (fileLength > std::numeric_limits<int>::max() || resampledLength >= (double)std::numeric_limits<int>::max())
+        return nullptr;
+
+    const int length = (int)fileLength;
+
+    juce::AudioBuffer<float> decoded(numChannels, length);
+    reader->read(decoded.getArrayOfWritePointers(), numChannels, 0, length);
+
+    asset->mSampleRate = reader->sampleRate;
+
+    if (options.sampleRate > 0.0 && options.sampleRate != reader->sampleRate)
+    {
+        const double ratio = reader->sampleRate / options.sampleRate;
+
+        if (ratio > 1.0)
+        {
+            BiquadCoefficients sections[ANTI_ALIAS_ORDER / 2];
+            const int numSections = BiquadDesign::ButterworthLowPass(reader->sampleRate, ANTI_ALIAS_CUTOFF * options.sampleRate, ANTI_ALIAS_ORDER, sections);
+            for (int channel = 0; channel < numChannels; ++channel)
+                FilterForwardsAndBackwards(decoded.getWritePointer(channel), length, sections, numSections);
+        }
+
+        // The interpolator delays its output by its latency in input samples.
+        // Pre-rolling that many samples at unit speed fills its history, so
+        // output sample n lands on input position n * ratio; past the end of
+        // the input it reads zeros, which lets the last samples come out.
+        const int latency = juce::roundToInt(juce::WindowedSincInterpolator::getBaseLatency());
+        const int preRoll = juce::jmin(latency, length);
+        juce::HeapBlock<float> discarded((size_t)latency);
+
+        juce::AudioBuffer<float> resampled(numChannels, (int)std::ceil(length / ratio));
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            juce::WindowedSincInterpolator interpolator;
+            interpolator.process(1.0, decoded.getReadPointer(channel), discarded, latency, length, 0);
+            interpolator.process(ratio, decoded.getReadPointer(channel) + preRoll, resampled.getWritePointer(channel), resampled.getNumSamples(), length - preRoll, 0);
+        }
+        decoded = std::move(resampled);
+        asset->mSampleRate = options.sampleRate;
+    }
+
+    asset->mNumChannels = numChannels;
+    asset->mLength = decoded.getNumSamples();
+    asset->mBuffer = std::move(decoded);
+    return asset;
+}
+
+void AssetCache::RemoveExpired()
+{
+    for (auto it = mAssets.begin(); it != mAssets.end();)
+        it = it->second.expired() ? mAssets.erase(it) : std::next(it);
+
+    for (auto it = mDerived.begin(); it != mDerived.end();)
+        it = it->second.expired() ? mDerived.erase(it) : std::next(it);
+}
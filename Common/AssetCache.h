@@ -0,0 +1,120 @@
+#pragma once
+#include <JuceHeader.h>
+
+// How an asset is prepared. Requests for the same file with equal options
+// share one asset.
+struct AssetOptions
+{
+    // Resampled to this rate; 0 keeps the rate of the file.
+    double sampleRate = 0.0;
+
+    // Longer files are cut; 0 keeps all of it.
+    double maxSeconds = 0.0;
+
+    // For players that only read through CreateSource(). Uncompressed files
+    // at the requested rate are mapped into memory instead of decoded, so
+    // their pages are shared by the OS and only the parts that are played get
+    // read. Other files at the requested rate are streamed from disk, so a
+    // long compressed file costs neither a decode nor the memory for it.
+    bool memoryMapped = false;
+};
+
+// Audio loaded from a file, immutable once created.
+class AudioAsset
+{
+public:
+    const juce::File &GetFile() const { return mFile; }
+    // 0 for assets loaded for players, which are keyed by the file's path,
+    // size and modification time instead.
+    juce::uint64 GetContentHash() const { return mContentHash; }
+    double GetSampleRate() const { return mSampleRate; }
+    int GetNumChannels() const { return mNumChannels; }
+    juce::int64 GetLength() const { return mLength; }
+
+    bool IsMemoryMapped() const { return mMappedReader != nullptr; }
+    bool IsStreamed() const { return mStreamed; }
+
+    // The decoded samples; empty when the asset is memory mapped or streamed.
+    const juce::AudioBuffer<float> &GetBuffer() const { return mBuffer; }
+
+    // A new source playing the asset from the start, for streaming players.
+    // It reads the shared data, so the asset has to outlive it. A streamed
+    // asset opens a reader of its own for every source; nullptr if the file
+    // has gone since.
+    std::unique_ptr<juce::PositionableAudioSource> CreateSource() const;
+
+private:
+    friend class AssetCache;
+
+    AudioAsset() = default;
+
+    juce::String mKey;
+    juce::File mFile;
+    juce::uint64 mContentHash = 0;
+    double mSampleRate = 0.0;
+    int mNumChannels = 0;
+    juce::int64 mLength = 0;
+
+    juce::AudioBuffer<float> mBuffer;
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mMappedReader;
+    bool mStreamed = false;
+
+    JUCE_DECLARE_NON_COPYABLE(AudioAsset)
+};
+
+// Process wide cache of audio assets, keyed by content hash and options, so
+// any number of plugin instances loading the same file share one copy in
+// memory and every load after the first returns at once. Assets for players
+// (AssetOptions::memoryMapped) are keyed by the file's path, size and
+// modification time, without reading it.
+//
+// The cache only holds weak references: an asset lives as long as some
+// instance uses it. Data computed from an asset, like the partition spectra
+// of an impulse response, is cached the same way under the asset's key.
+//
+// Loads are meant for the message thread or a loader thread, never the audio
+// callback. They are serialised, which is what lets a second instance wait
+// for the first one's decode instead of decoding the file again.
+class AssetCache
+{
+public:
+    static AssetCache &GetInstance();
+
+    // nullptr when the file cannot be read, or is too long to decode into one
+    // buffer, more than INT_MAX samples per channel.
+    std::shared_ptr<const AudioAsset> Load(const juce::File &file, const AssetOptions &options = {});
+
+    // Data derived from an asset, created by create() on first use. kind
+    // names what is derived, and has to include whatever parameters the
+    // result depends on. create() runs under the cache lock, so it must not
+    // load anything through the cache itself.
+    template <typename Data>
+    std::shared_ptr<const Data> GetDerived(const AudioAsset &asset, const juce::String &kind, const std::function<std::shared_ptr<const Data>(const AudioAsset &)> &create)
+    {
+        return std::static_pointer_cast<const Data>(GetDerivedEntry(asset.mKey + "|" + kind, [&]
+                                                                    { return std::shared_ptr<const void>(create(asset)); }));
+    }
+
+private:
+    friend class AudioAsset;
+
+    AssetCache();
+
+    std::unique_ptr<juce::AudioFormatReader> CreateReader(const juce::File &file);
+    std::shared_ptr<const void> GetDerivedEntry(const juce::String &key, const std::function<std::shared_ptr<const void>()> &create);
+    juce::String GetFileKey(const juce::File &file);
+    juce::uint64 GetContentHash(const juce::File &file, const juce::String &fileKey);
+    std::shared_ptr<AudioAsset> Decode(const juce::File &file, const AssetOptions &options);
+    void RemoveExpired();
+
+    std::mutex mMutex;
+    juce::AudioFormatManager mFormatManager;
+
+    // Hashing reads the whole file, so it is done once per version of a file,
+    // which GetFileKey() tells apart by path, size and modification time.
+    std::map<juce::String, juce::uint64> mContentHashes;
+    std::map<juce::String, std::weak_ptr<const AudioAsset>> mAssets;
+    std::map<juce::String, std::weak_ptr<const void>> mDerived;
+
+    JUCE_DECLARE_NON_COPYABLE(AssetCache)
+};
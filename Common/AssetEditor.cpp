@@ -0,0 +1,52 @@
+#include "AssetEditor.h"
+
+AssetEditor::AssetEditor(juce::AudioProcessor &processor, Asset asset)
+    : AudioProcessorEditor(&processor),
+      mAsset(std::move(asset)),
+      mParameterEditor(processor)
+{
+    addAndMakeVisible(&mParameterEditor);
+
+    addAndMakeVisible(&mLoadButton);
+    mLoadButton.setButtonText(mAsset.buttonText);
+    mLoadButton.onClick = [this]
+    {
+        mChooser = std::make_unique<juce::FileChooser>(mAsset.buttonText, mAsset.getFile(), mAsset.filePatterns);
+        auto chooseFlags = juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles;
+        mChooser->launchAsync(chooseFlags, [this](const juce::FileChooser &fc)
+                              {
+            auto file = fc.getResult();
+            if (file != juce::File{} && !mAsset.load(file))
+                mFileLabel.setText("Could not read " + file.getFileName(), juce::dontSendNotification);
+            else
+                UpdateLabel(); });
+    };
+
+    addAndMakeVisible(&mFileLabel);
+    UpdateLabel();
+
+    setSize(mParameterEditor.getWidth(), mParameterEditor.getHeight() + ELEMENT_SIZE + INTERVAL * 2);
+}
+
+void AssetEditor::paint(juce::Graphics &g)
+{
+    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+}
+
+void AssetEditor::resized()
+{
+    auto bounds = getLocalBounds();
+
+    auto row = bounds.removeFromBottom(ELEMENT_SIZE + INTERVAL * 2).reduced(INTERVAL);
+    mLoadButton.setBounds(row.removeFromLeft(BUTTON_WIDTH));
+    row.removeFromLeft(INTERVAL);
+    mFileLabel.setBounds(row);
+
+    mParameterEditor.setBounds(bounds);
+}
+
+void AssetEditor::UpdateLabel()
+{
+    const auto file = mAsset.getFile();
+    mFileLabel.setText(file == juce::File() ? "Nothing loaded" : file.getFileName(), juce::dontSendNotification);
+}
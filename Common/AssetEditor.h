@@ -0,0 +1,38 @@
+#pragma once
+#include <JuceHeader.h>
+
+// The generic parameter editor with a row below it for loading the file a
+// processor plays or convolves with, and showing which one is loaded.
+class AssetEditor : public juce::AudioProcessorEditor
+{
+public:
+    struct Asset
+    {
+        juce::String buttonText;
+        juce::String filePatterns;
+        std::function<bool(const juce::File &)> load;
+        std::function<juce::File()> getFile;
+    };
+
+    AssetEditor(juce::AudioProcessor &processor, Asset asset);
+
+    void paint(juce::Graphics &g) override;
+    void resized() override;
+
+private:
+    void UpdateLabel();
+
+    static constexpr int INTERVAL = 10;
+    static constexpr int ELEMENT_SIZE = 30;
+    static constexpr int BUTTON_WIDTH = 120;
+
+    const Asset mAsset;
+
+    juce::GenericAudioProcessorEditor mParameterEditor;
+    juce::TextButton mLoadButton;
+    juce::Label mFileLabel;
+
+    std::unique_ptr<juce::FileChooser> mChooser;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AssetEditor)
+};
@@ -0,0 +1,102 @@
+#include "BiquadCascade.h"
+#include "ChannelLanes.h"
+
+void BiquadCascade::Prepare(int numChannels, int numSections, int maxBlockSize)
+{
+    mNumChannels = juce::jmax(1, numChannels);
+    mNumGroups = (mNumChannels + mSIMDSize - 1) / mSIMDSize;
+    mNumSections = juce::jmax(1, numSections);
+    mMaxBlockSize = juce::jmax(1, maxBlockSize);
+
+    mCoefficients.calloc((size_t)mNumSections);
+    mEnabled.calloc((size_t)mNumSections);
+    for (int section = 0; section < mNumSections; ++section)
+    {
+        mCoefficients[section] = BiquadCoefficients();
+        mEnabled[section] = true;
+    }
+
+    const int stateSize = mNumGroups * mNumSections * 2 * mSIMDSize;
+    mMemory.calloc((size_t)(stateSize + mMaxBlockSize * mSIMDSize + mSIMDSize));
+    mState = SIMDFloat::getNextSIMDAlignedPtr(mMemory.get());
+    mScratch = mState + stateSize;
+}
+
+void BiquadCascade::Reset()
+{
+    juce::FloatVectorOperations::clear(mState, mNumGroups * mNumSections * 2 * mSIMDSize);
+}
+
+void BiquadCascade::SetSection(int section, const BiquadCoefficients &coefficients)
+{
+    jassert(section >= 0 && section < mNumSections);
+    mCoefficients[section] = coefficients;
+}
+
+void BiquadCascade::SetSectionEnabled(int section, bool enabled)
+{
+    jassert(section >= 0 && section < mNumSections);
+
+    if (enabled && !mEnabled[section])
+        ClearState(section);
+
+    mEnabled[section] = enabled;
+}
+
+void BiquadCascade::ClearState(int section)
+{
+    for (int group = 0; group < mNumGroups; ++group)
+        juce::FloatVectorOperations::clear(GetState(group, section), 2 * mSIMDSize);
+}
+
+void BiquadCascade::Process(const juce::dsp::AudioBlock<float> &block)
+{
+    const int numChannels = juce::jmin((int)block.getNumChannels(), (int)mNumChannels);
+    const int numSamples = (int)block.getNumSamples();
+
+    for (int offset = 0; offset < numSamples; offset += mMaxBlockSize)
+    {
+        const int chunkSamples = juce::jmin((int)mMaxBlockSize, numSamples - offset);
+
+        for (int group = 0; group < mNumGroups; ++group)
+        {
+            const int firstChannel = group * mSIMDSize;
+            const int groupChannels = juce::jmin((int)mSIMDSize, numChannels - firstChannel);
+            if (groupChannels <= 0)
+                break;
+
+            ChannelLanes::Interleave(block, firstChannel, groupChannels, offset, chunkSamples, mScratch, mSIMDSize);
+
+            for (int section = 0; section < mNumSections; ++section)
+                if (mEnabled[section])
+                    ProcessSection(mCoefficients[section], GetState(group, section), chunkSamples);
+
+            ChannelLanes::Deinterleave(mScratch, mSIMDSize, block, firstChannel, groupChannels, offset, chunkSamples);
+        }
+    }
+}
+
+void BiquadCascade::ProcessSection(const BiquadCoefficients &coefficients, float *state, int numSamples)
+{
+    const auto b0 = SIMDFloat::expand(coefficients.b0);
+    const auto b1 = SIMDFloat::expand(coefficients.b1);
+    const auto b2 = SIMDFloat::expand(coefficients.b2);
+    const auto a1 = SIMDFloat::expand(coefficients.a1);
+    const auto a2 = SIMDFloat::expand(coefficients.a2);
+
+    auto s1 = SIMDFloat::fromRawArray(state);
+    auto s2 = SIMDFloat::fromRawArray(state + mSIMDSize);
+
+    float *data = mScratch;
+    for (int i = 0; i < numSamples; ++i, data += mSIMDSize)
+    {
+        const auto input = SIMDFloat::fromRawArray(data);
+        const auto output = b0 * input + s1;
+        s1 = b1 * input - a1 * output + s2;
+        s2 = b2 * input - a2 * output;
+        output.copyToRawArray(data);
+    }
+
+    s1.copyToRawArray(state);
+    s2.copyToRawArray(state + mSIMDSize);
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <JuceHeader.h>
+#include "BiquadDesign.h"
+
+// Cascade of biquad sections run on several channels at once, for the EQs.
+//
+// Channels are processed in groups of one SIMD register, one channel per lane
+// (two to eight channels depending on the instruction set). A block is
+// interleaved into lane order once, every section then runs over the whole
+// block with its coefficients and transposed direct form II state held in
+// registers, and the result is written back. All channels share the
+// coefficients. The state is kept structure-of-arrays: one register of s1 and
+// one of s2 per section and group.
+//
+// Sections live in fixed slots that can be disabled, like bypassing a stage of
+// a ProcessorChain, so switching a slope keeps the state of the other filters.
+// A section evaluates the same expressions as juce::dsp::IIR::Filter, so the
+// output matches such a chain within float rounding; it is not bit for bit,
+// since the vector code may contract and order the multiply-adds differently.
+class BiquadCascade
+{
+public:
+    BiquadCascade() = default;
+
+    // Channels processed together in one group.
+    static constexpr int GetChannelsPerGroup() { return (int)juce::dsp::SIMDRegister<float>::SIMDNumElements; }
+
+    void Prepare(int numChannels, int numSections, int maxBlockSize);
+    void Reset();
+
+    int GetNumChannels() const { return mNumChannels; }
+    int GetNumSections() const { return mNumSections; }
+
+    // Writing coefficients is allocation free and takes effect on the next block.
+    void SetSection(int section, const BiquadCoefficients &coefficients);
+
+    // A disabled section passes its input through. Enabling it again starts it from silence.
+    void SetSectionEnabled(int section, bool enabled);
+    bool IsSectionEnabled(int section) const { return mEnabled[section]; }
+
+    // Filters the first GetNumChannels() channels of the block in place.
+    void Process(const juce::dsp::AudioBlock<float> &block);
+
+private:
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int mSIMDSize = (int)SIMDFloat::SIMDNumElements;
+
+    float *GetState(int group, int section) { return mState + (group * mNumSections + section) * 2 * mSIMDSize; }
+
+    void ProcessSection(const BiquadCoefficients &coefficients, float *state, int numSamples);
+    void ClearState(int section);
+
+    juce::HeapBlock<BiquadCoefficients> mCoefficients;
+    juce::HeapBlock<bool> mEnabled;
+    int32_t mNumChannels = 0;
+    int32_t mNumGroups = 0;
+    int32_t mNumSections = 0;
+    int32_t mMaxBlockSize = 0;
+
+    // SIMD aligned state and lane interleaved scratch, sized in Prepare().
+    juce::HeapBlock<float> mMemory;
+    float *mState = nullptr;
+    float *mScratch = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BiquadCascade)
+};
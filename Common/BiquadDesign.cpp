@@ -0,0 +1,144 @@
+#include "BiquadDesign.h"
+
+namespace
+{
+    constexpr double pi = juce::MathConstants<double>::pi;
+
+    BiquadCoefficients Normalise(double b0, double b1, double b2, double a0, double a1, double a2)
+    {
+        const double a0Inverse = a0 != 0.0 ? 1.0 / a0 : 0.0;
+
+        BiquadCoefficients section;
+        section.b0 = (float)(b0 * a0Inverse);
+        section.b1 = (float)(b1 * a0Inverse);
+        section.b2 = (float)(b2 * a0Inverse);
+        section.a1 = (float)(a1 * a0Inverse);
+        section.a2 = (float)(a2 * a0Inverse);
+        return section;
+    }
+
+    // Q of section i of an even order Butterworth filter.
+    double ButterworthQ(int section, int order)
+    {
+        return 1.0 / (2.0 * std::cos((2.0 * section + 1.0) * pi / (order * 2.0)));
+    }
+}
+
+BiquadCoefficients BiquadDesign::LowPass(double sampleRate, double frequency, double q)
+{
+    jassert(sampleRate > 0.0 && q > 0.0);
+    jassert(frequency > 0.0 && frequency <= sampleRate * 0.5);
+
+    const double n = 1.0 / std::tan(pi * frequency / sampleRate);
+    const double nSquared = n * n;
+    const double invQ = 1.0 / q;
+    const double c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    return Normalise(c1, c1 * 2.0, c1, 1.0, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - invQ * n + nSquared));
+}
+
+BiquadCoefficients BiquadDesign::HighPass(double sampleRate, double frequency, double q)
+{
+    jassert(sampleRate > 0.0 && q > 0.0);
+    jassert(frequency > 0.0 && frequency <= sampleRate * 0.5);
+
+    const double n = std::tan(pi * frequency / sampleRate);
+    const double nSquared = n * n;
+    const double invQ = 1.0 / q;
+    const double c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    return Normalise(c1, c1 * -2.0, c1, 1.0, c1 * 2.0 * (nSquared - 1.0), c1 * (1.0 - invQ * n + nSquared));
+}
+
+BiquadCoefficients BiquadDesign::Peak(double sampleRate, double frequency, double q, double gainFactor)
+{
+    jassert(sampleRate > 0.0 && q > 0.0);
+    jassert(frequency > 0.0 && frequency <= sampleRate * 0.5);
+
+    // Same -300 dB floor as Decibels::gainWithLowerBound in JUCE.
+    const double a = std::sqrt(juce::jmax(1.0e-15, gainFactor));
+    const double omega = (2.0 * pi * juce::jmax(frequency, 2.0)) / sampleRate;
+    const double alpha = std::sin(omega) / (q * 2.0);
+    const double c2 = -2.0 * std::cos(omega);
+    const double alphaTimesA = alpha * a;
+    const double alphaOverA = alpha / a;
+
+    return Normalise(1.0 + alphaTimesA, c2, 1.0 - alphaTimesA, 1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+}
+
+BiquadCoefficients BiquadDesign::FirstOrderLowPass(double sampleRate, double frequency)
+{
+    jassert(sampleRate > 0.0);
+    jassert(frequency > 0.0 && frequency <= sampleRate * 0.5);
+
+    const double n = std::tan(pi * frequency / sampleRate);
+
+    BiquadCoefficients section = Normalise(n, n, 0.0, n + 1.0, n - 1.0, 0.0);
+    section.order = 1;
+    return section;
+}
+
+BiquadCoefficients BiquadDesign::FirstOrderHighPass(double sampleRate, double frequency)
+{
+    jassert(sampleRate > 0.0);
+    jassert(frequency > 0.0 && frequency <= sampleRate * 0.5);
+
+    const double n = std::tan(pi * frequency / sampleRate);
+
+    BiquadCoefficients section = Normalise(1.0, -1.0, 0.0, n + 1.0, n - 1.0, 0.0);
+    section.order = 1;
+    return section;
+}
+
+int BiquadDesign::ButterworthLowPass(double sampleRate, double frequency, int order, BiquadCoefficients *sections)
+{
+    jassert(order > 0 && order % 2 == 0);
+
+    for (int i = 0; i < order / 2; ++i)
+        sections[i] = LowPass(sampleRate, frequency, ButterworthQ(i, order));
+
+    return order / 2;
+}
+
+int BiquadDesign::ButterworthHighPass(double sampleRate, double frequency, int order, BiquadCoefficients *sections)
+{
+    jassert(order > 0 && order % 2 == 0);
+
+    for (int i = 0; i < order / 2; ++i)
+        sections[i] = HighPass(sampleRate, frequency, ButterworthQ(i, order));
+
+    return order / 2;
+}
+
+juce::dsp::IIR::Coefficients<float>::Ptr BiquadDesign::CreateStorage(int order)
+{
+    jassert(order == 1 || order == 2);
+
+    // Pass-through sections of the requested order.
+    if (order == 1)
+        return new juce::dsp::IIR::Coefficients<float>(1.0f, 0.0f, 1.0f, 0.0f);
+
+    return new juce::dsp::IIR::Coefficients<float>(1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+}
+
+void BiquadDesign::Apply(const BiquadCoefficients &section, juce::dsp::IIR::Coefficients<float> &storage)
+{
+    jassert((int)storage.getFilterOrder() == section.order);
+
+    // The storage keeps b0..bN followed by a1..aN, with a0 normalised away.
+    float *raw = storage.getRawCoefficients();
+    if (section.order == 1)
+    {
+        raw[0] = section.b0;
+        raw[1] = section.b1;
+        raw[2] = section.a1;
+    }
+    else
+    {
+        raw[0] = section.b0;
+        raw[1] = section.b1;
+        raw[2] = section.b2;
+        raw[3] = section.a1;
+        raw[4] = section.a2;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Normalised IIR coefficients of one first or second order section:
+// y = b0 x + b1 x[-1] + b2 x[-2] - a1 y[-1] - a2 y[-2].
+// First order sections leave b2 and a2 at zero.
+struct BiquadCoefficients
+{
+    float b0 = 1.0f;
+    float b1 = 0.0f;
+    float b2 = 0.0f;
+    float a1 = 0.0f;
+    float a2 = 0.0f;
+    int order = 2;
+
+    bool operator==(const BiquadCoefficients &other) const
+    {
+        return b0 == other.b0 && b1 == other.b1 && b2 == other.b2 && a1 == other.a1 && a2 == other.a2 && order == other.order;
+    }
+    bool operator!=(const BiquadCoefficients &other) const { return !(*this == other); }
+};
+
+// Allocation free versions of the juce::dsp::IIR::Coefficients and FilterDesign
+// factories used by the effects, with the same formulas, so they can run on the
+// audio thread. Results are written into coefficient storage that was created
+// once with the matching order, instead of making a new Coefficients object.
+namespace BiquadDesign
+{
+    BiquadCoefficients LowPass(double sampleRate, double frequency, double q = 1.0 / juce::MathConstants<double>::sqrt2);
+    BiquadCoefficients HighPass(double sampleRate, double frequency, double q = 1.0 / juce::MathConstants<double>::sqrt2);
+    BiquadCoefficients Peak(double sampleRate, double frequency, double q, double gainFactor);
+    BiquadCoefficients FirstOrderLowPass(double sampleRate, double frequency);
+    BiquadCoefficients FirstOrderHighPass(double sampleRate, double frequency);
+
+    // Even order Butterworth filters as order / 2 second order sections, like
+    // FilterDesign::designIIR...HighOrderButterworthMethod. Returns the number of
+    // sections written to sections.
+    int ButterworthLowPass(double sampleRate, double frequency, int order, BiquadCoefficients *sections);
+    int ButterworthHighPass(double sampleRate, double frequency, int order, BiquadCoefficients *sections);
+
+    // Storage that Apply() can later write into without allocating.
+    juce::dsp::IIR::Coefficients<float>::Ptr CreateStorage(int order);
+
+    // Copies the section into storage of the same order, in place.
+    void Apply(const BiquadCoefficients &section, juce::dsp::IIR::Coefficients<float> &storage);
+}
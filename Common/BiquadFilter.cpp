@@ -0,0 +1,157 @@
+#include "BiquadFilter.h"
+#include "ChannelLanes.h"
+
+void BiquadFilter::Prepare(double sampleRate, int numChannels, int maxBlockSize)
+{
+    mSampleRate = sampleRate;
+    mNumChannels = juce::jmax(1, numChannels);
+    mNumGroups = (mNumChannels + mSIMDSize - 1) / mSIMDSize;
+    mMaxBlockSize = juce::jmax(1, maxBlockSize);
+
+    const int stateSize = mNumGroups * 2 * mSIMDSize;
+    mMemory.calloc((size_t)(stateSize + mMaxBlockSize * mSIMDSize + mSIMDSize));
+    mState = SIMDFloat::getNextSIMDAlignedPtr(mMemory.get());
+    mScratch = mState + stateSize;
+
+    // Designs depend on the sample rate, so the next SetParameters() starts over.
+    mDesigned = false;
+    Reset();
+}
+
+void BiquadFilter::Reset()
+{
+    juce::FloatVectorOperations::clear(mState, mNumGroups * 2 * mSIMDSize);
+    mCurrent = mTarget;
+}
+
+void BiquadFilter::SetParameters(Type type, float frequency, float q)
+{
+    if (mDesigned && type == mType && frequency == mFrequency && q == mQ)
+        return;
+
+    mType = type;
+    mFrequency = frequency;
+    mQ = q;
+
+    const double cutoff = juce::jlimit(1.0, mSampleRate * 0.49, (double)frequency);
+    switch (type)
+    {
+    case LOW_PASS:
+        mTarget = BiquadDesign::LowPass(mSampleRate, cutoff, q);
+        break;
+    case HIGH_PASS:
+        mTarget = BiquadDesign::HighPass(mSampleRate, cutoff, q);
+        break;
+    case FIRST_ORDER_LOW_PASS:
+        mTarget = BiquadDesign::FirstOrderLowPass(mSampleRate, cutoff);
+        break;
+    case FIRST_ORDER_HIGH_PASS:
+        mTarget = BiquadDesign::FirstOrderHighPass(mSampleRate, cutoff);
+        break;
+    }
+
+    // There is nothing to move from before the first design.
+    if (!mDesigned || !mInterpolate)
+        mCurrent = mTarget;
+
+    mDesigned = true;
+}
+
+void BiquadFilter::Process(const juce::dsp::AudioBlock<float> &block)
+{
+    const int numChannels = juce::jmin((int)block.getNumChannels(), (int)mNumChannels);
+    const int numSamples = (int)block.getNumSamples();
+    jassert((int)block.getNumChannels() <= mNumChannels);
+
+    if (numSamples == 0)
+        return;
+
+    const bool interpolate = mCurrent != mTarget;
+
+    BiquadCoefficients step;
+    if (interpolate)
+    {
+        const float scale = 1.0f / (float)numSamples;
+        step.b0 = (mTarget.b0 - mCurrent.b0) * scale;
+        step.b1 = (mTarget.b1 - mCurrent.b1) * scale;
+        step.b2 = (mTarget.b2 - mCurrent.b2) * scale;
+        step.a1 = (mTarget.a1 - mCurrent.a1) * scale;
+        step.a2 = (mTarget.a2 - mCurrent.a2) * scale;
+    }
+
+    for (int offset = 0; offset < numSamples; offset += mMaxBlockSize)
+    {
+        const int chunkSamples = juce::jmin((int)mMaxBlockSize, numSamples - offset);
+
+        // Coefficients reached at the start of this chunk.
+        BiquadCoefficients start = mTarget;
+        if (interpolate)
+        {
+            start.b0 = mCurrent.b0 + step.b0 * (float)offset;
+            start.b1 = mCurrent.b1 + step.b1 * (float)offset;
+            start.b2 = mCurrent.b2 + step.b2 * (float)offset;
+            start.a1 = mCurrent.a1 + step.a1 * (float)offset;
+            start.a2 = mCurrent.a2 + step.a2 * (float)offset;
+        }
+
+        for (int group = 0; group < mNumGroups; ++group)
+        {
+            const int firstChannel = group * mSIMDSize;
+            const int groupChannels = juce::jmin((int)mSIMDSize, numChannels - firstChannel);
+            if (groupChannels <= 0)
+                break;
+
+            ChannelLanes::Interleave(block, firstChannel, groupChannels, offset, chunkSamples, mScratch, mSIMDSize);
+
+            float *state = mState + group * 2 * mSIMDSize;
+            if (interpolate)
+                ProcessGroup<true>(state, start, step, chunkSamples);
+            else
+                ProcessGroup<false>(state, start, step, chunkSamples);
+
+            ChannelLanes::Deinterleave(mScratch, mSIMDSize, block, firstChannel, groupChannels, offset, chunkSamples);
+        }
+    }
+
+    mCurrent = mTarget;
+}
+
+template <bool interpolate>
+void BiquadFilter::ProcessGroup(float *state, const BiquadCoefficients &start, const BiquadCoefficients &step, int numSamples)
+{
+    auto b0 = SIMDFloat::expand(start.b0);
+    auto b1 = SIMDFloat::expand(start.b1);
+    auto b2 = SIMDFloat::expand(start.b2);
+    auto a1 = SIMDFloat::expand(start.a1);
+    auto a2 = SIMDFloat::expand(start.a2);
+    const auto stepB0 = SIMDFloat::expand(step.b0);
+    const auto stepB1 = SIMDFloat::expand(step.b1);
+    const auto stepB2 = SIMDFloat::expand(step.b2);
+    const auto stepA1 = SIMDFloat::expand(step.a1);
+    const auto stepA2 = SIMDFloat::expand(step.a2);
+
+    auto s1 = SIMDFloat::fromRawArray(state);
+    auto s2 = SIMDFloat::fromRawArray(state + mSIMDSize);
+
+    float *data = mScratch;
+    for (int i = 0; i < numSamples; ++i, data += mSIMDSize)
+    {
+        if constexpr (interpolate)
+        {
+            b0 = b0 + stepB0;
+            b1 = b1 + stepB1;
+            b2 = b2 + stepB2;
+            a1 = a1 + stepA1;
+            a2 = a2 + stepA2;
+        }
+
+        const auto input = SIMDFloat::fromRawArray(data);
+        const auto output = b0 * input + s1;
+        s1 = b1 * input - a1 * output + s2;
+        s2 = b2 * input - a2 * output;
+        output.copyToRawArray(data);
+    }
+
+    s1.copyToRawArray(state);
+    s2.copyToRawArray(state + mSIMDSize);
+}
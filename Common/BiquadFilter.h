@@ -0,0 +1,73 @@
+#pragma once
+#include <JuceHeader.h>
+#include "BiquadDesign.h"
+
+// Multichannel biquad with its own transposed direct form II state, for the
+// effects that run a single automated filter per channel. Channels run in
+// groups of one SIMD register, one channel per lane, like BiquadCascade.
+//
+// SetParameters() only redesigns when the type, frequency or Q differ from the
+// last call and keeps the result in plain members, so it is cheap enough to
+// call every block on the audio thread. With interpolation enabled a redesign
+// does not jump at the block boundary: the next Process() moves every
+// coefficient linearly from the previous design to the new one, reaching it on
+// the last sample. Every section along the way is stable on its own, as the
+// stable region of (a1, a2) is a triangle, but a transposed direct form II
+// with moving coefficients has no such guarantee: the ramp smooths parameter
+// changes and is not meant for audio rate modulation.
+class BiquadFilter
+{
+public:
+    enum Type
+    {
+        LOW_PASS = 0,
+        HIGH_PASS,
+        FIRST_ORDER_LOW_PASS,
+        FIRST_ORDER_HIGH_PASS
+    };
+
+    BiquadFilter() = default;
+
+    void Prepare(double sampleRate, int numChannels, int maxBlockSize);
+    void Reset();
+
+    void SetInterpolation(bool shouldInterpolate) { mInterpolate = shouldInterpolate; }
+    bool IsInterpolating() const { return mInterpolate; }
+
+    // The frequency is kept below Nyquist, q is ignored by the first order types.
+    void SetParameters(Type type, float frequency, float q = 1.0f / juce::MathConstants<float>::sqrt2);
+
+    const BiquadCoefficients &GetCoefficients() const { return mTarget; }
+
+    // Filters every channel of the block in place, up to the prepared channel count.
+    void Process(const juce::dsp::AudioBlock<float> &block);
+
+private:
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int mSIMDSize = (int)SIMDFloat::SIMDNumElements;
+
+    template <bool interpolate>
+    void ProcessGroup(float *state, const BiquadCoefficients &start, const BiquadCoefficients &step, int numSamples);
+
+    int32_t mNumChannels = 0;
+    int32_t mNumGroups = 0;
+    int32_t mMaxBlockSize = 0;
+    double mSampleRate = 44100.0;
+
+    // SIMD aligned state, s1 and s2 registers per group, and lane interleaved scratch.
+    juce::HeapBlock<float> mMemory;
+    float *mState = nullptr;
+    float *mScratch = nullptr;
+
+    // Section used at the start of the next block and the one to reach by its end.
+    BiquadCoefficients mCurrent;
+    BiquadCoefficients mTarget;
+
+    Type mType = LOW_PASS;
+    float mFrequency = 0.0f;
+    float mQ = 0.0f;
+    bool mDesigned = false;
+    bool mInterpolate = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BiquadFilter)
+};
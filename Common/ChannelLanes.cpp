@@ -0,0 +1,28 @@
+#include "ChannelLanes.h"
+
+void ChannelLanes::Interleave(const juce::dsp::AudioBlock<float> &block, int firstChannel, int numChannels,
+                              int startSample, int numSamples, float *dest, int numLanes)
+{
+    jassert(numChannels <= numLanes);
+
+    if (numChannels < numLanes)
+        juce::FloatVectorOperations::clear(dest, numSamples * numLanes);
+
+    for (int lane = 0; lane < numChannels; ++lane)
+    {
+        const float *source = block.getChannelPointer((size_t)(firstChannel + lane)) + startSample;
+        for (int i = 0; i < numSamples; ++i)
+            dest[i * numLanes + lane] = source[i];
+    }
+}
+
+void ChannelLanes::Deinterleave(const float *source, int numLanes, const juce::dsp::AudioBlock<float> &block,
+                                int firstChannel, int numChannels, int startSample, int numSamples)
+{
+    for (int lane = 0; lane < numChannels; ++lane)
+    {
+        float *dest = block.getChannelPointer((size_t)(firstChannel + lane)) + startSample;
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = source[i * numLanes + lane];
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Moves a group of channels in and out of lane order, sample n of lane l at
+// n * numLanes + l, so filters can run one channel per SIMD lane. Lanes past
+// the last channel of the group are filled with silence.
+namespace ChannelLanes
+{
+    void Interleave(const juce::dsp::AudioBlock<float> &block, int firstChannel, int numChannels,
+                    int startSample, int numSamples, float *dest, int numLanes);
+
+    void Deinterleave(const float *source, int numLanes, const juce::dsp::AudioBlock<float> &block,
+                      int firstChannel, int numChannels, int startSample, int numSamples);
+}
@@ -0,0 +1,149 @@
+#include "DelayLine.h"
+
+void DelayLine::Prepare(int numChannels, int maxDelaySamples, int maxBlockSize, int maxVoices)
+{
+    jassert(maxVoices <= GetMaxVoices());
+
+    mNumChannels = juce::jmax(1, numChannels);
+    mMaxBlockSize = juce::jmax(1, maxBlockSize);
+    mMaxVoices = juce::jlimit(1, GetMaxVoices(), maxVoices);
+
+    // A whole block may be written before it is read back, so the ring has to
+    // hold the longest delay plus one block plus the interpolation taps.
+    mSize = juce::nextPowerOfTwo(juce::jmax(1, maxDelaySamples) + mMaxBlockSize + mTrailingGuard + 1);
+    mMask = mSize - 1;
+
+    mBuffer.setSize(mNumChannels, mLeadingGuard + mSize + mTrailingGuard);
+
+    // Multi-voice reads keep a whole register of taps per sample.
+    const int32_t maxTaps = mMaxVoices > 1 ? mMaxBlockSize * mSIMDSize : mMaxBlockSize;
+    mScratchStride = (maxTaps + 2 * mSIMDSize - 1) / mSIMDSize * mSIMDSize;
+    mScratchMemory.calloc((size_t)(5 * mScratchStride + mSIMDSize));
+    mReadIndices.calloc((size_t)maxTaps);
+
+    float *scratch = SIMDFloat::getNextSIMDAlignedPtr(mScratchMemory.get());
+    mFractions = scratch;
+    for (int32_t tap = 0; tap < 4; ++tap)
+        mTaps[tap] = scratch + (tap + 1) * mScratchStride;
+
+    Reset();
+}
+
+void DelayLine::Reset()
+{
+    mBuffer.clear();
+    mWritePosition = 0;
+}
+
+int DelayLine::GetChunkSize(float minDelaySamples, int numSamples) const
+{
+    // A cubic read reaches two samples past its integer position, so a chunk
+    // stays behind the write head as long as it is shorter than delay - 2.
+    const int32_t safeSamples = (int32_t)minDelaySamples - 2;
+    return juce::jlimit(1, juce::jmin(numSamples, (int)mMaxBlockSize), safeSamples);
+}
+
+int32_t DelayLine::SplitDelay(float delaySamples, float &fraction)
+{
+    // Split every read position into an integer index and a fraction without
+    // going through a large float position, which would lose precision on long
+    // buffers: position = write + n - delay = (write + n - ceil(delay)) + (ceil(delay) - delay).
+    const float delay = juce::jmax(0.0f, delaySamples);
+    int32_t whole = (int32_t)delay;
+    whole += (float)whole < delay ? 1 : 0;
+
+    fraction = (float)whole - delay;
+    return whole;
+}
+
+void DelayLine::SetDelay(const float *delaySamples, int numSamples)
+{
+    jassert(numSamples <= mMaxBlockSize);
+
+    for (int32_t i = 0; i < numSamples; ++i)
+        mReadIndices[i] = (mWritePosition + i - SplitDelay(delaySamples[i], mFractions[i])) & mMask;
+}
+
+void DelayLine::SetDelay(float delaySamples, int numSamples)
+{
+    jassert(numSamples <= mMaxBlockSize);
+
+    float fraction = 0.0f;
+    const int32_t start = mWritePosition - SplitDelay(delaySamples, fraction);
+    for (int32_t i = 0; i < numSamples; ++i)
+        mReadIndices[i] = (start + i) & mMask;
+
+    juce::FloatVectorOperations::fill(mFractions, fraction, numSamples);
+}
+
+void DelayLine::SetVoiceDelays(const float *const *delaySamples, int numVoices, int numSamples)
+{
+    jassert(numSamples <= mMaxBlockSize);
+    jassert(numVoices >= 1 && numVoices <= mMaxVoices);
+
+    // Taps are interleaved, voice v of sample n at n * mSIMDSize + v.
+    for (int32_t voice = 0; voice < mSIMDSize; ++voice)
+    {
+        const float *delays = delaySamples[voice < numVoices ? voice : 0];
+
+        for (int32_t i = 0; i < numSamples; ++i)
+        {
+            const int32_t tap = i * mSIMDSize + voice;
+            mReadIndices[tap] = (mWritePosition + i - SplitDelay(delays[i], mFractions[tap])) & mMask;
+        }
+    }
+}
+
+void DelayLine::Read(int channel, float *dest, int numSamples, Interpolation interpolation)
+{
+    switch (interpolation)
+    {
+    case Interpolation::NEAREST_NEIGHBOUR:
+        Read<Interpolation::NEAREST_NEIGHBOUR>(channel, dest, numSamples);
+        break;
+    case Interpolation::LINEAR:
+        Read<Interpolation::LINEAR>(channel, dest, numSamples);
+        break;
+    case Interpolation::CUBIC:
+        Read<Interpolation::CUBIC>(channel, dest, numSamples);
+        break;
+    }
+}
+
+void DelayLine::ReadVoices(int channel, const float *weights, int numVoices, float *dest, int numSamples, Interpolation interpolation)
+{
+    switch (interpolation)
+    {
+    case Interpolation::NEAREST_NEIGHBOUR:
+        ReadVoices<Interpolation::NEAREST_NEIGHBOUR>(channel, weights, numVoices, dest, numSamples);
+        break;
+    case Interpolation::LINEAR:
+        ReadVoices<Interpolation::LINEAR>(channel, weights, numVoices, dest, numSamples);
+        break;
+    case Interpolation::CUBIC:
+        ReadVoices<Interpolation::CUBIC>(channel, weights, numVoices, dest, numSamples);
+        break;
+    }
+}
+
+void DelayLine::Write(int channel, const float *source, int numSamples)
+{
+    jassert(numSamples <= mMaxBlockSize);
+
+    float *ring = GetRing(channel);
+
+    const int32_t first = juce::jmin(numSamples, (int)(mSize - mWritePosition));
+    juce::FloatVectorOperations::copy(ring + mWritePosition, source, first);
+    if (first < numSamples)
+        juce::FloatVectorOperations::copy(ring, source + first, numSamples - first);
+
+    // Refresh the mirrored guard samples around the ring.
+    ring[-1] = ring[mSize - 1];
+    for (int32_t i = 0; i < mTrailingGuard; ++i)
+        ring[mSize + i] = ring[i];
+}
+
+void DelayLine::Advance(int numSamples)
+{
+    mWritePosition = (mWritePosition + numSamples) & mMask;
+}
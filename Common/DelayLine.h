@@ -0,0 +1,205 @@
+#pragma once
+#include <JuceHeader.h>
+#include "Utils.h"
+
+// Multichannel fractional delay line shared by the delay based effects.
+//
+// Every channel lives in a power-of-two ring buffer, so wrapping a position is a
+// single mask. The ring is surrounded by mirrored guard samples (one before,
+// three after), which means all four taps of a cubic read starting anywhere in
+// the ring are contiguous in memory and the read kernels never test for wrap.
+//
+// Processing is block based: SetDelay() turns a block of delay times into read
+// indices and fractions once, Read() gathers the taps and interpolates the
+// whole block with SIMD kernels, Write() stores a block at the write head and
+// Advance() moves the write head forward.
+//
+// Effects with several taps per channel (the chorus voices) can instead use
+// SetVoiceDelays() and ReadVoices(), which keep one voice per SIMD lane and
+// mix the voices of every sample with one multiply and one horizontal sum.
+class DelayLine
+{
+public:
+    DelayLine() = default;
+
+    // Allocates room for delays up to maxDelaySamples while a block of up to
+    // maxBlockSize samples is written ahead of the reads. maxVoices above one
+    // sizes the scratch for ReadVoices().
+    void Prepare(int numChannels, int maxDelaySamples, int maxBlockSize, int maxVoices = 1);
+    void Reset();
+
+    int GetNumChannels() const { return mNumChannels; }
+    int GetMaxBlockSize() const { return mMaxBlockSize; }
+
+    // Voices read together by ReadVoices(), one per SIMD lane.
+    static constexpr int GetMaxVoices() { return (int)juce::dsp::SIMDRegister<float>::SIMDNumElements; }
+
+    // Number of samples (at most numSamples) that can be read before any of
+    // them has to be written back, given the shortest delay used in the chunk.
+    // Feedback effects process their blocks in chunks of this size.
+    int GetChunkSize(float minDelaySamples, int numSamples) const;
+
+    // Sample n of the next block is read at (write position + n - delay[n]).
+    void SetDelay(const float *delaySamples, int numSamples);
+    void SetDelay(float delaySamples, int numSamples);
+
+    template <Interpolation interpolation>
+    void Read(int channel, float *dest, int numSamples);
+    void Read(int channel, float *dest, int numSamples, Interpolation interpolation);
+
+    // Multi-voice variant: voice v of sample n is read at (write position + n - delaySamples[v][n]),
+    // and ReadVoices() writes the weighted sum of the voices to dest.
+    void SetVoiceDelays(const float *const *delaySamples, int numVoices, int numSamples);
+
+    template <Interpolation interpolation>
+    void ReadVoices(int channel, const float *weights, int numVoices, float *dest, int numSamples);
+    void ReadVoices(int channel, const float *weights, int numVoices, float *dest, int numSamples, Interpolation interpolation);
+
+    void Write(int channel, const float *source, int numSamples);
+    void Advance(int numSamples);
+
+private:
+    static constexpr int mLeadingGuard = 1;
+    static constexpr int mTrailingGuard = 3;
+
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int mSIMDSize = (int)SIMDFloat::SIMDNumElements;
+
+    const float *GetRing(int channel) const { return mBuffer.getReadPointer(channel, mLeadingGuard); }
+    float *GetRing(int channel) { return mBuffer.getWritePointer(channel, mLeadingGuard); }
+
+    // Splits a delay into the ring offset ceil(delay) and the fraction ceil(delay) - delay.
+    static int32_t SplitDelay(float delaySamples, float &fraction);
+
+    template <Interpolation interpolation>
+    void Gather(const float *ring, int32_t numTaps);
+    template <Interpolation interpolation>
+    SIMDFloat Interpolate(int32_t tap) const;
+
+    juce::AudioSampleBuffer mBuffer;
+    int32_t mNumChannels = 0;
+    int32_t mSize = 0;
+    int32_t mMask = 0;
+    int32_t mWritePosition = 0;
+    int32_t mMaxBlockSize = 0;
+    int32_t mMaxVoices = 1;
+
+    // Per-block read positions and SIMD aligned tap scratch, sized in Prepare().
+    juce::HeapBlock<int32_t> mReadIndices;
+    juce::HeapBlock<float> mScratchMemory;
+    int32_t mScratchStride = 0;
+    float *mFractions = nullptr;
+    float *mTaps[4] = {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DelayLine)
+};
+
+template <Interpolation interpolation>
+void DelayLine::Gather(const float *ring, int32_t numTaps)
+{
+    // The guard samples keep every tap in bounds without masking.
+    const int32_t *index = mReadIndices.get();
+    float *tap0 = mTaps[0];
+    float *tap1 = mTaps[1];
+    float *tap2 = mTaps[2];
+    float *tap3 = mTaps[3];
+
+    if constexpr (interpolation == Interpolation::NEAREST_NEIGHBOUR)
+    {
+        for (int32_t i = 0; i < numTaps; ++i)
+            tap0[i] = ring[index[i]];
+    }
+    else if constexpr (interpolation == Interpolation::LINEAR)
+    {
+        for (int32_t i = 0; i < numTaps; ++i)
+        {
+            const float *p = ring + index[i];
+            tap0[i] = p[0];
+            tap1[i] = p[1];
+        }
+    }
+    else
+    {
+        for (int32_t i = 0; i < numTaps; ++i)
+        {
+            const float *p = ring + index[i];
+            tap0[i] = p[-1];
+            tap1[i] = p[0];
+            tap2[i] = p[1];
+            tap3[i] = p[2];
+        }
+    }
+}
+
+template <Interpolation interpolation>
+DelayLine::SIMDFloat DelayLine::Interpolate(int32_t tap) const
+{
+    if constexpr (interpolation == Interpolation::NEAREST_NEIGHBOUR)
+    {
+        return SIMDFloat::fromRawArray(mTaps[0] + tap);
+    }
+    else if constexpr (interpolation == Interpolation::LINEAR)
+    {
+        const auto fraction = SIMDFloat::fromRawArray(mFractions + tap);
+        const auto delayed0 = SIMDFloat::fromRawArray(mTaps[0] + tap);
+        const auto delayed1 = SIMDFloat::fromRawArray(mTaps[1] + tap);
+        return delayed0 + fraction * (delayed1 - delayed0);
+    }
+    else
+    {
+        const auto fraction = SIMDFloat::fromRawArray(mFractions + tap);
+        const auto sample0 = SIMDFloat::fromRawArray(mTaps[0] + tap);
+        const auto sample1 = SIMDFloat::fromRawArray(mTaps[1] + tap);
+        const auto sample2 = SIMDFloat::fromRawArray(mTaps[2] + tap);
+        const auto sample3 = SIMDFloat::fromRawArray(mTaps[3] + tap);
+
+        const auto a0 = (sample3 - sample0) * 0.5f + (sample1 - sample2) * 1.5f;
+        const auto a1 = sample0 - sample1 * 2.5f + sample2 * 2.0f - sample3 * 0.5f;
+        const auto a2 = (sample2 - sample0) * 0.5f;
+        return ((a0 * fraction + a1) * fraction + a2) * fraction + sample1;
+    }
+}
+
+template <Interpolation interpolation>
+void DelayLine::Read(int channel, float *dest, int numSamples)
+{
+    jassert(numSamples <= mMaxBlockSize);
+
+    const float *ring = GetRing(channel);
+
+    if constexpr (interpolation == Interpolation::NEAREST_NEIGHBOUR)
+    {
+        const int32_t *index = mReadIndices.get();
+        for (int32_t i = 0; i < numSamples; ++i)
+            dest[i] = ring[index[i]];
+        return;
+    }
+
+    Gather<interpolation>(ring, numSamples);
+
+    // Interpolation pass over contiguous, aligned arrays. The scratch is padded
+    // to a whole number of registers, so the last partial register needs no tail.
+    float *out = mTaps[0];
+    for (int32_t i = 0; i < numSamples; i += mSIMDSize)
+        Interpolate<interpolation>(i).copyToRawArray(out + i);
+
+    juce::FloatVectorOperations::copy(dest, out, numSamples);
+}
+
+template <Interpolation interpolation>
+void DelayLine::ReadVoices(int channel, const float *weights, int numVoices, float *dest, int numSamples)
+{
+    jassert(numSamples <= mMaxBlockSize);
+    jassert(numVoices <= mMaxVoices);
+
+    // Lanes without a voice read voice 0 again and get no weight.
+    auto voiceWeights = SIMDFloat::expand(0.0f);
+    for (int32_t voice = 0; voice < numVoices; ++voice)
+        voiceWeights.set((size_t)voice, weights[voice]);
+
+    Gather<interpolation>(GetRing(channel), numSamples * mSIMDSize);
+
+    // One register holds all voices of one sample.
+    for (int32_t i = 0; i < numSamples; ++i)
+        dest[i] = (Interpolate<interpolation>(i * mSIMDSize) * voiceWeights).sum();
+}
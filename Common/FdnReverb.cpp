@@ -0,0 +1,362 @@
+#include "FdnReverb.h"
+#include "SilenceDetector.h"
+
+namespace
+{
+    constexpr double MIN_DELAY_MS = 23.0;
+    constexpr double MAX_DELAY_MS = 83.0;
+    constexpr double MODULATION_DEPTH_MS = 0.3;
+    constexpr double MIN_MODULATION_HZ = 0.07;
+    constexpr double MAX_MODULATION_HZ = 0.9;
+    // Slow enough that fading the modulation in or out bends the pitch by
+    // about a cent.
+    constexpr double MODULATION_FADE_SECONDS = 0.5;
+
+    // Room size 0-1 maps to a decay time of 0.2-12 seconds.
+    constexpr float MIN_DECAY_SECONDS = 0.2f;
+    constexpr float DECAY_RANGE = 60.0f;
+
+    constexpr float MAX_DAMPING = 0.7f;
+    constexpr double SMOOTHING_SECONDS = 0.01;
+
+    constexpr int FIXED_POINT_BITS = 16;
+    constexpr int FIXED_POINT_ONE = 1 << FIXED_POINT_BITS;
+
+    // Sign patterns of the input and output taps, one bit per line. Any
+    // patterns work that are not all equal; these are just well mixed bits.
+    constexpr juce::uint32 INPUT_SIGNS[] = { 0x6D2B79F5u, 0x9E3779B9u };
+    constexpr juce::uint32 OUTPUT_SIGNS[] = { 0x85EBCA6Bu, 0xC2B2AE35u };
+
+    bool IsPrime(int n)
+    {
+        if (n < 2)
+            return false;
+        for (int divisor = 2; divisor * divisor <= n; ++divisor)
+            if (n % divisor == 0)
+                return false;
+        return true;
+    }
+
+    // Prime delays have no common factors, so the echoes of different lines
+    // do not pile up on the same samples.
+    int NextPrime(int n)
+    {
+        while (!IsPrime(n))
+            ++n;
+        return n;
+    }
+}
+
+FdnReverb::FdnReverb()
+{
+    SetParameters(Parameters());
+}
+
+void FdnReverb::Prepare(double sampleRate)
+{
+    mSampleRate = sampleRate;
+    mModulationDepth = (float)(MODULATION_DEPTH_MS * sampleRate / 1000.0);
+
+    const int maxDelay = (int)std::ceil(MAX_DELAY_MS * sampleRate / 1000.0) + (int)std::ceil(mModulationDepth);
+    mBufferSize = (int)juce::nextPowerOfTwo(maxDelay + MAX_CHUNK_SIZE + 4);
+
+    const int frameSize = MAX_CHUNK_SIZE * MAX_LINES;
+    mMemory.calloc((size_t)(6 * MAX_LINES + frameSize + 4 * MAX_CHUNK_SIZE + MAX_LINES * mBufferSize + mSIMDSize));
+    mLineGains = SIMDFloat::getNextSIMDAlignedPtr(mMemory.get());
+    mLowpassState = mLineGains + MAX_LINES;
+    mInputSigns[0] = mLowpassState + MAX_LINES;
+    mInputSigns[1] = mInputSigns[0] + MAX_LINES;
+    mOutputSigns[0] = mInputSigns[1] + MAX_LINES;
+    mOutputSigns[1] = mOutputSigns[0] + MAX_LINES;
+    mFrames = mOutputSigns[1] + MAX_LINES;
+    mInput[0] = mFrames + frameSize;
+    mInput[1] = mInput[0] + MAX_CHUNK_SIZE;
+    mWet[0] = mInput[1] + MAX_CHUNK_SIZE;
+    mWet[1] = mWet[0] + MAX_CHUNK_SIZE;
+    mBuffers = mWet[1] + MAX_CHUNK_SIZE;
+
+    for (auto *smoother : { &mRoomSize, &mDamping, &mDryGain, &mWetGain1, &mWetGain2 })
+        smoother->reset(sampleRate, SMOOTHING_SECONDS);
+    mModulation.reset(sampleRate, MODULATION_FADE_SECONDS);
+
+    SetNumLines(mNumLines);
+}
+
+void FdnReverb::Reset()
+{
+    juce::FloatVectorOperations::clear(mLowpassState, MAX_LINES);
+    juce::FloatVectorOperations::clear(mBuffers, MAX_LINES * mBufferSize);
+    mWritePosition = 0;
+}
+
+void FdnReverb::SetNumLines(int numLines)
+{
+    jassert(numLines == 8 || numLines == 16 || numLines == 32);
+    mNumLines = juce::jlimit(8, MAX_LINES, numLines);
+
+    if (mMemory == nullptr)
+        return;
+
+    const double ratio = MAX_DELAY_MS / MIN_DELAY_MS;
+    int minDelay = std::numeric_limits<int>::max();
+
+    for (int line = 0; line < mNumLines; ++line)
+    {
+        const double position = (double)line / (mNumLines - 1);
+        const double delayMs = MIN_DELAY_MS * std::pow(ratio, position);
+        const int delay = NextPrime((int)(delayMs * mSampleRate / 1000.0));
+
+        mDelays[(size_t)line] = (float)delay;
+        minDelay = juce::jmin(minDelay, delay);
+
+        // Spread the rates the same way, so no two lines move together.
+        const double rate = MIN_MODULATION_HZ * std::pow(MAX_MODULATION_HZ / MIN_MODULATION_HZ, position);
+        mModulationIncrements[(size_t)line] = juce::MathConstants<double>::twoPi * rate / mSampleRate;
+        mModulationPhases[(size_t)line] = juce::MathConstants<double>::twoPi * position;
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            mInputSigns[channel][line] = ((INPUT_SIGNS[channel] >> line) & 1) ? 1.0f : -1.0f;
+            mOutputSigns[channel][line] = ((OUTPUT_SIGNS[channel] >> line) & 1) ? 1.0f : -1.0f;
+        }
+    }
+
+    // Reads reach at most the chunk length back past the write position, so
+    // the chunk has to stay shorter than the shortest delay.
+    mChunkSize = juce::jmin(MAX_CHUNK_SIZE, minDelay - 2);
+    mLineGainsRoomSize = -1.0f;
+
+    Reset();
+}
+
+void FdnReverb::SetParameters(const Parameters &parameters)
+{
+    mDryGain.setTargetValue(parameters.dryLevel);
+    mWetGain1.setTargetValue(0.5f * parameters.wetLevel * (1.0f + parameters.width));
+    mWetGain2.setTargetValue(0.5f * parameters.wetLevel * (1.0f - parameters.width));
+
+    // Frozen, the lines stop taking input and keep what they hold: the
+    // matrix is orthogonal and the gains are one, but a modulated read
+    // interpolates, which loses energy, so the modulation fades out too.
+    const bool frozen = parameters.freezeMode >= 0.5f;
+    mInputGain = frozen ? 0.0f : 1.0f;
+    mModulation.setTargetValue(frozen ? 0.0f : 1.0f);
+    mDamping.setTargetValue(frozen ? 0.0f : parameters.damping * MAX_DAMPING);
+    mRoomSize.setTargetValue(frozen ? 2.0f : parameters.roomSize);
+}
+
+double FdnReverb::GetTailLengthSeconds(const Parameters &parameters)
+{
+    if (parameters.freezeMode >= 0.5f)
+        return std::numeric_limits<double>::infinity();
+
+    // The decay starts once the input has gone round the longest line.
+    const double decaySeconds = MIN_DECAY_SECONDS * std::pow(DECAY_RANGE, parameters.roomSize);
+    return SilenceDetector::DecayTail(decaySeconds) + (MAX_DELAY_MS + MODULATION_DEPTH_MS) / 1000.0;
+}
+
+void FdnReverb::UpdateLineGains(float roomSize)
+{
+    if (roomSize == mLineGainsRoomSize)
+        return;
+
+    mLineGainsRoomSize = roomSize;
+
+    // A room size past 1 is the frozen state.
+    if (roomSize > 1.0f)
+    {
+        juce::FloatVectorOperations::fill(mLineGains, 1.0f, MAX_LINES);
+        return;
+    }
+
+    // Every pass through a line loses what its delay is worth of a 60 dB decay.
+    const float decaySeconds = MIN_DECAY_SECONDS * std::pow(DECAY_RANGE, roomSize);
+    for (int line = 0; line < mNumLines; ++line)
+        mLineGains[line] = std::pow(10.0f, -3.0f * mDelays[(size_t)line] / (decaySeconds * (float)mSampleRate));
+}
+
+void FdnReverb::Process(float *left, float *right, int numSamples)
+{
+    jassert(mChunkSize > 0);
+
+    for (int offset = 0; offset < numSamples; offset += mChunkSize)
+    {
+        const int chunkSamples = juce::jmin(mChunkSize, numSamples - offset);
+        ProcessChunk(left + offset, right != nullptr ? right + offset : nullptr, chunkSamples);
+    }
+}
+
+void FdnReverb::ProcessChunk(float *left, float *right, int numSamples)
+{
+    const int numLines = mNumLines;
+    const int numRegisters = numLines / mSIMDSize;
+    const int mask = mBufferSize - 1;
+
+    UpdateLineGains(mRoomSize.skip(numSamples));
+    const float damping = mDamping.skip(numSamples);
+    const float norm = 1.0f / std::sqrt((float)numLines);
+    const float startDepth = mModulationDepth * 0.5f * mModulation.getCurrentValue();
+    const float endDepth = mModulationDepth * 0.5f * mModulation.skip(numSamples);
+
+    // Both channels' input enters every line, with a sign pattern per channel.
+    const int numChannels = right != nullptr ? 2 : 1;
+    juce::FloatVectorOperations::multiply(mInput[0], left, mInputGain * norm, numSamples);
+    if (right != nullptr)
+        juce::FloatVectorOperations::multiply(mInput[1], right, mInputGain * norm, numSamples);
+
+    // Gather the delayed outputs into lane order. The modulation moves so
+    // slowly that it is interpolated linearly across the chunk. Without it
+    // the delays are whole samples and the reads copy exactly.
+    for (int line = 0; line < numLines; ++line)
+    {
+        auto &phase = mModulationPhases[(size_t)line];
+        const float startDelay = mDelays[(size_t)line] + startDepth * (1.0f + (float)std::sin(phase));
+        phase += mModulationIncrements[(size_t)line] * numSamples;
+        if (phase >= juce::MathConstants<double>::twoPi)
+            phase -= juce::MathConstants<double>::twoPi;
+        const float endDelay = mDelays[(size_t)line] + endDepth * (1.0f + (float)std::sin(phase));
+        const float delayStep = (endDelay - startDelay) / (float)numSamples;
+
+        // Read positions relative to the write position, in 16.16 fixed point
+        // so stepping them costs an integer add.
+        const float *buffer = mBuffers + line * mBufferSize;
+        int position = juce::roundToInt(-startDelay * FIXED_POINT_ONE);
+        const int increment = juce::roundToInt((1.0f - delayStep) * FIXED_POINT_ONE);
+
+        for (int i = 0; i < numSamples; ++i, position += increment)
+        {
+            const int whole = mWritePosition + (position >> FIXED_POINT_BITS);
+            const float fraction = (float)(position & (FIXED_POINT_ONE - 1)) * (1.0f / FIXED_POINT_ONE);
+            const float sample0 = buffer[whole & mask];
+            const float sample1 = buffer[(whole + 1) & mask];
+            mFrames[i * numLines + line] = sample0 + fraction * (sample1 - sample0);
+        }
+    }
+
+    const auto damp1 = SIMDFloat::expand(1.0f - damping);
+    const auto damp2 = SIMDFloat::expand(damping);
+    const auto hadamardNorm = SIMDFloat::expand(norm);
+    const float reflection = -2.0f / (float)numLines;
+
+    SIMDFloat lowpass[MAX_LINES / mSIMDSize];
+    for (int r = 0; r < numRegisters; ++r)
+        lowpass[r] = SIMDFloat::fromRawArray(mLowpassState + r * mSIMDSize);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        float *frame = mFrames + i * numLines;
+        SIMDFloat lines[MAX_LINES / mSIMDSize];
+        SIMDFloat wet[2] = { SIMDFloat::expand(0.0f), SIMDFloat::expand(0.0f) };
+
+        for (int r = 0; r < numRegisters; ++r)
+        {
+            const int lane = r * mSIMDSize;
+            lowpass[r] = SIMDFloat::fromRawArray(frame + lane) * damp1 + lowpass[r] * damp2;
+            lines[r] = lowpass[r] * SIMDFloat::fromRawArray(mLineGains + lane);
+            wet[0] += lines[r] * SIMDFloat::fromRawArray(mOutputSigns[0] + lane);
+            wet[1] += lines[r] * SIMDFloat::fromRawArray(mOutputSigns[1] + lane);
+        }
+
+        mWet[0][i] = wet[0].sum() * norm;
+        mWet[1][i] = wet[1].sum() * norm;
+
+        // Walsh-Hadamard butterflies within registers, which need the lanes
+        // apart, so they go through the frame whose delayed samples are
+        // already used...
+        for (int r = 0; r < numRegisters; ++r)
+            lines[r].copyToRawArray(frame + r * mSIMDSize);
+
+        for (int half = mSIMDSize / 2; half >= 1; half /= 2)
+        {
+            for (int start = 0; start < numLines; start += 2 * half)
+            {
+                for (int line = start; line < start + half; ++line)
+                {
+                    const float a = frame[line];
+                    const float b = frame[line + half];
+                    frame[line] = a + b;
+                    frame[line + half] = a - b;
+                }
+            }
+        }
+
+        for (int r = 0; r < numRegisters; ++r)
+            lines[r] = SIMDFloat::fromRawArray(frame + r * mSIMDSize);
+
+        // ...then between registers...
+        for (int half = numRegisters / 2; half >= 1; half /= 2)
+        {
+            for (int start = 0; start < numRegisters; start += 2 * half)
+            {
+                for (int r = start; r < start + half; ++r)
+                {
+                    const auto a = lines[r];
+                    const auto b = lines[r + half];
+                    lines[r] = a + b;
+                    lines[r + half] = a - b;
+                }
+            }
+        }
+
+        // ...then the Householder reflection across all lines.
+        auto total = lines[0];
+        for (int r = 1; r < numRegisters; ++r)
+            total += lines[r];
+        const auto reflected = SIMDFloat::expand(total.sum() * reflection);
+
+        const auto inputLeft = SIMDFloat::expand(mInput[0][i]);
+        const auto inputRight = SIMDFloat::expand(numChannels > 1 ? mInput[1][i] : 0.0f);
+        for (int r = 0; r < numRegisters; ++r)
+        {
+            const int lane = r * mSIMDSize;
+            const auto feedback = (lines[r] + reflected) * hadamardNorm
+                                  + inputLeft * SIMDFloat::fromRawArray(mInputSigns[0] + lane)
+                                  + inputRight * SIMDFloat::fromRawArray(mInputSigns[1] + lane);
+            feedback.copyToRawArray(frame + lane);
+        }
+    }
+
+    for (int r = 0; r < numRegisters; ++r)
+        lowpass[r].copyToRawArray(mLowpassState + r * mSIMDSize);
+
+    // Scatter the new samples to the write position of every line.
+    for (int line = 0; line < numLines; ++line)
+    {
+        float *buffer = mBuffers + line * mBufferSize;
+        for (int i = 0; i < numSamples; ++i)
+            buffer[(mWritePosition + i) & mask] = mFrames[i * numLines + line];
+    }
+    mWritePosition = (mWritePosition + numSamples) & mask;
+
+    if (right != nullptr)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float dry = mDryGain.getNextValue();
+            const float wet1 = mWetGain1.getNextValue();
+            const float wet2 = mWetGain2.getNextValue();
+            left[i] = mWet[0][i] * wet1 + mWet[1][i] * wet2 + left[i] * dry;
+            right[i] = mWet[1][i] * wet1 + mWet[0][i] * wet2 + right[i] * dry;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float dry = mDryGain.getNextValue();
+            const float wet1 = mWetGain1.getNextValue();
+            mWetGain2.skip(1);
+            left[i] = mWet[0][i] * wet1 + left[i] * dry;
+        }
+    }
+}
+
+int FdnReverb::GetAutoNumLines(double sampleRate)
+{
+    // The limits lie between the common rates: 44.1 and 48 kHz get 32 lines,
+    // 88.2 and 96 kHz get 16.
+    int numLines = MAX_LINES;
+    for (double limit = 64000.0; sampleRate > limit && numLines > 8; limit *= 2.0)
+        numLines /= 2;
+    return numLines;
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Feedback delay network reverb with 8, 16 or 32 delay lines, taking the
+// same parameters as juce::dsp::Reverb.
+//
+// Every line has a one-pole damping filter and a gain that sets its decay
+// from the room size. The lines feed back through an orthogonal matrix: a
+// Walsh-Hadamard transform across all lines, whose butterflies between SIMD
+// registers are plain register adds and subtracts and whose butterflies within
+// a register run on the stored frame, followed by a Householder reflection,
+// which only needs one horizontal sum. Delay times are spread exponentially
+// over 23-83 ms, rounded to primes, and slowly modulated by a fraction of a
+// millisecond to smear the modes. Frozen, the modulation fades out, so the
+// lines read whole samples and the tail keeps its energy.
+//
+// As in StereoReverb the lines are lanes, and a chunk shorter than every
+// delay reads all its delayed samples before writing any.
+class FdnReverb
+{
+public:
+    using Parameters = juce::dsp::Reverb::Parameters;
+
+    static constexpr int MAX_LINES = 32;
+
+    FdnReverb();
+
+    // Allocates for MAX_LINES lines, so SetNumLines() never allocates.
+    void Prepare(double sampleRate);
+    void Reset();
+
+    // 8, 16 or 32. Changing the size clears the tail.
+    void SetNumLines(int numLines);
+    int GetNumLines() const { return mNumLines; }
+
+    void SetParameters(const Parameters &parameters);
+
+    // Seconds until an impulse has died away below SilenceDetector's
+    // threshold, infinite when frozen.
+    static double GetTailLengthSeconds(const Parameters &parameters);
+
+    // Processes a pair of channels in place. With right == nullptr the left
+    // channel is processed as mono.
+    void Process(float *left, float *right, int numSamples);
+
+    // The size "Auto" stands for: 32 lines up to 48 kHz, halved for every
+    // doubling of the rate past that, so a second of audio costs about the
+    // same at any rate. Only the rate decides, so every machine and every
+    // offline render gets the same sound.
+    static int GetAutoNumLines(double sampleRate);
+
+private:
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int mSIMDSize = (int)SIMDFloat::SIMDNumElements;
+    static constexpr int MAX_CHUNK_SIZE = 64;
+
+    static_assert(8 % mSIMDSize == 0, "the smallest network has to fill whole registers");
+
+    void ProcessChunk(float *left, float *right, int numSamples);
+    void UpdateLineGains(float roomSize);
+
+    double mSampleRate = 0.0;
+    int mNumLines = 8;
+    int mChunkSize = 0;
+    float mInputGain = 0.0f;
+    float mLineGainsRoomSize = -1.0f;
+
+    juce::LinearSmoothedValue<float> mRoomSize, mDamping, mDryGain, mWetGain1, mWetGain2;
+    // How much of mModulationDepth is applied, 0 when frozen.
+    juce::LinearSmoothedValue<float> mModulation;
+
+    // Per line.
+    std::array<float, MAX_LINES> mDelays{};
+    std::array<double, MAX_LINES> mModulationPhases{};
+    std::array<double, MAX_LINES> mModulationIncrements{};
+
+    // Every line has a power-of-two ring of the same size, written at a shared position.
+    int mBufferSize = 0;
+    int mWritePosition = 0;
+    float mModulationDepth = 0.0f;
+
+    // SIMD aligned, sized in Prepare(): per line gains, damping state and
+    // input and output signs, the lane ordered chunk, the chunk scratch and
+    // the delay buffers.
+    juce::HeapBlock<float> mMemory;
+    float *mLineGains = nullptr;
+    float *mLowpassState = nullptr;
+    float *mInputSigns[2] = {};
+    float *mOutputSigns[2] = {};
+    float *mFrames = nullptr;
+    float *mInput[2] = {};
+    float *mWet[2] = {};
+    float *mBuffers = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FdnReverb)
+};
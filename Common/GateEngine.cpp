@@ -0,0 +1,215 @@
+#include "GateEngine.h"
+
+void GateEngine::Prepare(double sampleRate, int numChannels, int maxBlockSize, int numKeyChannels)
+{
+    mSampleRate = sampleRate;
+    mNumChannels = juce::jmax(0, numChannels);
+    mNumKeyChannels = numKeyChannels < 0 ? mNumChannels : numKeyChannels;
+    mMaxBlockSize = juce::jmax(1, maxBlockSize);
+    mMaxLookahead = (int)std::ceil(MAX_LOOKAHEAD_MS * 0.001 * sampleRate);
+
+    // The second detector channel is scratch for the other channels' magnitudes.
+    mDetector.setSize(2, mMaxBlockSize);
+    mGainCurve.setSize(1, mMaxBlockSize);
+    mDelayBuffer.setSize(juce::jmax(1, mNumChannels), mMaxLookahead + mMaxBlockSize);
+    mKeyState1.resize((size_t)mNumKeyChannels);
+    mKeyState2.resize((size_t)mNumKeyChannels);
+
+    SetParameters(mParameters);
+    Reset();
+}
+
+void GateEngine::Reset()
+{
+    mEnvelope = 0.0f;
+    mGain = 0.0f;
+    mHoldCountDown = 0;
+    mDelayBuffer.clear();
+    std::fill(mKeyState1.begin(), mKeyState1.end(), 0.0f);
+    std::fill(mKeyState2.begin(), mKeyState2.end(), 0.0f);
+}
+
+void GateEngine::SetParameters(const Parameters &parameters)
+{
+    mParameters = parameters;
+
+    const double samplesPerMs = 0.001 * mSampleRate;
+    mThreshold = parameters.threshold;
+    mSmoothing = juce::jlimit(0.0f, 1.0f, parameters.smoothing);
+    mAttackStep = 1.0f / (float)juce::jmax(1.0, parameters.attackMs * samplesPerMs);
+    mReleaseStep = 1.0f / (float)juce::jmax(1.0, parameters.releaseMs * samplesPerMs);
+    mHoldSamples = juce::roundToInt(juce::jmax(0.0, parameters.holdMs * samplesPerMs));
+
+    mKeyFilterOn = parameters.keyFilter != KEY_FILTER_OFF;
+    if (mKeyFilterOn)
+    {
+        const double frequency = juce::jlimit(10.0, 0.49 * mSampleRate, (double)parameters.keyFrequency);
+        const double g = std::tan(juce::MathConstants<double>::pi * frequency / mSampleRate);
+        const double k = juce::MathConstants<double>::sqrt2;
+        const double a1 = 1.0 / (1.0 + g * (g + k));
+        mKeyA1 = (float)a1;
+        mKeyA2 = (float)(g * a1);
+        mKeyA3 = (float)(g * g * a1);
+
+        const bool highPass = parameters.keyFilter == KEY_FILTER_HIGH_PASS;
+        mKeyMix[0] = highPass ? 1.0f : 0.0f;
+        mKeyMix[1] = highPass ? (float)-k : 0.0f;
+        mKeyMix[2] = highPass ? -1.0f : 1.0f;
+    }
+
+    const int lookahead = juce::jlimit(0, mMaxLookahead, juce::roundToInt(parameters.lookaheadMs * samplesPerMs));
+    if (lookahead != mLookahead)
+    {
+        mLookahead = lookahead;
+        mDelayBuffer.clear();
+    }
+}
+
+void GateEngine::Process(const juce::dsp::AudioBlock<float> &block)
+{
+    Process(block, block);
+}
+
+void GateEngine::Process(const juce::dsp::AudioBlock<float> &block, const juce::dsp::AudioBlock<float> &key)
+{
+    jassert(key.getNumSamples() == block.getNumSamples());
+
+    const auto numChannels = juce::jmin(block.getNumChannels(), (size_t)mNumChannels);
+    if (numChannels == 0 || key.getNumChannels() == 0)
+        return;
+
+    const auto channels = block.getSubsetChannelBlock(0, numChannels);
+    for (size_t start = 0; start < block.getNumSamples(); start += (size_t)mMaxBlockSize)
+    {
+        const auto length = juce::jmin((size_t)mMaxBlockSize, block.getNumSamples() - start);
+        ComputeGain(key.getSubBlock(start, length));
+        ApplyGain(channels.getSubBlock(start, length));
+    }
+}
+
+void GateEngine::Skip(int numSamples)
+{
+    mEnvelope *= std::pow(mSmoothing, (float)numSamples);
+
+    // Silence keeps the gate open only for what is left of the hold.
+    const int held = juce::jmin(mHoldCountDown, numSamples);
+    mHoldCountDown -= held;
+    mGain = juce::jmin(1.0f, mGain + (float)held * mAttackStep);
+    mGain = juce::jmax(0.0f, mGain - (float)(numSamples - held) * mReleaseStep);
+}
+
+void GateEngine::ComputeGain(const juce::dsp::AudioBlock<float> &key)
+{
+    const int numSamples = (int)key.getNumSamples();
+    const int numKeyChannels = juce::jmin((int)key.getNumChannels(), mNumKeyChannels);
+    jassert(numSamples <= mMaxBlockSize && numKeyChannels > 0);
+    float *detector = mDetector.getWritePointer(0);
+    float *scratch = mDetector.getWritePointer(1);
+
+    juce::FloatVectorOperations::abs(detector, FilterKey(0, key.getChannelPointer(0), detector, numSamples), numSamples);
+    for (int channel = 1; channel < numKeyChannels; ++channel)
+    {
+        juce::FloatVectorOperations::abs(scratch, FilterKey(channel, key.getChannelPointer((size_t)channel), scratch, numSamples), numSamples);
+        juce::FloatVectorOperations::max(detector, detector, scratch, numSamples);
+    }
+
+    float *gainCurve = mGainCurve.getWritePointer(0);
+    const float smoothing = mSmoothing;
+    const float input = 1.0f - smoothing;
+    const float threshold = mThreshold;
+    const float attackStep = mAttackStep;
+    const float releaseStep = mReleaseStep;
+    const int holdSamples = mHoldSamples;
+    float envelope = mEnvelope;
+    float gain = mGain;
+    int holdCountDown = mHoldCountDown;
+    bool allClosed = true;
+    bool allOpen = true;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        envelope = smoothing * envelope + input * detector[i];
+
+        if (envelope >= threshold)
+            holdCountDown = holdSamples + 1;
+
+        if (holdCountDown > 0)
+        {
+            --holdCountDown;
+            gain = juce::jmin(1.0f, gain + attackStep);
+        }
+        else
+        {
+            gain = juce::jmax(0.0f, gain - releaseStep);
+        }
+
+        gainCurve[i] = gain;
+        allClosed &= gain == 0.0f;
+        allOpen &= gain == 1.0f;
+    }
+
+    mEnvelope = envelope;
+    mGain = gain;
+    mHoldCountDown = holdCountDown;
+    mAllClosed = allClosed;
+    mAllOpen = allOpen;
+}
+
+void GateEngine::ApplyGain(const juce::dsp::AudioBlock<float> &block)
+{
+    const int numSamples = (int)block.getNumSamples();
+    const float *gainCurve = mGainCurve.getReadPointer(0);
+
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        float *samples = block.getChannelPointer(channel);
+
+        // A closed block still has to pass through the lookahead, for the
+        // blocks after it.
+        if (mLookahead > 0)
+            Delay((int)channel, samples, numSamples, !mAllClosed);
+
+        if (mAllClosed)
+            juce::FloatVectorOperations::clear(samples, numSamples);
+        else if (!mAllOpen)
+            juce::FloatVectorOperations::multiply(samples, gainCurve, numSamples);
+    }
+}
+
+const float *GateEngine::FilterKey(int channel, const float *key, float *output, int numSamples)
+{
+    if (!mKeyFilterOn)
+        return key;
+
+    const float a1 = mKeyA1, a2 = mKeyA2, a3 = mKeyA3;
+    const float m0 = mKeyMix[0], m1 = mKeyMix[1], m2 = mKeyMix[2];
+    float state1 = mKeyState1[(size_t)channel];
+    float state2 = mKeyState2[(size_t)channel];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float v0 = key[i];
+        const float v3 = v0 - state2;
+        const float v1 = a1 * state1 + a2 * v3;
+        const float v2 = state2 + a2 * state1 + a3 * v3;
+        state1 = 2.0f * v1 - state1;
+        state2 = 2.0f * v2 - state2;
+        output[i] = m0 * v0 + m1 * v1 + m2 * v2;
+    }
+
+    mKeyState1[(size_t)channel] = state1;
+    mKeyState2[(size_t)channel] = state2;
+    return output;
+}
+
+void GateEngine::Delay(int channel, float *samples, int numSamples, bool keepOutput)
+{
+    float *history = mDelayBuffer.getWritePointer(channel);
+
+    juce::FloatVectorOperations::copy(history + mLookahead, samples, numSamples);
+    if (keepOutput)
+        juce::FloatVectorOperations::copy(samples, history, numSamples);
+
+    // With a block shorter than the lookahead the new history overlaps the old.
+    std::memmove(history, history + numSamples, sizeof(float) * (size_t)mLookahead);
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Noise gate, processed a block at a time in passes over contiguous memory.
+//
+// Detection and gain are separate: ComputeGain() turns a key signal into one
+// gain curve, which ApplyGain() applies to any number of channels. The key is
+// the gated audio itself or a sidechain, read where it lies.
+//
+// The key may first go through a state variable filter, high pass to ignore
+// rumble or low pass to key off a kick. The detector is then the loudest key
+// channel's absolute value, built with vectorised abs and max passes. The
+// envelope smooths it with a one-pole filter, which is recursive and runs as a
+// tight scalar loop over the detector block, alongside the gate state: while
+// the envelope is at or above the threshold, and for the hold time after it
+// falls below, the gain ramps linearly up to one over the attack time,
+// otherwise down to zero over the release time. The gain curve is then
+// applied with one multiply pass per channel. A block that stays closed
+// throughout is cleared instead, and one that stays open is left as it is.
+//
+// With lookahead the audio is delayed behind the detector, so the gate has
+// opened by the time a transient arrives. The delay is the latency the effect
+// reports.
+class GateEngine
+{
+public:
+    enum KeyFilter
+    {
+        KEY_FILTER_OFF = 0,
+        KEY_FILTER_HIGH_PASS,
+        KEY_FILTER_LOW_PASS
+    };
+
+    struct Parameters
+    {
+        // Linear amplitude of the envelope that opens the gate.
+        float threshold = 0.5f;
+        // Per sample coefficient of the envelope's one-pole filter, 0 follows
+        // the detector exactly.
+        float smoothing = 0.8f;
+        float attackMs = 1.0f;
+        float holdMs = 50.0f;
+        float releaseMs = 100.0f;
+        float lookaheadMs = 0.0f;
+        KeyFilter keyFilter = KEY_FILTER_OFF;
+        float keyFrequency = 1000.0f;
+    };
+
+    static constexpr float MAX_LOOKAHEAD_MS = 10.0f;
+
+    GateEngine() = default;
+
+    // numKeyChannels is the most key channels ComputeGain() reads, by default
+    // the gated channels.
+    void Prepare(double sampleRate, int numChannels, int maxBlockSize, int numKeyChannels = -1);
+    void Reset();
+
+    // A change of lookahead clears the delayed audio.
+    void SetParameters(const Parameters &parameters);
+
+    int GetLatencySamples() const { return mLookahead; }
+
+    // Gates the first prepared channels of the block in place, in chunks of
+    // the prepared block size, keyed by the block itself or by a key block of
+    // the same length.
+    void Process(const juce::dsp::AudioBlock<float> &block);
+    void Process(const juce::dsp::AudioBlock<float> &block, const juce::dsp::AudioBlock<float> &key);
+
+    // The two halves of Process(), for blocks no longer than the prepared
+    // size. The gain curve lasts until the next ComputeGain(), so one key can
+    // gate any number of blocks of its length. The key is only read.
+    void ComputeGain(const juce::dsp::AudioBlock<float> &key);
+    void ApplyGain(const juce::dsp::AudioBlock<float> &block);
+
+    // Moves the envelope, hold and gain on by numSamples of silence, for
+    // blocks the effect skips.
+    void Skip(int numSamples);
+
+private:
+    // Returns the key channel, or its filtered copy written to output.
+    const float *FilterKey(int channel, const float *key, float *output, int numSamples);
+
+    // Swaps the block for the audio lookahead samples before it and keeps
+    // its end for the next block.
+    void Delay(int channel, float *samples, int numSamples, bool keepOutput);
+
+    double mSampleRate = 44100.0;
+    int mNumChannels = 0;
+    int mNumKeyChannels = 0;
+    int mMaxBlockSize = 0;
+
+    Parameters mParameters;
+    float mThreshold = 0.5f;
+    float mSmoothing = 0.8f;
+    float mAttackStep = 1.0f;
+    float mReleaseStep = 1.0f;
+    int mHoldSamples = 0;
+    int mLookahead = 0;
+    int mMaxLookahead = 0;
+
+    // Key filter as a linear trapezoidal state variable filter: the output
+    // mixes input, band pass and low pass by mKeyMix.
+    bool mKeyFilterOn = false;
+    float mKeyA1 = 0.0f, mKeyA2 = 0.0f, mKeyA3 = 0.0f;
+    float mKeyMix[3] = {};
+    std::vector<float> mKeyState1, mKeyState2;
+
+    float mEnvelope = 0.0f;
+    float mGain = 0.0f;
+    int mHoldCountDown = 0;
+
+    // What the last ComputeGain() found for the whole block.
+    bool mAllClosed = false;
+    bool mAllOpen = false;
+
+    // One block of detector and gain curve, and per channel the lookahead
+    // history followed by room for one block.
+    juce::AudioBuffer<float> mDetector;
+    juce::AudioBuffer<float> mGainCurve;
+    juce::AudioBuffer<float> mDelayBuffer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GateEngine)
+};
@@ -0,0 +1,43 @@
+#include "LfoGenerator.h"
+
+void LfoGenerator::Prepare(int maxVoices, int maxBlockSize)
+{
+    mMaxVoices = juce::jmax(1, maxVoices);
+    mMaxBlockSize = juce::jmax(1, maxBlockSize);
+
+    // Voices are padded to whole registers so the kernels never need a tail.
+    mStride = (mMaxBlockSize + mSIMDSize - 1) / mSIMDSize * mSIMDSize;
+    mMemory.calloc((size_t)((mMaxVoices + 1) * mStride + mSIMDSize));
+
+    mRamp = SIMDFloat::getNextSIMDAlignedPtr(mMemory.get());
+    mOutput = mRamp + mStride;
+
+    for (int32_t i = 0; i < mStride; ++i)
+        mRamp[i] = (float)i;
+
+    Reset();
+}
+
+void LfoGenerator::Reset(float phase)
+{
+    mPhase = phase;
+}
+
+void LfoGenerator::Render(Waveform waveform, float phaseIncrement, const float *phaseOffsets, int numVoices, int numSamples)
+{
+    switch (waveform)
+    {
+    case Waveform::SINE:
+        Render<Waveform::SINE>(phaseIncrement, phaseOffsets, numVoices, numSamples);
+        break;
+    case Waveform::TRIANGLE:
+        Render<Waveform::TRIANGLE>(phaseIncrement, phaseOffsets, numVoices, numSamples);
+        break;
+    case Waveform::SWATOOTH:
+        Render<Waveform::SWATOOTH>(phaseIncrement, phaseOffsets, numVoices, numSamples);
+        break;
+    case Waveform::INVERSE_SWATOOTH:
+        Render<Waveform::INVERSE_SWATOOTH>(phaseIncrement, phaseOffsets, numVoices, numSamples);
+        break;
+    }
+}
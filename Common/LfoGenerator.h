@@ -0,0 +1,145 @@
+#pragma once
+#include <JuceHeader.h>
+#include "Utils.h"
+
+// Block-rate LFO shared by the modulation effects.
+//
+// Render() evaluates a whole block for several voices in one call, each voice
+// running at the shared phase plus its own offset, and advances the shared
+// phase. The waveforms are evaluated with SIMD registers: triangle and
+// sawtooths are exact closed forms, the sine is a folded 9th order polynomial
+// with an absolute error below 4e-6 (2e-6 after the 0..1 scaling).
+// Output matches Lfo() in Utils.h, including its 0..1 range.
+class LfoGenerator
+{
+public:
+    LfoGenerator() = default;
+
+    void Prepare(int maxVoices, int maxBlockSize);
+    void Reset(float phase = 0.0f);
+
+    int GetMaxVoices() const { return mMaxVoices; }
+    float GetPhase() const { return mPhase; }
+
+    // phaseIncrement is frequency / sample rate. Offsets are in cycles.
+    // The template is defined here so callers with a fixed waveform get the
+    // kernel inlined.
+    template <Waveform waveform>
+    void Render(float phaseIncrement, const float *phaseOffsets, int numVoices, int numSamples);
+    void Render(Waveform waveform, float phaseIncrement, const float *phaseOffsets, int numVoices, int numSamples);
+
+    // Values rendered by the last Render() call for the given voice.
+    const float *GetVoice(int voice) const { return mOutput + voice * mStride; }
+
+private:
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int mSIMDSize = (int)SIMDFloat::SIMDNumElements;
+
+    template <Waveform waveform>
+    void RenderVoice(float startPhase, float phaseIncrement, float *dest, int numSamples) const;
+
+    // Fractional part of non-negative phases.
+    static SIMDFloat Wrap(SIMDFloat phase);
+
+    // The waveforms in the 0..1 range.
+    static SIMDFloat Sine(SIMDFloat phase);
+    static SIMDFloat Triangle(SIMDFloat phase);
+    static SIMDFloat Sawtooth(SIMDFloat phase);
+    static SIMDFloat InverseSawtooth(SIMDFloat phase);
+
+    juce::HeapBlock<float> mMemory;
+    float *mOutput = nullptr;
+    float *mRamp = nullptr;
+    int32_t mStride = 0;
+    int32_t mMaxVoices = 0;
+    int32_t mMaxBlockSize = 0;
+    float mPhase = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LfoGenerator)
+};
+
+template <Waveform waveform>
+void LfoGenerator::Render(float phaseIncrement, const float *phaseOffsets, int numVoices, int numSamples)
+{
+    jassert(numVoices <= mMaxVoices && numSamples <= mMaxBlockSize);
+
+    for (int32_t voice = 0; voice < numVoices; ++voice)
+    {
+        // Offsets may be negative or above a cycle; keep the start phase in 0..1.
+        float startPhase = mPhase + phaseOffsets[voice];
+        startPhase -= std::floor(startPhase);
+
+        RenderVoice<waveform>(startPhase, phaseIncrement, mOutput + voice * mStride, numSamples);
+    }
+
+    mPhase += phaseIncrement * (float)numSamples;
+    mPhase -= std::floor(mPhase);
+}
+
+template <Waveform waveform>
+void LfoGenerator::RenderVoice(float startPhase, float phaseIncrement, float *dest, int numSamples) const
+{
+    const auto start = SIMDFloat::expand(startPhase);
+    const auto increment = SIMDFloat::expand(phaseIncrement);
+
+    for (int32_t i = 0; i < numSamples; i += mSIMDSize)
+    {
+        // Phase from the sample index rather than a running sum, so long blocks
+        // do not accumulate rounding error.
+        const auto phase = start + SIMDFloat::fromRawArray(mRamp + i) * increment;
+        SIMDFloat out;
+
+        if constexpr (waveform == Waveform::SINE)
+            out = Sine(phase);
+        else if constexpr (waveform == Waveform::TRIANGLE)
+            out = Triangle(phase);
+        else if constexpr (waveform == Waveform::SWATOOTH)
+            out = Sawtooth(phase);
+        else
+            out = InverseSawtooth(phase);
+
+        out.copyToRawArray(dest + i);
+    }
+}
+
+inline LfoGenerator::SIMDFloat LfoGenerator::Wrap(SIMDFloat phase)
+{
+    return phase - SIMDFloat::truncate(phase);
+}
+
+// 0.5 + 0.5 * sin(2 * pi * phase). The phase is folded into a quarter cycle
+// around zero, where the Taylor series up to x^9 is within 4e-6 of sin(x).
+inline LfoGenerator::SIMDFloat LfoGenerator::Sine(SIMDFloat phase)
+{
+    const auto zero = SIMDFloat::expand(0.0f);
+    const auto u = Wrap(phase) - 0.5f;
+    const auto a = SIMDFloat::max(u, zero - u);
+    const auto m = SIMDFloat::min(a, SIMDFloat::expand(0.5f) - a);
+    const auto v = m - ((m * 2.0f) & SIMDFloat::lessThan(u, zero));
+
+    const auto x = v * TWO_PI;
+    const auto x2 = x * x;
+    auto poly = x2 * (1.0f / 362880.0f) + (-1.0f / 5040.0f);
+    poly = x2 * poly + (1.0f / 120.0f);
+    poly = x2 * poly + (-1.0f / 6.0f);
+    poly = x2 * poly + 1.0f;
+
+    // sin(2 * pi * phase) = -sin(2 * pi * v)
+    return SIMDFloat::expand(0.5f) - x * poly * 0.5f;
+}
+
+inline LfoGenerator::SIMDFloat LfoGenerator::Triangle(SIMDFloat phase)
+{
+    const auto t = Wrap(phase + 0.75f) * 2.0f - 1.0f;
+    return SIMDFloat::max(t, SIMDFloat::expand(0.0f) - t);
+}
+
+inline LfoGenerator::SIMDFloat LfoGenerator::Sawtooth(SIMDFloat phase)
+{
+    return Wrap(phase + 0.5f);
+}
+
+inline LfoGenerator::SIMDFloat LfoGenerator::InverseSawtooth(SIMDFloat phase)
+{
+    return SIMDFloat::expand(1.0f) - Wrap(phase + 0.5f);
+}
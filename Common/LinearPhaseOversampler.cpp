@@ -0,0 +1,235 @@
+#include "LinearPhaseOversampler.h"
+#include "ChannelLanes.h"
+
+namespace
+{
+    // Passband edge as a fraction of the original sample rate, and the
+    // rejection of everything that would image or alias into it.
+    constexpr double PASSBAND = 0.4;
+    constexpr double STOPBAND_ATTENUATION = 90.0;
+
+    double BesselI0(double x)
+    {
+        double term = 1.0;
+        double sum = 1.0;
+        for (int k = 1; k < 64 && term > 1.0e-12 * sum; ++k)
+        {
+            const double half = 0.5 * x / (double)k;
+            term *= half * half;
+            sum += term;
+        }
+        return sum;
+    }
+
+    // Stage s runs at 2^(s + 1) times the original rate and has to keep the
+    // passband while rejecting its images, which start at 2^s - PASSBAND.
+    // The length comes from Kaiser's estimate, rounded up to 4 k + 3.
+    int GetHalfLength(int stage)
+    {
+        const double transition = ((double)(1 << stage) - 2.0 * PASSBAND) / (double)(2 << stage);
+        const double taps = std::ceil((STOPBAND_ATTENUATION - 7.95) / (14.36 * transition)) + 1.0;
+        return juce::jmax(1, (int)std::ceil((taps - 3.0) / 4.0));
+    }
+
+    std::vector<float> DesignEvenBranch(int halfLength)
+    {
+        const int centre = 2 * halfLength + 1;
+        const double beta = 0.1102 * (STOPBAND_ATTENUATION - 8.7);
+        const double pi = juce::MathConstants<double>::pi;
+
+        std::vector<double> taps((size_t)halfLength + 1);
+        double sum = 0.0;
+        for (int i = 0; i <= halfLength; ++i)
+        {
+            const double offset = (double)(2 * i - centre);
+            const double ratio = offset / (double)centre;
+            const double window = BesselI0(beta * std::sqrt(1.0 - ratio * ratio)) / BesselI0(beta);
+            taps[(size_t)i] = std::sin(0.5 * pi * offset) / (pi * offset) * window;
+            // Every tap appears twice in the symmetric branch.
+            sum += 2.0 * taps[(size_t)i];
+        }
+
+        std::vector<float> coefficients((size_t)halfLength + 1);
+        for (int i = 0; i <= halfLength; ++i)
+            coefficients[(size_t)i] = (float)(taps[(size_t)i] / sum);
+        return coefficients;
+    }
+}
+
+void LinearPhaseOversampler::Prepare(int numChannels, int numStages, int maxBlockSize)
+{
+    mNumChannels = juce::jmax(1, numChannels);
+    mNumGroups = (mNumChannels + mSIMDSize - 1) / mSIMDSize;
+    mNumStages = juce::jlimit(0, MAX_STAGES, numStages);
+    mMaxBlockSize = juce::jmax(1, maxBlockSize);
+
+    // Delay of the round trip in samples at the top rate: every stage delays
+    // by its centre tap going up and again going down.
+    const int factor = 1 << mNumStages;
+    int topDelay = 0;
+    mStages.resize((size_t)mNumStages);
+    for (int s = 0; s < mNumStages; ++s)
+    {
+        auto &stage = mStages[(size_t)s];
+        stage.halfLength = juce::jmin(MAX_HALF_LENGTH, GetHalfLength(s));
+        stage.coefficients = DesignEvenBranch(stage.halfLength);
+        stage.padding = 0;
+        topDelay += (2 * stage.halfLength + 1) * (factor >> s);
+    }
+
+    if (mNumStages > 0)
+    {
+        mStages.back().padding = (factor - topDelay % factor) % factor;
+        topDelay += mStages.back().padding;
+    }
+    mLatency = topDelay / factor;
+
+    mGroupSize = 0;
+    for (int s = 0; s < mNumStages; ++s)
+    {
+        auto &stage = mStages[(size_t)s];
+        stage.upHistory = 2 * stage.halfLength + 1;
+        stage.downHistory = 4 * stage.halfLength + 2 + stage.padding;
+        stage.upOffset = mGroupSize + stage.upHistory * mSIMDSize;
+        mGroupSize += (stage.upHistory + (mMaxBlockSize << s)) * mSIMDSize;
+        stage.downOffset = mGroupSize + stage.downHistory * mSIMDSize;
+        mGroupSize += (stage.downHistory + (mMaxBlockSize << (s + 1))) * mSIMDSize;
+    }
+
+    mMemorySize = mNumGroups * mGroupSize + mMaxBlockSize * mSIMDSize;
+    mMemory.calloc((size_t)(mMemorySize + mSIMDSize));
+    mBuffers = SIMDFloat::getNextSIMDAlignedPtr(mMemory.get());
+    mScratch = mBuffers + mNumGroups * mGroupSize;
+
+    mOversampled.setSize(mNumChannels, mMaxBlockSize * factor);
+    Reset();
+}
+
+void LinearPhaseOversampler::Reset()
+{
+    if (mBuffers != nullptr)
+        juce::FloatVectorOperations::clear(mBuffers, mMemorySize);
+}
+
+juce::dsp::AudioBlock<float> LinearPhaseOversampler::ProcessUp(const juce::dsp::AudioBlock<float> &block)
+{
+    if (mNumStages == 0)
+        return block;
+
+    const int numChannels = juce::jmin((int)block.getNumChannels(), (int)mNumChannels);
+    const int numSamples = (int)block.getNumSamples();
+    jassert(numSamples <= mMaxBlockSize);
+
+    juce::dsp::AudioBlock<float> oversampled = juce::dsp::AudioBlock<float>(mOversampled)
+                                                   .getSubsetChannelBlock(0, (size_t)numChannels)
+                                                   .getSubBlock(0, (size_t)(numSamples << mNumStages));
+
+    for (int group = 0; group < mNumGroups; ++group)
+    {
+        const int firstChannel = group * mSIMDSize;
+        const int groupChannels = juce::jmin((int)mSIMDSize, numChannels - firstChannel);
+        if (groupChannels <= 0)
+            break;
+
+        ChannelLanes::Interleave(block, firstChannel, groupChannels, 0, numSamples, GetUpInput(group, 0), mSIMDSize);
+
+        // The top stage writes straight into the input of its way down.
+        for (int s = 0; s < mNumStages; ++s)
+        {
+            float *input = GetUpInput(group, s);
+            float *output = s + 1 < mNumStages ? GetUpInput(group, s + 1) : GetDownInput(group, s);
+            Upsample(mStages[(size_t)s], input, numSamples << s, output);
+            KeepHistory(input, numSamples << s, mStages[(size_t)s].upHistory);
+        }
+
+        ChannelLanes::Deinterleave(GetDownInput(group, mNumStages - 1), mSIMDSize, oversampled, firstChannel, groupChannels, 0, numSamples << mNumStages);
+    }
+
+    return oversampled;
+}
+
+void LinearPhaseOversampler::ProcessDown(const juce::dsp::AudioBlock<float> &block)
+{
+    if (mNumStages == 0)
+        return;
+
+    const int numChannels = juce::jmin((int)block.getNumChannels(), (int)mNumChannels);
+    const int numSamples = (int)block.getNumSamples();
+    jassert(numSamples <= mMaxBlockSize);
+
+    const juce::dsp::AudioBlock<float> oversampled(mOversampled);
+
+    for (int group = 0; group < mNumGroups; ++group)
+    {
+        const int firstChannel = group * mSIMDSize;
+        const int groupChannels = juce::jmin((int)mSIMDSize, numChannels - firstChannel);
+        if (groupChannels <= 0)
+            break;
+
+        ChannelLanes::Interleave(oversampled, firstChannel, groupChannels, 0, numSamples << mNumStages, GetDownInput(group, mNumStages - 1), mSIMDSize);
+
+        for (int s = mNumStages - 1; s >= 0; --s)
+        {
+            float *input = GetDownInput(group, s);
+            float *output = s > 0 ? GetDownInput(group, s - 1) : mScratch;
+            Downsample(mStages[(size_t)s], input, numSamples << s, output);
+            KeepHistory(input, numSamples << (s + 1), mStages[(size_t)s].downHistory);
+        }
+
+        ChannelLanes::Deinterleave(mScratch, mSIMDSize, block, firstChannel, groupChannels, 0, numSamples);
+    }
+}
+
+void LinearPhaseOversampler::Upsample(const Stage &stage, const float *input, int numInput, float *output) const
+{
+    // Even outputs run the symmetric branch, odd ones are the centre tap: the
+    // input delayed by halfLength samples.
+    const int halfLength = stage.halfLength;
+    const int last = (2 * halfLength + 1) * mSIMDSize;
+
+    SIMDFloat taps[MAX_HALF_LENGTH + 1];
+    for (int i = 0; i <= halfLength; ++i)
+        taps[i] = SIMDFloat::expand(stage.coefficients[(size_t)i]);
+
+    for (int n = 0; n < numInput; ++n, input += mSIMDSize, output += 2 * mSIMDSize)
+    {
+        auto sum = taps[0] * (SIMDFloat::fromRawArray(input) + SIMDFloat::fromRawArray(input - last));
+        for (int i = 1; i <= halfLength; ++i)
+            sum += taps[i] * (SIMDFloat::fromRawArray(input - i * mSIMDSize) + SIMDFloat::fromRawArray(input - last + i * mSIMDSize));
+
+        sum.copyToRawArray(output);
+        SIMDFloat::fromRawArray(input - halfLength * mSIMDSize).copyToRawArray(output + mSIMDSize);
+    }
+}
+
+void LinearPhaseOversampler::Downsample(const Stage &stage, const float *input, int numOutput, float *output) const
+{
+    // Only the even taps and the centre tap meet a sample that is kept. The
+    // branch sums to one half here, the centre tap is the other half.
+    const int halfLength = stage.halfLength;
+    const int last = (4 * halfLength + 2) * mSIMDSize;
+    const int centre = (2 * halfLength + 1) * mSIMDSize;
+    const auto half = SIMDFloat::expand(0.5f);
+
+    SIMDFloat taps[MAX_HALF_LENGTH + 1];
+    for (int i = 0; i <= halfLength; ++i)
+        taps[i] = SIMDFloat::expand(0.5f * stage.coefficients[(size_t)i]);
+
+    input -= stage.padding * mSIMDSize;
+    for (int n = 0; n < numOutput; ++n, input += 2 * mSIMDSize, output += mSIMDSize)
+    {
+        auto sum = taps[0] * (SIMDFloat::fromRawArray(input) + SIMDFloat::fromRawArray(input - last));
+        for (int i = 1; i <= halfLength; ++i)
+            sum += taps[i] * (SIMDFloat::fromRawArray(input - 2 * i * mSIMDSize) + SIMDFloat::fromRawArray(input - last + 2 * i * mSIMDSize));
+
+        (sum + half * SIMDFloat::fromRawArray(input - centre)).copyToRawArray(output);
+    }
+}
+
+void LinearPhaseOversampler::KeepHistory(float *input, int numInput, int historyLength) const
+{
+    // The newest samples become the history in front of the next block; with
+    // a short block part of them already is history, hence the move.
+    std::memmove(input - historyLength * mSIMDSize, input + (numInput - historyLength) * mSIMDSize,
+                 sizeof(float) * (size_t)(historyLength * mSIMDSize));
+}
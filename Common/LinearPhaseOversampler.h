@@ -0,0 +1,92 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Linear phase oversampling by 2, 4 or 8, for the mixing mode of the
+// distortion, where an exact integer latency the host can compensate matters
+// more than the lowest latency.
+//
+// Every factor of two is a half-band FIR designed with a Kaiser window, run
+// polyphase: going up, the odd outputs are the input delayed and only the even
+// outputs run the filter; going down, only every other output is computed.
+// The half-band filter has zeros at every other tap and is symmetric, so each
+// output costs (length + 1) / 4 multiplies. The first stage has the sharp
+// transition band, later ones run at higher rates with wider transitions and
+// far fewer taps. Channels run in groups of one SIMD register, one channel per
+// lane, like BiquadCascade.
+//
+// The round trip delays the signal by a whole number of samples at the
+// original rate: the top rate stage going down is padded to make it so.
+class LinearPhaseOversampler
+{
+public:
+    static constexpr int MAX_STAGES = 3;
+
+    LinearPhaseOversampler() = default;
+
+    // Oversamples by 2^numStages; with no stages the block passes straight through.
+    void Prepare(int numChannels, int numStages, int maxBlockSize);
+    void Reset();
+
+    int GetFactor() const { return 1 << mNumStages; }
+
+    // Round trip delay in samples at the original rate.
+    int GetLatencySamples() const { return mLatency; }
+
+    // Returns the first channels of the block at the oversampled rate, valid
+    // until the next call. Blocks may not exceed the prepared size.
+    juce::dsp::AudioBlock<float> ProcessUp(const juce::dsp::AudioBlock<float> &block);
+
+    // Takes the block returned by ProcessUp(), however it was processed since,
+    // back down into the given block of the original length.
+    void ProcessDown(const juce::dsp::AudioBlock<float> &block);
+
+private:
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int mSIMDSize = (int)SIMDFloat::SIMDNumElements;
+    static constexpr int MAX_HALF_LENGTH = 16;
+
+    struct Stage
+    {
+        // The filter is 4 * halfLength + 3 taps long.
+        int halfLength = 0;
+        // The first halfLength + 1 taps of the even polyphase branch, which
+        // is symmetric, scaled to sum to one over the whole branch: the gain
+        // going up, where every other input is a stuffed zero.
+        std::vector<float> coefficients;
+        // Extra delay going down, in samples at this stage's input rate.
+        int padding = 0;
+
+        int upHistory = 0;
+        int downHistory = 0;
+        // Within a group's memory.
+        int upOffset = 0;
+        int downOffset = 0;
+    };
+
+    float *GetUpInput(int group, int stage) { return mBuffers + group * mGroupSize + mStages[stage].upOffset; }
+    float *GetDownInput(int group, int stage) { return mBuffers + group * mGroupSize + mStages[stage].downOffset; }
+
+    void Upsample(const Stage &stage, const float *input, int numInput, float *output) const;
+    void Downsample(const Stage &stage, const float *input, int numOutput, float *output) const;
+    void KeepHistory(float *input, int numInput, int historyLength) const;
+
+    std::vector<Stage> mStages;
+    int32_t mNumStages = 0;
+    int32_t mNumChannels = 0;
+    int32_t mNumGroups = 0;
+    int32_t mMaxBlockSize = 0;
+    int32_t mLatency = 0;
+
+    // Per group and stage, lane interleaved input with the history the
+    // filters read in front of it, and one block of scratch at the original
+    // rate. SIMD aligned, sized in Prepare().
+    juce::HeapBlock<float> mMemory;
+    float *mBuffers = nullptr;
+    float *mScratch = nullptr;
+    int mGroupSize = 0;
+    int mMemorySize = 0;
+
+    juce::AudioBuffer<float> mOversampled;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LinearPhaseOversampler)
+};
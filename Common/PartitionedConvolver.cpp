@@ -0,0 +1,577 @@
+#include "PartitionedConvolver.h"
+#include <shared_mutex>
+
+namespace
+{
+    // Partition sizes along the response. The first stage starts right after
+    // the head and runs in the callback; every later stage starts two of its
+    // partitions into the response, which is what gives the worker pool a
+    // whole partition of time to deliver.
+    constexpr int STAGE_PARTITION_SIZES[] = { ConvolutionImpulse::HEAD_SIZE, 1024, 8192 };
+    constexpr int STAGE_STARTS[] = { ConvolutionImpulse::HEAD_SIZE, 2 * 1024, 2 * 8192 };
+    constexpr int NUM_STAGES = (int)std::size(STAGE_PARTITION_SIZES);
+
+    // Blocks a late tail stage keeps for its next job before it gives up on
+    // them and starts over.
+    constexpr int MAX_BACKLOG = 4;
+
+    // How often an idle worker looks for queued jobs. Small next to the
+    // 1024 samples the first tail stage has to deliver in.
+    constexpr int WORKER_POLL_MS = 1;
+
+    // juce::dsp::FFT works on interleaved complex values; the spectra are kept
+    // split into real and imaginary parts so the multiply-accumulate vectorises.
+    void Deinterleave(const float *interleaved, float *split, int numBins)
+    {
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            split[bin] = interleaved[2 * bin];
+            split[numBins + bin] = interleaved[2 * bin + 1];
+        }
+    }
+
+    // Fills in the negative frequencies as well, which the inverse transform reads.
+    void InterleaveSymmetric(const float *split, float *interleaved, int numBins)
+    {
+        const int fftSize = 2 * (numBins - 1);
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            interleaved[2 * bin] = split[bin];
+            interleaved[2 * bin + 1] = split[numBins + bin];
+        }
+        for (int bin = numBins; bin < fftSize; ++bin)
+        {
+            interleaved[2 * bin] = split[fftSize - bin];
+            interleaved[2 * bin + 1] = -split[numBins + fftSize - bin];
+        }
+    }
+}
+
+std::shared_ptr<const ConvolutionImpulse> ConvolutionImpulse::Create(const juce::AudioBuffer<float> &response, double sampleRate)
+{
+    std::shared_ptr<ConvolutionImpulse> impulse(new ConvolutionImpulse());
+    impulse->mNumChannels = juce::jmax(1, response.getNumChannels());
+    impulse->mLength = response.getNumSamples();
+    impulse->mSampleRate = sampleRate;
+
+    auto getSample = [&response](int channel, int index)
+    {
+        return channel < response.getNumChannels() && index < response.getNumSamples() ? response.getSample(channel, index) : 0.0f;
+    };
+
+    impulse->mHead.resize((size_t)(impulse->mNumChannels * HEAD_SIZE));
+    for (int channel = 0; channel < impulse->mNumChannels; ++channel)
+        for (int tap = 0; tap < HEAD_SIZE; ++tap)
+            impulse->mHead[(size_t)(channel * HEAD_SIZE + HEAD_SIZE - 1 - tap)] = getSample(channel, tap);
+
+    for (int index = 0; index < NUM_STAGES && STAGE_STARTS[index] < impulse->mLength; ++index)
+    {
+        const int start = STAGE_STARTS[index];
+        const int end = index + 1 < NUM_STAGES ? juce::jmin(impulse->mLength, STAGE_STARTS[index + 1]) : impulse->mLength;
+
+        Stage stage;
+        stage.partitionSize = STAGE_PARTITION_SIZES[index];
+        stage.numPartitions = (end - start + stage.partitionSize - 1) / stage.partitionSize;
+        stage.numBins = stage.partitionSize + 1;
+        stage.background = index > 0;
+        stage.spectra.resize((size_t)(impulse->mNumChannels * stage.numPartitions * 2 * stage.numBins));
+
+        const int fftSize = 2 * stage.partitionSize;
+        juce::dsp::FFT fft(juce::roundToInt(std::log2(fftSize)));
+        std::vector<float> buffer((size_t)(2 * fftSize));
+
+        for (int channel = 0; channel < impulse->mNumChannels; ++channel)
+        {
+            for (int partition = 0; partition < stage.numPartitions; ++partition)
+            {
+                // Zero padded to twice its length, for overlap-save.
+                std::fill(buffer.begin(), buffer.end(), 0.0f);
+                const int offset = start + partition * stage.partitionSize;
+                for (int i = 0; i < stage.partitionSize && offset + i < end; ++i)
+                    buffer[(size_t)i] = getSample(channel, offset + i);
+
+                fft.performRealOnlyForwardTransform(buffer.data(), true);
+                Deinterleave(buffer.data(), stage.GetSpectrum(channel, partition), stage.numBins);
+            }
+        }
+
+        impulse->mStages.push_back(std::move(stage));
+    }
+
+    return impulse;
+}
+
+
+//==============================================================================
+struct PartitionedConvolver::Stage
+{
+    enum JobState
+    {
+        JOB_IDLE = 0,
+        JOB_QUEUED,
+        JOB_RUNNING,
+        JOB_DONE
+    };
+
+    Stage(const ConvolutionImpulse::Stage &impulseStage, int numChannels)
+        : impulse(impulseStage), fft(juce::roundToInt(std::log2(2 * impulseStage.partitionSize)))
+    {
+        const int size = impulse.partitionSize;
+        input.setSize(numChannels, size);
+        backlog.setSize(numChannels, MAX_BACKLOG * size);
+        jobInput.setSize(numChannels, MAX_BACKLOG * size);
+        previous.setSize(numChannels, size);
+        outputs[0].setSize(numChannels, size);
+        outputs[1].setSize(numChannels, size);
+        delayLine.resize((size_t)(numChannels * impulse.numPartitions * 2 * impulse.numBins));
+        fftBuffer.resize((size_t)(4 * size));
+        accumulator.resize((size_t)(2 * impulse.numBins));
+    }
+
+    float *GetDelayLineSpectrum(int channel, int slot) { return delayLine.data() + (size_t)(channel * impulse.numPartitions + slot) * 2 * impulse.numBins; }
+
+    // Switches the callback to the output of a finished job.
+    bool TakeOutput()
+    {
+        if (state.load(std::memory_order_acquire) != JOB_DONE)
+            return false;
+
+        currentOutput = jobOutput;
+        state.store(JOB_IDLE, std::memory_order_relaxed);
+        overdue = false;
+        return true;
+    }
+
+    const ConvolutionImpulse::Stage &impulse;
+    juce::dsp::FFT fft;
+
+    // Written by the callback; a worker reads the jobBlocks blocks in
+    // jobInput, oldest first, and writes outputs[jobOutput]. With jobRestart
+    // it clears the delay line first.
+    juce::AudioBuffer<float> input, jobInput, previous;
+    juce::AudioBuffer<float> outputs[2];
+    int currentOutput = 0;
+    int jobOutput = 1;
+    int jobBlocks = 0;
+    bool jobRestart = false;
+    int filled = 0;
+
+    // Spectra of the last numPartitions input blocks, newest at delayLineIndex.
+    std::vector<float> delayLine;
+    int delayLineIndex = 0;
+    std::vector<float> fftBuffer;
+    std::vector<float> accumulator;
+
+    // The callback queues a job and takes its output once it is done, a
+    // worker claims and runs it in between. Everything else above belongs to
+    // whichever side the state says.
+    std::atomic<int> state{ JOB_IDLE };
+    juce::WaitableEvent done;
+
+    // Only touched by the callback: the output due for this partition is
+    // still being computed, and backlog holds the blocks for the next job.
+    bool overdue = false;
+    juce::AudioBuffer<float> backlog;
+    int backlogBlocks = 0;
+    bool restart = false;
+};
+
+//==============================================================================
+// A few threads run the tail stages of every convolver, rather than a thread
+// per instance. It lives as long as some convolver holds on to it.
+class PartitionedConvolver::WorkerPool
+{
+public:
+    static constexpr int MAX_WORKERS = 4;
+
+    static std::shared_ptr<WorkerPool> GetInstance()
+    {
+        static std::mutex mutex;
+        static std::weak_ptr<WorkerPool> instance;
+
+        const std::lock_guard<std::mutex> lock(mutex);
+        auto pool = instance.lock();
+        if (pool == nullptr)
+        {
+            pool = std::make_shared<WorkerPool>();
+            instance = pool;
+        }
+        return pool;
+    }
+
+    WorkerPool()
+    {
+        const int numWorkers = juce::jlimit(1, MAX_WORKERS, juce::SystemStats::getNumCpus() / 2);
+        for (int index = 0; index < numWorkers; ++index)
+        {
+            mWorkers.push_back(std::make_unique<Worker>(*this));
+            mWorkers.back()->startThread(juce::Thread::Priority::high);
+        }
+    }
+
+    ~WorkerPool()
+    {
+        // Wake the workers from their poll to see the exit flag.
+        for (auto &worker : mWorkers)
+        {
+            worker->signalThreadShouldExit();
+            worker->notify();
+        }
+        for (auto &worker : mWorkers)
+            worker->stopThread(1000);
+    }
+
+    // Not for the audio thread. Remove() returns once no worker is running a
+    // job of the convolver any more.
+    void Add(PartitionedConvolver *convolver)
+    {
+        const std::unique_lock<std::shared_mutex> lock(mMutex);
+        mConvolvers.push_back(convolver);
+    }
+
+    void Remove(PartitionedConvolver *convolver)
+    {
+        const std::unique_lock<std::shared_mutex> lock(mMutex);
+        mConvolvers.erase(std::remove(mConvolvers.begin(), mConvolvers.end(), convolver), mConvolvers.end());
+    }
+
+    // Called by the callback after queuing a job. Only an atomic add: waking
+    // a thread takes a lock, so the workers poll for it instead.
+    void Notify()
+    {
+        mQueuedJobs.fetch_add(1, std::memory_order_release);
+    }
+
+private:
+    class Worker : public juce::Thread
+    {
+    public:
+        explicit Worker(WorkerPool &pool)
+            : juce::Thread("Convolution tail"), mPool(pool)
+        {
+        }
+
+        void run() override
+        {
+            while (!threadShouldExit())
+            {
+                if (mPool.TakeQueuedJob())
+                    mPool.RunQueuedStages();
+                else
+                    wait(WORKER_POLL_MS);
+            }
+        }
+
+    private:
+        WorkerPool &mPool;
+    };
+
+    // One worker per queued job goes looking, so jobs queued together run
+    // side by side.
+    bool TakeQueuedJob()
+    {
+        int queued = mQueuedJobs.load(std::memory_order_acquire);
+        while (queued > 0)
+            if (mQueuedJobs.compare_exchange_weak(queued, queued - 1, std::memory_order_acquire))
+                return true;
+        return false;
+    }
+
+    void RunQueuedStages()
+    {
+        const std::shared_lock<std::shared_mutex> lock(mMutex);
+        for (bool ranAny = true; ranAny;)
+        {
+            ranAny = false;
+            for (auto *convolver : mConvolvers)
+                ranAny = convolver->RunQueuedStage() || ranAny;
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    std::atomic<int> mQueuedJobs{ 0 };
+
+    // The workers only read the list, so they run jobs side by side.
+    std::shared_mutex mMutex;
+    std::vector<PartitionedConvolver *> mConvolvers;
+};
+
+//==============================================================================
+PartitionedConvolver::PartitionedConvolver() = default;
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+    LeavePool();
+}
+
+void PartitionedConvolver::Prepare(std::shared_ptr<const ConvolutionImpulse> impulse, int numChannels)
+{
+    LeavePool();
+
+    mImpulse = std::move(impulse);
+    mNumChannels = numChannels;
+    mHistory.setSize(numChannels, 2 * ConvolutionImpulse::HEAD_SIZE - 1);
+
+    mStages.clear();
+    bool anyBackground = false;
+    for (const auto &impulseStage : mImpulse->mStages)
+    {
+        mStages.push_back(std::make_unique<Stage>(impulseStage, numChannels));
+        anyBackground = anyBackground || impulseStage.background;
+    }
+
+    Reset();
+
+    if (anyBackground)
+    {
+        mPool = WorkerPool::GetInstance();
+        mPool->Add(this);
+    }
+}
+
+void PartitionedConvolver::Reset()
+{
+    for (auto &stage : mStages)
+    {
+        WaitForStage(*stage);
+
+        stage->previous.clear();
+        stage->outputs[0].clear();
+        stage->outputs[1].clear();
+        std::fill(stage->delayLine.begin(), stage->delayLine.end(), 0.0f);
+        stage->delayLineIndex = 0;
+        stage->currentOutput = 0;
+        stage->filled = 0;
+        stage->state.store(Stage::JOB_IDLE, std::memory_order_relaxed);
+        stage->overdue = false;
+        stage->backlogBlocks = 0;
+        stage->restart = false;
+    }
+
+    mHistory.clear();
+}
+
+void PartitionedConvolver::Process(const juce::dsp::AudioBlock<float> &block)
+{
+    jassert(mImpulse != nullptr && (int)block.getNumChannels() >= mNumChannels);
+
+    const int numSamples = (int)block.getNumSamples();
+    int offset = 0;
+
+    while (offset < numSamples)
+    {
+        // Every partition size is a multiple of the head, so chunks that end on
+        // a head boundary never straddle the end of a partition.
+        const int filled = mStages.empty() ? 0 : mStages.front()->filled;
+        const int chunk = juce::jmin(numSamples - offset, ConvolutionImpulse::HEAD_SIZE - filled % ConvolutionImpulse::HEAD_SIZE);
+
+        ProcessChunk(block, offset, chunk);
+        offset += chunk;
+    }
+}
+
+void PartitionedConvolver::ProcessChunk(const juce::dsp::AudioBlock<float> &block, int offset, int numSamples)
+{
+    constexpr int headSize = ConvolutionImpulse::HEAD_SIZE;
+
+    // A late job's output takes over from where the partition has got to as
+    // soon as it is done, and the blocks that waited for it are handed over.
+    for (auto &stage : mStages)
+    {
+        if (stage->overdue && stage->TakeOutput() && stage->backlogBlocks > 0)
+            SubmitStage(*stage);
+    }
+
+    for (int channel = 0; channel < mNumChannels; ++channel)
+    {
+        float *data = block.getChannelPointer((size_t)channel) + offset;
+        float *history = mHistory.getWritePointer(channel);
+        const float *head = mImpulse->mHead.data() + (channel % mImpulse->mNumChannels) * headSize;
+
+        juce::FloatVectorOperations::copy(history + headSize - 1, data, numSamples);
+        for (auto &stage : mStages)
+            juce::FloatVectorOperations::copy(stage->input.getWritePointer(channel, stage->filled), data, numSamples);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const float *window = history + sample;
+            float sum = 0.0f;
+            for (int tap = 0; tap < headSize; ++tap)
+                sum += head[tap] * window[tap];
+            data[sample] = sum;
+        }
+
+        for (auto &stage : mStages)
+            juce::FloatVectorOperations::add(data, stage->outputs[stage->currentOutput].getReadPointer(channel, stage->filled), numSamples);
+
+        std::memmove(history, history + numSamples, (size_t)(headSize - 1) * sizeof(float));
+    }
+
+    for (auto &stage : mStages)
+    {
+        stage->filled += numSamples;
+        if (stage->filled < stage->impulse.partitionSize)
+            continue;
+
+        stage->filled = 0;
+
+        if (stage->impulse.background)
+            EndPartition(*stage);
+        else
+            ComputeStage(*stage, stage->input, 0, &stage->outputs[0]);
+    }
+}
+
+void PartitionedConvolver::EndPartition(Stage &stage)
+{
+    if (mNonRealtime)
+        WaitForStage(stage);
+
+    // The job handed over one partition ago holds the output from here on.
+    stage.TakeOutput();
+
+    // Every block has to reach the delay line, in order, or the tail comes
+    // out of step with the input until the line has filled again. A full
+    // backlog is dropped and the stage starts over from silence instead.
+    if (stage.backlogBlocks == MAX_BACKLOG)
+    {
+        stage.backlogBlocks = 0;
+        stage.restart = true;
+    }
+
+    const int size = stage.impulse.partitionSize;
+    for (int channel = 0; channel < mNumChannels; ++channel)
+        stage.backlog.copyFrom(channel, stage.backlogBlocks * size, stage.input, channel, 0, size);
+    ++stage.backlogBlocks;
+
+    // Until the job in flight is done the previous output plays again.
+    if (stage.state.load(std::memory_order_acquire) == Stage::JOB_IDLE)
+        SubmitStage(stage);
+    else
+        stage.overdue = true;
+}
+
+void PartitionedConvolver::SubmitStage(Stage &stage)
+{
+    const int length = stage.backlogBlocks * stage.impulse.partitionSize;
+    for (int channel = 0; channel < mNumChannels; ++channel)
+        stage.jobInput.copyFrom(channel, 0, stage.backlog, channel, 0, length);
+
+    stage.jobBlocks = stage.backlogBlocks;
+    stage.jobRestart = stage.restart;
+    stage.backlogBlocks = 0;
+    stage.restart = false;
+
+    stage.jobOutput = stage.currentOutput ^ 1;
+    stage.state.store(Stage::JOB_QUEUED, std::memory_order_release);
+    mPool->Notify();
+}
+
+// Without an output, only brings the delay line up to date with the block.
+void PartitionedConvolver::ComputeStage(Stage &stage, const juce::AudioBuffer<float> &input, int offset, juce::AudioBuffer<float> *output)
+{
+    const auto &impulse = stage.impulse;
+    const int size = impulse.partitionSize;
+    const int numBins = impulse.numBins;
+    float *buffer = stage.fftBuffer.data();
+    float *accumulatorReal = stage.accumulator.data();
+    float *accumulatorImag = accumulatorReal + numBins;
+
+    for (int channel = 0; channel < mNumChannels; ++channel)
+    {
+        // Overlap-save: transform the previous block and this one together.
+        const float *block = input.getReadPointer(channel, offset);
+        float *previous = stage.previous.getWritePointer(channel);
+        juce::FloatVectorOperations::copy(buffer, previous, size);
+        juce::FloatVectorOperations::copy(buffer + size, block, size);
+        juce::FloatVectorOperations::clear(buffer + 2 * size, 2 * size);
+        juce::FloatVectorOperations::copy(previous, block, size);
+
+        stage.fft.performRealOnlyForwardTransform(buffer, true);
+        Deinterleave(buffer, stage.GetDelayLineSpectrum(channel, stage.delayLineIndex), numBins);
+
+        if (output == nullptr)
+            continue;
+
+        std::fill(stage.accumulator.begin(), stage.accumulator.end(), 0.0f);
+        const int responseChannel = channel % mImpulse->mNumChannels;
+
+        for (int partition = 0; partition < impulse.numPartitions; ++partition)
+        {
+            int slot = stage.delayLineIndex - partition;
+            if (slot < 0)
+                slot += impulse.numPartitions;
+
+            const float *inputReal = stage.GetDelayLineSpectrum(channel, slot);
+            const float *inputImag = inputReal + numBins;
+            const float *responseReal = impulse.GetSpectrum(responseChannel, partition);
+            const float *responseImag = responseReal + numBins;
+
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                accumulatorReal[bin] += inputReal[bin] * responseReal[bin] - inputImag[bin] * responseImag[bin];
+                accumulatorImag[bin] += inputReal[bin] * responseImag[bin] + inputImag[bin] * responseReal[bin];
+            }
+        }
+
+        InterleaveSymmetric(accumulatorReal, buffer, numBins);
+        stage.fft.performRealOnlyInverseTransform(buffer);
+        juce::FloatVectorOperations::copy(output->getWritePointer(channel), buffer + size, size);
+    }
+
+    if (++stage.delayLineIndex == impulse.numPartitions)
+        stage.delayLineIndex = 0;
+}
+
+void PartitionedConvolver::WaitForStage(Stage &stage)
+{
+    // A queued job always gets run: jobs are only queued while in the pool.
+    for (;;)
+    {
+        const int state = stage.state.load(std::memory_order_acquire);
+        if (state == Stage::JOB_IDLE || state == Stage::JOB_DONE)
+            return;
+
+        stage.done.wait(-1);
+    }
+}
+
+void PartitionedConvolver::LeavePool()
+{
+    if (mPool == nullptr)
+        return;
+
+    // No worker touches the stages after this, whatever was still queued is dropped.
+    mPool->Remove(this);
+    mPool.reset();
+}
+
+bool PartitionedConvolver::RunQueuedStage()
+{
+    // Smaller partitions are due sooner, and the stages are in order of size.
+    for (auto &stage : mStages)
+    {
+        int expected = Stage::JOB_QUEUED;
+        if (!stage->state.compare_exchange_strong(expected, Stage::JOB_RUNNING, std::memory_order_acquire))
+            continue;
+
+        if (stage->jobRestart)
+        {
+            std::fill(stage->delayLine.begin(), stage->delayLine.end(), 0.0f);
+            stage->previous.clear();
+        }
+
+        // Only the newest block's output is still due.
+        for (int block = 0; block < stage->jobBlocks; ++block)
+        {
+            auto *output = block + 1 == stage->jobBlocks ? &stage->outputs[stage->jobOutput] : nullptr;
+            ComputeStage(*stage, stage->jobInput, block * stage->impulse.partitionSize, output);
+        }
+
+        stage->state.store(Stage::JOB_DONE, std::memory_order_release);
+        stage->done.signal();
+        return true;
+    }
+
+    return false;
+}
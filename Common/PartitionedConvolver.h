@@ -0,0 +1,121 @@
+#pragma once
+#include <JuceHeader.h>
+
+// An impulse response cut into the partitions a PartitionedConvolver runs,
+// with the spectrum of every partition computed up front. It never changes
+// once created, so every convolver using the same response at the same rate
+// can share one copy.
+//
+// The partitioning is non-uniform. The first HEAD_SIZE taps are convolved
+// directly in the time domain, which adds no latency. The rest is split into
+// stages of uniformly partitioned FFT convolution whose partitions grow along
+// the response: small ones right after the head, where results are needed
+// immediately, and large ones for the tail, which is cheaper per sample and
+// has enough slack to be computed on a worker thread.
+class ConvolutionImpulse
+{
+public:
+    static constexpr int HEAD_SIZE = 64;
+
+    // The response is used at the sample rate it is given in.
+    static std::shared_ptr<const ConvolutionImpulse> Create(const juce::AudioBuffer<float> &response, double sampleRate);
+
+    int GetNumChannels() const { return mNumChannels; }
+    int GetLength() const { return mLength; }
+    double GetSampleRate() const { return mSampleRate; }
+
+private:
+    friend class PartitionedConvolver;
+
+    struct Stage
+    {
+        int partitionSize = 0;
+        int numPartitions = 0;
+        int numBins = 0;
+
+        // Computed by the worker pool rather than in the audio callback.
+        bool background = false;
+
+        // Per channel and partition: numBins real parts, then numBins imaginary parts.
+        std::vector<float> spectra;
+
+        const float *GetSpectrum(int channel, int partition) const { return spectra.data() + (size_t)(channel * numPartitions + partition) * 2 * numBins; }
+        float *GetSpectrum(int channel, int partition) { return spectra.data() + (size_t)(channel * numPartitions + partition) * 2 * numBins; }
+    };
+
+    ConvolutionImpulse() = default;
+
+    int mNumChannels = 0;
+    int mLength = 0;
+    double mSampleRate = 0.0;
+
+    // Per channel, time reversed so the direct convolution reads forwards.
+    std::vector<float> mHead;
+    std::vector<Stage> mStages;
+
+    JUCE_DECLARE_NON_COPYABLE(ConvolutionImpulse)
+};
+
+// Zero latency convolution of long impulse responses.
+//
+// The head of the response runs directly, the first stage of FFT partitions
+// runs in the audio callback whenever HEAD_SIZE new samples are in, and the
+// tail stages run on a small pool of worker threads shared by every
+// convolver in the process. A tail stage with partitions of P samples starts
+// 2P samples into the response, so it is handed a block of input P samples
+// before its output is due. The hand-over is an atomic state per stage that
+// the workers poll, so the callback never locks, waits or signals: a stage
+// that is late keeps playing the previous partition's result until the job is
+// done, and the blocks that came in meanwhile are handed over then, all in one
+// job, so the stage's delay line stays in step with the input. A stage that
+// falls so far behind that its backlog is full starts over from silence
+// rather than play a tail out of step. Any block size works, the work is
+// spread evenly over the callbacks.
+class PartitionedConvolver
+{
+public:
+    PartitionedConvolver();
+    ~PartitionedConvolver();
+
+    // Allocates everything the callback needs and joins the worker pool if the
+    // response has tail stages. Channel c is convolved with channel
+    // c % impulse->GetNumChannels() of the response.
+    void Prepare(std::shared_ptr<const ConvolutionImpulse> impulse, int numChannels);
+
+    // Waits for the jobs in flight, so it is not for the audio thread.
+    void Reset();
+
+    const ConvolutionImpulse *GetImpulse() const { return mImpulse.get(); }
+
+    // When rendering faster than real time a late stage is waited for instead,
+    // so the result does not depend on how busy the workers are.
+    void SetNonRealtime(bool nonRealtime) { mNonRealtime = nonRealtime; }
+
+    // Convolves the first numChannels channels of the block in place.
+    void Process(const juce::dsp::AudioBlock<float> &block);
+
+private:
+    struct Stage;
+    class WorkerPool;
+
+    void ProcessChunk(const juce::dsp::AudioBlock<float> &block, int offset, int numSamples);
+    void ComputeStage(Stage &stage, const juce::AudioBuffer<float> &input, int offset, juce::AudioBuffer<float> *output);
+    void EndPartition(Stage &stage);
+    void SubmitStage(Stage &stage);
+    void WaitForStage(Stage &stage);
+    void LeavePool();
+
+    // Called by the pool: runs one queued tail stage, if there is one.
+    bool RunQueuedStage();
+
+    std::shared_ptr<const ConvolutionImpulse> mImpulse;
+    int mNumChannels = 0;
+    bool mNonRealtime = false;
+
+    // Per channel: the last HEAD_SIZE - 1 input samples, then the chunk being convolved.
+    juce::AudioBuffer<float> mHistory;
+    std::vector<std::unique_ptr<Stage>> mStages;
+    std::shared_ptr<WorkerPool> mPool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartitionedConvolver)
+};
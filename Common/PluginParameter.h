@@ -1,29 +1,103 @@
 #pragma once
 #include <JuceHeader.h>
+
+// Mappings from the value the host sets to the value the DSP code reads.
+// They are applied on the audio thread, when a pending change is pulled in.
+struct ParameterIdentity
+{
+    float operator()(float value) const { return value; }
+};
+
+struct ParameterMillisecondsToSeconds
+{
+    float operator()(float value) const { return value * 0.001f; }
+};
+
+// Shifts a choice index, e.g. so the first item of a voice count reads as 2.
+template <int offset>
+struct ParameterOffset
+{
+    float operator()(float value) const { return value + (float)offset; }
+};
+
+// A toggle as a sign: +1 when off, -1 when on.
+struct ParameterToggleToSign
+{
+    float operator()(float value) const { return value * (-2.0f) + 1.0f; }
+};
+
+// A smoothed parameter fed by an AudioProcessorValueTreeState.
+//
+// parameterChanged() may run on any thread, so it only stores the raw host
+// value in an atomic slot. The audio thread calls Update() once per block,
+// which maps the pending value and makes it the smoother's target; the
+// smoother state is never touched from another thread. RenderRamp() then
+// gives the DSP code one value per sample.
+template <typename Mapping = ParameterIdentity>
 class PluginParameter
     : public juce::LinearSmoothedValue<float>,
       public juce::AudioProcessorValueTreeState::Listener
 {
 public:
-    PluginParameter(juce::AudioProcessorValueTreeState &apvts, const std::function<float(float)> callback = nullptr)
-        : apvts(apvts), callback(callback)
+    PluginParameter(juce::AudioProcessorValueTreeState &apvts)
+        : apvts(apvts)
     {
     }
 
-    void UpdateValue(float value)
+    void Update()
     {
-        if (callback != nullptr)
-            setCurrentAndTargetValue(callback(value));
-        else
-            setCurrentAndTargetValue(value);
+        if (mPending.exchange(false, std::memory_order_acquire))
+            setTargetValue(mMapping(mPendingValue.load(std::memory_order_relaxed)));
+    }
+
+    // Writes the next numSamples smoothed values to dest and advances the
+    // smoother. Returns true when the value is not moving; dest is then just
+    // filled with it and callers may use getTargetValue() instead.
+    bool RenderRamp(float *dest, int numSamples)
+    {
+        if (!isSmoothing())
+        {
+            juce::FloatVectorOperations::fill(dest, getTargetValue(), numSamples);
+            return true;
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = getNextValue();
+        return false;
+    }
+
+    // The latest value from the host, mapped. Unlike the smoother it may be
+    // read from any thread, e.g. by getTailLengthSeconds().
+    float GetHostValue() const
+    {
+        return mMapping(mPendingValue.load(std::memory_order_relaxed));
     }
 
     void parameterChanged(const juce::String &parameterID, float newValue) override
     {
-        UpdateValue(newValue);
+        mPendingValue.store(newValue, std::memory_order_relaxed);
+        mPending.store(true, std::memory_order_release);
     }
 
     juce::AudioProcessorValueTreeState &apvts;
 
-    std::function<float(float)> callback;
+protected:
+    // Sets the default during construction, before the audio thread runs.
+    void SetInitialValue(float value)
+    {
+        mPendingValue.store(value, std::memory_order_relaxed);
+        setCurrentAndTargetValue(mMapping(value));
+    }
+
+private:
+    const Mapping mMapping{};
+    std::atomic<float> mPendingValue{0.0f};
+    std::atomic<bool> mPending{false};
 };
+
+// Pulls the pending host changes of several parameters, once per block.
+template <typename... Parameters>
+void UpdateParameters(Parameters &...parameters)
+{
+    (parameters.Update(), ...);
+}
@@ -1,15 +1,15 @@
 #pragma once
 #include "PluginParameter.h"
-class PluginParameterComboBox : public PluginParameter
+template <typename Mapping = ParameterIdentity>
+class PluginParameterComboBox : public PluginParameter<Mapping>
 {
 public:
     PluginParameterComboBox(juce::AudioProcessorValueTreeState &apvts,
                           const juce::String &paramName,
                           const juce::String &label,
                           const juce::StringArray &items,
-                          const int defaultChoice = 0,
-                          const std::function<float(const float)> callback = nullptr)
-        : PluginParameter(apvts, callback),
+                          const int defaultChoice = 0)
+        : PluginParameter<Mapping>(apvts),
           paramName(paramName),
           items(items),
           defaultChoice(defaultChoice)
@@ -28,10 +28,10 @@ public:
             { return items.indexOf(text); }));
 
         apvts.addParameterListener(paramID, this);
-        UpdateValue(defaultChoice);
+        this->SetInitialValue((float)defaultChoice);
     }
 
-    const juce::String &paramName;
+    const juce::String paramName;
     const juce::StringArray items;
     const int defaultChoice;
 };
\ No newline at end of file
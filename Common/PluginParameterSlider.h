@@ -1,6 +1,7 @@
 #pragma once
 #include "PluginParameter.h"
-class PluginParameterSlider : public PluginParameter
+template <typename Mapping = ParameterIdentity>
+class PluginParameterSlider : public PluginParameter<Mapping>
 {
 public:
     PluginParameterSlider(juce::AudioProcessorValueTreeState &apvts,
@@ -9,9 +10,8 @@ public:
                           float minValue,
                           float maxValue,
                           float defaultValue,
-                          std::function<float(float)> callback = nullptr,
                           bool logarithmic = false)
-        : PluginParameter(apvts, callback), paramName(paramName), labelText(labelText), minValue(minValue), maxValue(maxValue), defaultValue(defaultValue)
+        : PluginParameter<Mapping>(apvts), paramName(paramName), labelText(labelText), minValue(minValue), maxValue(maxValue), defaultValue(defaultValue)
 
     {
         auto paramID = paramName.removeCharacters(" ").toLowerCase();
@@ -33,11 +33,11 @@ public:
             { return text.getFloatValue(); }));
 
         apvts.addParameterListener(paramID, this);
-        UpdateValue(defaultValue);
+        this->SetInitialValue(defaultValue);
     }
 
-    const juce::String &paramName;
-    const juce::String &labelText;
+    const juce::String paramName;
+    const juce::String labelText;
     const float minValue;
     const float maxValue;
     const float defaultValue;
@@ -1,14 +1,14 @@
 #pragma once
 #include "PluginParameter.h"
-class PluginParameterToggle : public PluginParameter
+template <typename Mapping = ParameterIdentity>
+class PluginParameterToggle : public PluginParameter<Mapping>
 {
 public:
     PluginParameterToggle(juce::AudioProcessorValueTreeState &apvts,
                           const juce::String &paramName,
                           const juce::String &label="",
-                          const bool defaultState = false,
-                          const std::function<float(float)> callback = nullptr)
-        : PluginParameter(apvts, callback),
+                          const bool defaultState = false)
+        : PluginParameter<Mapping>(apvts),
           paramName(paramName),
           defaultState(defaultState)
     {
@@ -26,9 +26,9 @@ public:
             { return toggleStates.indexOf(text); }));
 
         apvts.addParameterListener(paramID, this);
-        UpdateValue(defaultState);
+        this->SetInitialValue(defaultState ? 1.0f : 0.0f);
     }
 
-    const juce::String &paramName;
+    const juce::String paramName;
     const bool defaultState;
 };
\ No newline at end of file
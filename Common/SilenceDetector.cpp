@@ -0,0 +1,83 @@
+#include "SilenceDetector.h"
+
+namespace
+{
+    // How far every tail has to fall, as a natural log: ln(1 / SILENCE_THRESHOLD).
+    const double SILENCE_DEPTH = -std::log((double)SilenceDetector::SILENCE_THRESHOLD);
+}
+
+void SilenceDetector::Prepare(double sampleRate)
+{
+    mSampleRate = sampleRate;
+    Reset();
+}
+
+void SilenceDetector::Reset()
+{
+    mSilentSamples = 0;
+    mSleeping = false;
+}
+
+bool SilenceDetector::Process(juce::AudioBuffer<float> &buffer, int numChannels, double tailSeconds, float maxGain)
+{
+    if (!IsSilent(buffer, numChannels, SILENCE_THRESHOLD / juce::jmax(1.0f, maxGain)))
+    {
+        Reset();
+        return false;
+    }
+
+    // Compared before this block is counted: the samples already processed
+    // have to cover the tail. An infinite tail never compares true.
+    mSleeping = (double)mSilentSamples >= tailSeconds * mSampleRate && mSilentSamples > 0;
+    mSilentSamples += buffer.getNumSamples();
+
+    if (mSleeping)
+        for (int channel = 0; channel < numChannels; ++channel)
+            buffer.clear(channel, 0, buffer.getNumSamples());
+
+    return mSleeping;
+}
+
+bool SilenceDetector::IsSilent(const juce::AudioBuffer<float> &buffer, int numChannels, float threshold)
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(channel), buffer.getNumSamples());
+        if (range.getStart() < -threshold || range.getEnd() > threshold)
+            return false;
+    }
+    return true;
+}
+
+double SilenceDetector::FeedbackTail(double periodSeconds, double feedback)
+{
+    if (periodSeconds <= 0.0)
+        return 0.0;
+    if (feedback >= 1.0)
+        return std::numeric_limits<double>::infinity();
+
+    // The echo after the last audible one still has to come out.
+    const double passes = feedback > 0.0 ? std::ceil(SILENCE_DEPTH / -std::log(feedback)) : 0.0;
+    return periodSeconds * (passes + 1.0);
+}
+
+double SilenceDetector::DecayTail(double t60Seconds)
+{
+    return t60Seconds * SILENCE_DEPTH / std::log(1000.0);
+}
+
+double SilenceDetector::ResonanceTail(double frequency, double q)
+{
+    // The poles of a resonance sit at radius exp(-pi f / (q fs)), so the
+    // envelope falls as exp(-pi f t / q), whatever the sample rate.
+    if (frequency <= 0.0)
+        return 0.0;
+    return SILENCE_DEPTH * q / (juce::MathConstants<double>::pi * frequency);
+}
+
+float SilenceDetector::ResonanceGain(double q)
+{
+    if (q * q <= 0.5)
+        return 1.0f;
+    return (float)(q / std::sqrt(1.0 - 0.25 / (q * q)));
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Lets an effect skip its DSP while it is fed silence and whatever it still
+// rings with has died away.
+//
+// Process() is called at the top of processBlock() with the input and the
+// effect's current tail length. It counts how long the input has been silent,
+// and once that covers the whole tail the effect's output is silent too: it
+// clears the block and returns true, and the effect skips its DSP. The input
+// is only below the threshold, not zero, so it is not passed on unprocessed.
+// On falling asleep (IsSleeping() was false before the call) the effect resets
+// its DSP, so it wakes from a clean state rather than from whatever it held
+// when its processing stopped. The first block with a sample above the
+// threshold wakes the effect again, and that block is processed in full, so
+// nothing of the new input is lost.
+//
+// The Tail functions give the time for the typical kinds of tail to fall
+// below SILENCE_THRESHOLD, for getTailLengthSeconds() and Process() alike.
+class SilenceDetector
+{
+public:
+    // -100 dB, below the noise floor of 16 bit audio.
+    static constexpr float SILENCE_THRESHOLD = 1.0e-5f;
+
+    SilenceDetector() = default;
+
+    void Prepare(double sampleRate);
+
+    // Forgets the silence counted so far, e.g. after the effect's state changed.
+    void Reset();
+
+    // Returns true, with the first numChannels channels cleared, when the
+    // block can be skipped. maxGain is the most the effect amplifies its
+    // input by, which lowers the threshold to match.
+    bool Process(juce::AudioBuffer<float> &buffer, int numChannels, double tailSeconds, float maxGain = 1.0f);
+    bool IsSleeping() const { return mSleeping; }
+
+    static bool IsSilent(const juce::AudioBuffer<float> &buffer, int numChannels, float threshold = SILENCE_THRESHOLD);
+
+    // A loop that comes around every periodSeconds and scales by feedback on
+    // each pass. Infinite for a feedback of 1 or more.
+    static double FeedbackTail(double periodSeconds, double feedback);
+
+    // An exponential decay that falls by 60 dB in t60Seconds.
+    static double DecayTail(double t60Seconds);
+
+    // A filter pole pair at frequency with quality q. A q of 0.5 is also a
+    // first order filter at that frequency.
+    static double ResonanceTail(double frequency, double q);
+
+    // The peak gain of a second order low or high pass with quality q, the
+    // maxGain to pass to Process() for it. 1 up to the Butterworth quality.
+    static float ResonanceGain(double q);
+
+private:
+    double mSampleRate = 44100.0;
+    juce::int64 mSilentSamples = 0;
+    bool mSleeping = false;
+};
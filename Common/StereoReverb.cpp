@@ -0,0 +1,268 @@
+#include "StereoReverb.h"
+#include "SilenceDetector.h"
+
+namespace
+{
+    // Freeverb's tunings at 44.1 kHz, the right channel spread by a few samples.
+    constexpr int COMB_TUNINGS[] = { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617 };
+    constexpr int ALLPASS_TUNINGS[] = { 556, 441, 341, 225 };
+    constexpr int STEREO_SPREAD = 23;
+
+    // Scaling of the parameters, as in juce::dsp::Reverb.
+    constexpr float INPUT_GAIN = 0.015f;
+    constexpr float WET_SCALE = 3.0f;
+    constexpr float DRY_SCALE = 2.0f;
+    constexpr float ROOM_SCALE = 0.28f;
+    constexpr float ROOM_OFFSET = 0.7f;
+    constexpr float DAMP_SCALE = 0.4f;
+    constexpr double SMOOTHING_SECONDS = 0.01;
+
+    // Copies numSamples delayed samples to every stride-th element of dest. A
+    // chunk is never longer than the delay, so it wraps at most once.
+    template <typename Delay>
+    void ReadDelay(const Delay &delay, float *dest, int stride, int numSamples)
+    {
+        const int first = juce::jmin(numSamples, delay.length - delay.index);
+        const float *source = delay.buffer + delay.index;
+        for (int i = 0; i < first; ++i)
+            dest[i * stride] = source[i];
+
+        dest += first * stride;
+        for (int i = 0; i < numSamples - first; ++i)
+            dest[i * stride] = delay.buffer[i];
+    }
+
+    template <typename Delay>
+    void WriteDelay(Delay &delay, const float *source, int stride, int numSamples)
+    {
+        const int first = juce::jmin(numSamples, delay.length - delay.index);
+        float *dest = delay.buffer + delay.index;
+        for (int i = 0; i < first; ++i)
+            dest[i] = source[i * stride];
+
+        source += first * stride;
+        for (int i = 0; i < numSamples - first; ++i)
+            delay.buffer[i] = source[i * stride];
+
+        delay.index += numSamples;
+        if (delay.index >= delay.length)
+            delay.index -= delay.length;
+    }
+
+    template <typename Delay>
+    void ProcessAllpass(Delay &delay, float *samples, int numSamples)
+    {
+        while (numSamples > 0)
+        {
+            const int count = juce::jmin(numSamples, delay.length - delay.index);
+            float *buffer = delay.buffer + delay.index;
+
+            for (int i = 0; i < count; ++i)
+            {
+                const float buffered = buffer[i];
+                buffer[i] = samples[i] + buffered * 0.5f;
+                samples[i] = buffered - samples[i];
+            }
+
+            delay.index += count;
+            if (delay.index == delay.length)
+                delay.index = 0;
+
+            samples += count;
+            numSamples -= count;
+        }
+    }
+}
+
+StereoReverb::StereoReverb()
+{
+    // Smoothers without a ramp length jump to their targets, so the defaults
+    // are in place without a fade.
+    SetParameters(Parameters());
+}
+
+void StereoReverb::Prepare(double sampleRate)
+{
+    // Integer arithmetic as in juce::dsp::Reverb, so the delays match it exactly.
+    const int intSampleRate = (int)sampleRate;
+
+    int delayMemory = 0;
+    int minCombLength = std::numeric_limits<int>::max();
+    for (int lane = 0; lane < NUM_LANES; ++lane)
+    {
+        const int spread = lane < NUM_COMBS ? 0 : STEREO_SPREAD;
+        mCombs[(size_t)lane].length = juce::jmax(1, intSampleRate * (COMB_TUNINGS[lane % NUM_COMBS] + spread) / 44100);
+        minCombLength = juce::jmin(minCombLength, mCombs[(size_t)lane].length);
+        delayMemory += mCombs[(size_t)lane].length;
+    }
+
+    for (int allpass = 0; allpass < 2 * NUM_ALLPASSES; ++allpass)
+    {
+        const int spread = allpass < NUM_ALLPASSES ? 0 : STEREO_SPREAD;
+        mAllpasses[(size_t)allpass].length = juce::jmax(1, intSampleRate * (ALLPASS_TUNINGS[allpass % NUM_ALLPASSES] + spread) / 44100);
+        delayMemory += mAllpasses[(size_t)allpass].length;
+    }
+
+    mChunkSize = juce::jmin(MAX_CHUNK_SIZE, minCombLength);
+
+    mMemory.calloc((size_t)(NUM_LANES + MAX_CHUNK_SIZE * NUM_LANES + 3 * MAX_CHUNK_SIZE + delayMemory + mSIMDSize));
+    mCombState = SIMDFloat::getNextSIMDAlignedPtr(mMemory.get());
+    mFrames = mCombState + NUM_LANES;
+    mInput = mFrames + MAX_CHUNK_SIZE * NUM_LANES;
+    mWet[0] = mInput + MAX_CHUNK_SIZE;
+    mWet[1] = mWet[0] + MAX_CHUNK_SIZE;
+
+    float *buffer = mWet[1] + MAX_CHUNK_SIZE;
+    for (auto &comb : mCombs)
+    {
+        comb.buffer = buffer;
+        comb.index = 0;
+        buffer += comb.length;
+    }
+    for (auto &allpass : mAllpasses)
+    {
+        allpass.buffer = buffer;
+        allpass.index = 0;
+        buffer += allpass.length;
+    }
+
+    for (auto *smoother : { &mDamping, &mFeedback, &mDryGain, &mWetGain1, &mWetGain2 })
+        smoother->reset(sampleRate, SMOOTHING_SECONDS);
+}
+
+void StereoReverb::Reset()
+{
+    juce::FloatVectorOperations::clear(mCombState, NUM_LANES);
+
+    for (auto &comb : mCombs)
+    {
+        juce::FloatVectorOperations::clear(comb.buffer, comb.length);
+        comb.index = 0;
+    }
+    for (auto &allpass : mAllpasses)
+    {
+        juce::FloatVectorOperations::clear(allpass.buffer, allpass.length);
+        allpass.index = 0;
+    }
+}
+
+void StereoReverb::SetParameters(const Parameters &parameters)
+{
+    const float wet = parameters.wetLevel * WET_SCALE;
+    mDryGain.setTargetValue(parameters.dryLevel * DRY_SCALE);
+    mWetGain1.setTargetValue(0.5f * wet * (1.0f + parameters.width));
+    mWetGain2.setTargetValue(0.5f * wet * (1.0f - parameters.width));
+
+    // Frozen, the combs stop taking input and circulate what they hold forever.
+    const bool frozen = parameters.freezeMode >= 0.5f;
+    mGain = frozen ? 0.0f : INPUT_GAIN;
+    mDamping.setTargetValue(frozen ? 0.0f : parameters.damping * DAMP_SCALE);
+    mFeedback.setTargetValue(frozen ? 1.0f : parameters.roomSize * ROOM_SCALE + ROOM_OFFSET);
+
+    mParameters = parameters;
+}
+
+double StereoReverb::GetTailLengthSeconds(const Parameters &parameters)
+{
+    // The longest comb, with the feedback damping never lets past, followed
+    // by the allpasses in series.
+    const double feedback = parameters.freezeMode >= 0.5f ? 1.0 : parameters.roomSize * ROOM_SCALE + ROOM_OFFSET;
+    double seconds = SilenceDetector::FeedbackTail((COMB_TUNINGS[NUM_COMBS - 1] + STEREO_SPREAD) / 44100.0, feedback);
+
+    for (int allpass = 0; allpass < NUM_ALLPASSES; ++allpass)
+        seconds += SilenceDetector::FeedbackTail((ALLPASS_TUNINGS[allpass] + STEREO_SPREAD) / 44100.0, 0.5);
+
+    return seconds;
+}
+
+void StereoReverb::Process(float *left, float *right, int numSamples)
+{
+    jassert(mChunkSize > 0);
+
+    for (int offset = 0; offset < numSamples; offset += mChunkSize)
+    {
+        const int chunkSamples = juce::jmin(mChunkSize, numSamples - offset);
+        ProcessChunk(left + offset, right != nullptr ? right + offset : nullptr, chunkSamples);
+    }
+}
+
+void StereoReverb::ProcessChunk(float *left, float *right, int numSamples)
+{
+    const float damping = mDamping.skip(numSamples);
+    const float feedback = mFeedback.skip(numSamples);
+
+    // Every comb of both channels is fed the same mono sum.
+    if (right != nullptr)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            mInput[i] = (left[i] + right[i]) * mGain;
+    }
+    else
+    {
+        for (int i = 0; i < numSamples; ++i)
+            mInput[i] = left[i] * mGain;
+    }
+
+    for (int lane = 0; lane < NUM_LANES; ++lane)
+        ReadDelay(mCombs[(size_t)lane], mFrames + lane, NUM_LANES, numSamples);
+
+    const auto damp1 = SIMDFloat::expand(1.0f - damping);
+    const auto damp2 = SIMDFloat::expand(damping);
+    const auto feedbackGain = SIMDFloat::expand(feedback);
+
+    SIMDFloat last[NUM_REGISTERS];
+    for (int r = 0; r < NUM_REGISTERS; ++r)
+        last[r] = SIMDFloat::fromRawArray(mCombState + r * mSIMDSize);
+
+    // Registers [0, NUM_REGISTERS / 2) hold the left combs, the rest the right ones.
+    for (int i = 0; i < numSamples; ++i)
+    {
+        float *frame = mFrames + i * NUM_LANES;
+        const auto input = SIMDFloat::expand(mInput[i]);
+        SIMDFloat sum[2] = { SIMDFloat::expand(0.0f), SIMDFloat::expand(0.0f) };
+
+        for (int r = 0; r < NUM_REGISTERS; ++r)
+        {
+            const auto output = SIMDFloat::fromRawArray(frame + r * mSIMDSize);
+            last[r] = output * damp1 + last[r] * damp2;
+            (input + last[r] * feedbackGain).copyToRawArray(frame + r * mSIMDSize);
+            sum[r / (NUM_REGISTERS / 2)] += output;
+        }
+
+        mWet[0][i] = sum[0].sum();
+        mWet[1][i] = sum[1].sum();
+    }
+
+    for (int r = 0; r < NUM_REGISTERS; ++r)
+        last[r].copyToRawArray(mCombState + r * mSIMDSize);
+
+    for (int lane = 0; lane < NUM_LANES; ++lane)
+        WriteDelay(mCombs[(size_t)lane], mFrames + lane, NUM_LANES, numSamples);
+
+    const int numChannels = right != nullptr ? 2 : 1;
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int allpass = 0; allpass < NUM_ALLPASSES; ++allpass)
+            ProcessAllpass(mAllpasses[(size_t)(channel * NUM_ALLPASSES + allpass)], mWet[channel], numSamples);
+
+    if (right != nullptr)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float dry = mDryGain.getNextValue();
+            const float wet1 = mWetGain1.getNextValue();
+            const float wet2 = mWetGain2.getNextValue();
+            left[i] = mWet[0][i] * wet1 + mWet[1][i] * wet2 + left[i] * dry;
+            right[i] = mWet[1][i] * wet1 + mWet[0][i] * wet2 + right[i] * dry;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float dry = mDryGain.getNextValue();
+            const float wet1 = mWetGain1.getNextValue();
+            mWetGain2.skip(1);
+            left[i] = mWet[0][i] * wet1 + left[i] * dry;
+        }
+    }
+}
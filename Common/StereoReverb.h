@@ -0,0 +1,75 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Freeverb with the parameters and sound of juce::dsp::Reverb, laid out for
+// SIMD and running both channels of a pair in one pass.
+//
+// The 8 parallel combs of the left channel and the 8 of the right one are 16
+// lanes, structure-of-arrays. A comb only feeds back one comb length later,
+// so a chunk of samples shorter than every comb can read all its delayed
+// samples before writing any: each chunk gathers the delayed samples of all
+// combs into lane order, runs the 16 damping filters in registers and
+// scatters the results back. The allpasses have no state besides their
+// buffers and run over a whole chunk per stage, which vectorises along time.
+//
+// Damping and room size are smoothed per chunk, the output gains per sample.
+class StereoReverb
+{
+public:
+    using Parameters = juce::dsp::Reverb::Parameters;
+
+    StereoReverb();
+
+    void Prepare(double sampleRate);
+    void Reset();
+
+    void SetParameters(const Parameters &parameters);
+    const Parameters &GetParameters() const { return mParameters; }
+
+    // Seconds until an impulse has died away below SilenceDetector's
+    // threshold, infinite when frozen.
+    static double GetTailLengthSeconds(const Parameters &parameters);
+
+    // Processes a pair of channels in place. With right == nullptr the left
+    // channel is processed as mono, through the left combs only.
+    void Process(float *left, float *right, int numSamples);
+
+private:
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int mSIMDSize = (int)SIMDFloat::SIMDNumElements;
+
+    static constexpr int NUM_COMBS = 8;
+    static constexpr int NUM_LANES = 2 * NUM_COMBS;
+    static constexpr int NUM_REGISTERS = NUM_LANES / mSIMDSize;
+    static constexpr int NUM_ALLPASSES = 4;
+    static constexpr int MAX_CHUNK_SIZE = 128;
+
+    static_assert(NUM_COMBS % mSIMDSize == 0, "the combs of a channel have to fill whole registers");
+
+    struct Delay
+    {
+        float *buffer = nullptr;
+        int length = 0;
+        int index = 0;
+    };
+
+    void ProcessChunk(float *left, float *right, int numSamples);
+
+    Parameters mParameters;
+    float mGain = 0.0f;
+    juce::LinearSmoothedValue<float> mDamping, mFeedback, mDryGain, mWetGain1, mWetGain2;
+
+    std::array<Delay, NUM_LANES> mCombs;
+    std::array<Delay, 2 * NUM_ALLPASSES> mAllpasses;
+    int mChunkSize = 0;
+
+    // SIMD aligned: the comb filter state, the lane ordered chunk, the chunk
+    // scratch and all delay buffers, sized in Prepare().
+    juce::HeapBlock<float> mMemory;
+    float *mCombState = nullptr;
+    float *mFrames = nullptr;
+    float *mInput = nullptr;
+    float *mWet[2] = {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StereoReverb)
+};
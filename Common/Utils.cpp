@@ -39,3 +39,9 @@ float Lfo(float phase, Waveform waveform)
 
     return outData;
 }
+
+bool IsMatchingBusesLayout(const juce::AudioProcessor::BusesLayout &layouts)
+{
+    const auto output = layouts.getMainOutputChannelSet();
+    return !output.isDisabled() && output == layouts.getMainInputChannelSet();
+}
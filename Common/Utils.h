@@ -16,6 +16,11 @@ enum Interpolation
     LINEAR,
     CUBIC
 };
+
+// Number of entries in each enum, for kernel tables indexed by them.
+constexpr int NUM_WAVEFORMS = INVERSE_SWATOOTH + 1;
+constexpr int NUM_INTERPOLATIONS = CUBIC + 1;
+
 const juce::StringArray mWaveformItemsUI =
     {
         "Sine",
@@ -31,4 +36,8 @@ const juce::StringArray mInterpolationItemsUI =
         "Cubic",
 };
 
-float Lfo(float phase, Waveform waveform);
\ No newline at end of file
+float Lfo(float phase, Waveform waveform);
+
+// Any channel set is supported, as long as the main input matches the main
+// output. What the effects' isBusesLayoutSupported() allow.
+bool IsMatchingBusesLayout(const juce::AudioProcessor::BusesLayout &layouts);
\ No newline at end of file
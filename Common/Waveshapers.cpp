@@ -0,0 +1,24 @@
+#include "Waveshapers.h"
+
+void Waveshapers::Shape(Curve curve, const juce::dsp::AudioBlock<float> &block)
+{
+    switch (curve)
+    {
+    case TANH:
+        Shape<Tanh>(block);
+        break;
+    case HARD_CLIP:
+        Shape<HardClip>(block);
+        break;
+    case SOFT_CLIP:
+        Shape<SoftClip>(block);
+        break;
+    case TUBE:
+        Shape<Tube>(block);
+        break;
+    case FOLDBACK:
+    default:
+        Shape<Foldback>(block);
+        break;
+    }
+}
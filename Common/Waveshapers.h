@@ -0,0 +1,127 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Memoryless waveshaping curves as compile time functors, for the distortion
+// effects.
+//
+// Every functor is float arithmetic without branches, selects or calls into
+// libm, so Shape<Function>() over a contiguous channel compiles to a loop the
+// compiler vectorises: 4 samples per instruction with SSE or NEON, 8 with AVX
+// and 16 with AVX-512. Clamping is done with absolute values because a select
+// on floats may trap and keeps the loop scalar unless trapping math is turned
+// off. SIMDRegister has no division, which the Pade tanh needs, so the loops
+// are left to the vectoriser. Picking a curve at run time is one switch per
+// block in Shape(Curve, ...), never an indirect call per sample.
+//
+// Errors are absolute, against the exact curve in double, on any input:
+//   Tanh      [7/6] Pade approximant, input clamped where it reaches 1: < 1e-4
+//   SoftClip  1.5 (x - x^3 / 3) on [-1, 1], +-1 beyond: < 1e-6
+//   HardClip  clamped to [-limit, limit]: < 1e-7 * limit
+//   Tube      tanh(x + bias) - tanh(bias), asymmetric, so it adds even
+//             harmonics; built on Tanh: < 1e-4
+//   Foldback  folds everything past +-1 back like a triangle wave: < 1e-7
+//             on [-1, 1], growing with the rounding of |x| + 1 beyond
+namespace Waveshapers
+{
+    // AdaaShaper antialiases the same curves, evaluated exactly in double.
+    enum Curve
+    {
+        TANH = 0,
+        HARD_CLIP,
+        SOFT_CLIP,
+        TUBE,
+        FOLDBACK,
+        NUM_CURVES
+    };
+
+    const juce::StringArray mCurveItemsUI =
+        {
+            "Tanh",
+            "Hard Clip",
+            "Soft Clip",
+            "Tube",
+            "Foldback",
+    };
+
+    // x clamped to [-limit, limit], exact up to a rounding of limit.
+    inline float Clamp(float x, float limit)
+    {
+        return 0.5f * (std::abs(x + limit) - std::abs(x - limit));
+    }
+
+    struct Tanh
+    {
+        // Where the approximant reaches 1.
+        static constexpr float INPUT_LIMIT = 4.97178686f;
+
+        float operator()(float x) const
+        {
+            x = Clamp(x, INPUT_LIMIT);
+            const float x2 = x * x;
+            const float numerator = x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)));
+            const float denominator = 135135.0f + x2 * (62370.0f + x2 * (3150.0f + x2 * 28.0f));
+            return numerator / denominator;
+        }
+    };
+
+    struct SoftClip
+    {
+        float operator()(float x) const
+        {
+            x = Clamp(x, 1.0f);
+            return x * (1.5f - 0.5f * x * x);
+        }
+    };
+
+    struct HardClip
+    {
+        float limit = 1.0f;
+
+        float operator()(float x) const
+        {
+            return Clamp(x, limit);
+        }
+    };
+
+    struct Tube
+    {
+        static constexpr float BIAS = 0.25f;
+        // tanh(BIAS), so silence stays silent.
+        static constexpr float OFFSET = 0.24491866f;
+
+        float operator()(float x) const
+        {
+            return Tanh()(x + BIAS) - OFFSET;
+        }
+    };
+
+    struct Foldback
+    {
+        // A triangle wave of period 4 that is the identity on [-1, 1]. It is
+        // odd, so the fold runs on |x|, where truncating is flooring. The
+        // period count has to fit an int, which holds up to 2^33, some 200 dB
+        // above full scale.
+        float operator()(float x) const
+        {
+            const float shifted = std::abs(x) + 1.0f;
+            const float wrapped = shifted - 4.0f * (float)(int32_t)(shifted * 0.25f);
+            return std::copysign(1.0f, x) * (1.0f - std::abs(wrapped - 2.0f));
+        }
+    };
+
+    template <typename Function>
+    void Shape(float *samples, int numSamples, Function function = {})
+    {
+        for (int i = 0; i < numSamples; ++i)
+            samples[i] = function(samples[i]);
+    }
+
+    template <typename Function>
+    void Shape(const juce::dsp::AudioBlock<float> &block, Function function = {})
+    {
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+            Shape(block.getChannelPointer(channel), (int)block.getNumSamples(), function);
+    }
+
+    void Shape(Curve curve, const juce::dsp::AudioBlock<float> &block);
+}
@@ -1,6 +1,7 @@
 
 
 #include "PluginProcessor.h"
+#include "Common/Utils.h"
 
 
 DelayAudioProcessor::DelayAudioProcessor()
@@ -61,7 +62,8 @@ bool DelayAudioProcessor::isMidiEffect() const
 
 double DelayAudioProcessor::getTailLengthSeconds() const
 {
-	return 0.0;
+	// Every echo comes back one delay time later, scaled by the feedback.
+	return SilenceDetector::FeedbackTail(mDelayParamDelayTime.GetHostValue(), mDelayParamFeedback.GetHostValue());
 }
 
 int DelayAudioProcessor::getNumPrograms()
@@ -97,15 +99,12 @@ void DelayAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 	mDelayParamMix.reset(sampleRate, smoothTime);
 
 	float maxDelayTime = mDelayParamDelayTime.maxValue;
-	mDelayBufferSamples = maxDelayTime * sampleRate + 1;
-	if (mDelayBufferSamples < 1)
-		mDelayBufferSamples = 1;
+	int32_t maxDelaySamples = (int32_t)(maxDelayTime * sampleRate) + 1;
 
-	mDelayBufferChannels = getTotalNumInputChannels();
-	mDelayBuffer.setSize(mDelayBufferChannels, mDelayBufferSamples);
-	mDelayBuffer.clear();
-
-	mDelayWritePositions = 0;
+	mDelayLine.Prepare(getTotalNumInputChannels(), maxDelaySamples, samplesPerBlock);
+	mSilence.Prepare(sampleRate);
+	mDelayOutput.setSize(2, samplesPerBlock);
+	mParameterRamps.setSize(2, samplesPerBlock);
 }
 
 void DelayAudioProcessor::releaseResources()
@@ -117,26 +116,7 @@ void DelayAudioProcessor::releaseResources()
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool DelayAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-#if JucePlugin_IsMidiEffect
-	juce::ignoreUnused(layouts);
-	return true;
-#else
-	// This is the place where you check if the layout is supported.
-	// In this template code we only support mono or stereo.
-	// Some plugin hosts, such as certain GarageBand versions, will only
-	// load plugins that support stereo bus layouts.
-	if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-		&& layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-		return false;
-
-	// This checks if the input layout matches the output layout
-#if ! JucePlugin_IsSynth
-	if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-		return false;
-#endif
-
-	return true;
-#endif
+	return IsMatchingBusesLayout(layouts);
 }
 #endif
 
@@ -147,49 +127,67 @@ void DelayAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
 	const int numInputChannels = getTotalNumInputChannels();
 	const int numOutputChannels = getTotalNumOutputChannels();
 	const int numSamples = buffer.getNumSamples();
+	const int numChannels = juce::jmin(numInputChannels, mDelayLine.GetNumChannels());
+
+	for (int channel = numInputChannels; channel < numOutputChannels; ++channel)
+		buffer.clear(channel, 0, numSamples);
+
+	// With silent input and the last echo gone, the output is silent.
+	// The ring still holds the audio from before the silence, which a longer
+	// delay or more feedback would play again, so it is cleared on falling asleep.
+	const bool wasSleeping = mSilence.IsSleeping();
+	if (mSilence.Process(buffer, numChannels, getTailLengthSeconds()))
+	{
+		if (!wasSleeping)
+			mDelayLine.Reset();
+		return;
+	}
+
+	UpdateParameters(mDelayParamDelayTime, mDelayParamFeedback, mDelayParamMix);
 
 	float currentDelayTime = mDelayParamDelayTime.getTargetValue() * (float)getSampleRate();
-	float currentFeedback = mDelayParamFeedback.getNextValue();
-	float currentMix = mDelayParamMix.getNextValue();
 
-	int localWritePosition;
+	float* delayedData = mDelayOutput.getWritePointer(0);
+	float* feedbackData = mDelayOutput.getWritePointer(1);
+	float* feedbackRamp = mParameterRamps.getWritePointer(0);
+	float* mixRamp = mParameterRamps.getWritePointer(1);
 
-	for (int channel = 0; channel < numInputChannels; ++channel)
+	// A zero delay time leaves the signal untouched.
+	if (currentDelayTime > 0.0f)
 	{
-		float* channelData = buffer.getWritePointer(channel);
-		float* delayData = mDelayBuffer.getWritePointer(channel);
-		localWritePosition = mDelayWritePositions;
-
-		for (int sample = 0; sample < numSamples; ++sample)
+		for (int start = 0; start < numSamples;)
 		{
-			const float in = channelData[sample];
-			float out = 0.0f;
+			const int chunkSamples = mDelayLine.GetChunkSize(currentDelayTime, numSamples - start);
+			mDelayLine.SetDelay(currentDelayTime, chunkSamples);
+			mDelayParamFeedback.RenderRamp(feedbackRamp, chunkSamples);
+			mDelayParamMix.RenderRamp(mixRamp, chunkSamples);
 
-			float readPosition = fmodf((float)localWritePosition - currentDelayTime + (float)mDelayBufferSamples, mDelayBufferSamples);
+			for (int channel = 0; channel < numChannels; ++channel)
+			{
+				float* channelData = buffer.getWritePointer(channel, start);
+				mDelayLine.Read<Interpolation::LINEAR>(channel, delayedData, chunkSamples);
 
-			int localReadPosition = floorf(readPosition);
+				for (int sample = 0; sample < chunkSamples; ++sample)
+				{
+					const float in = channelData[sample];
+					const float out = delayedData[sample];
 
-			if (localReadPosition != localWritePosition)
-			{
-				float fraction = readPosition - (float)localReadPosition;
-				float delayed1 = delayData[(localReadPosition + 0)];
-				float delayed2 = delayData[(localReadPosition + 1) % mDelayBufferSamples];
-				out = delayed1 + fraction * (delayed2 - delayed1);
+					channelData[sample] = in + mixRamp[sample] * (out - in);
+					feedbackData[sample] = in + out * feedbackRamp[sample];
+				}
 
-				channelData[sample] = in + currentMix * (out - in);
-				delayData[localWritePosition] = in + out * currentFeedback;
+				mDelayLine.Write(channel, feedbackData, chunkSamples);
 			}
 
-			if (++localWritePosition >= mDelayBufferSamples)
-				localWritePosition -= mDelayBufferSamples;
+			mDelayLine.Advance(chunkSamples);
+			start += chunkSamples;
 		}
-
 	}
-
-	mDelayWritePositions = localWritePosition;
-	
-	for (int channel = numInputChannels; channel < numOutputChannels; ++channel)
-		buffer.clear(channel, 0, numSamples);
+	else
+	{
+		mDelayParamFeedback.skip(numSamples);
+		mDelayParamMix.skip(numSamples);
+	}
 }
 
 
@@ -2,6 +2,8 @@
 
 #include <JuceHeader.h>
 #include "Common/PluginParameterSlider.h"
+#include "Common/DelayLine.h"
+#include "Common/SilenceDetector.h"
 
 class DelayAudioProcessor : public juce::AudioProcessor
 #if JucePlugin_Enable_ARA
@@ -47,15 +49,15 @@ public:
 	void setStateInformation(const void* data, int sizeInBytes) override;
 
 private:
-	juce::AudioSampleBuffer mDelayBuffer;
-	int32_t mDelayBufferSamples;
-	int32_t mDelayBufferChannels;
-	int32_t mDelayWritePositions;
+	DelayLine mDelayLine;
+	SilenceDetector mSilence;
+	juce::AudioSampleBuffer mDelayOutput;
+	juce::AudioSampleBuffer mParameterRamps;
 
 	juce::AudioProcessorValueTreeState mDelayParameters;
-	PluginParameterSlider mDelayParamDelayTime;
-	PluginParameterSlider mDelayParamFeedback;
-	PluginParameterSlider mDelayParamMix;
+	PluginParameterSlider<> mDelayParamDelayTime;
+	PluginParameterSlider<> mDelayParamFeedback;
+	PluginParameterSlider<> mDelayParamMix;
 
 	
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DelayAudioProcessor)
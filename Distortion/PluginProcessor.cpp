@@ -1,6 +1,7 @@
 
 
 #include "PluginProcessor.h"
+#include "Common/Utils.h"
 
 
 DistortionAudioProcessor::DistortionAudioProcessor()
@@ -39,13 +40,19 @@ DistortionAudioProcessor::DistortionAudioProcessor()
             {
             return static_cast<juce::String>(round(value * 100.f * 100.0f) / 100.f);
             },
-            nullptr)
+            nullptr),
+        // 2x with first order ADAA rejects aliases about as well as the plain 8x it replaces.
+        std::make_unique<juce::AudioParameterChoice>(IDs::oversampling, "oversampling", juce::StringArray{ "1x", "2x", "4x", "8x" }, 1),
+        std::make_unique<juce::AudioParameterChoice>(IDs::antialiasing, "antialiasing", juce::StringArray{ "Off", "ADAA 1st order", "ADAA 2nd order" }, 1),
+        std::make_unique<juce::AudioParameterChoice>(IDs::curve, "curve", Waveshapers::mCurveItemsUI, Waveshapers::TANH),
+        std::make_unique<juce::AudioParameterChoice>(IDs::filterMode, "oversampling filter", juce::StringArray{ "Minimum phase", "Linear phase" }, 0)
         })
 {
 }
 
 DistortionAudioProcessor::~DistortionAudioProcessor()
 {
+    cancelPendingUpdate();
 }
 
 
@@ -83,7 +90,22 @@ bool DistortionAudioProcessor::isMidiEffect() const
 
 double DistortionAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // The tone filters are first order, the shaper and the volumes have no memory.
+    const double lowPassTail = SilenceDetector::ResonanceTail(*parameters.getRawParameterValue(IDs::LPFreq), 0.5);
+    const double highPassTail = SilenceDetector::ResonanceTail(*parameters.getRawParameterValue(IDs::HPFreq), 0.5);
+    const double filterTail = juce::jmax(lowPassTail, highPassTail);
+
+    // The oversampling round trip is a low pass whose response is centred on
+    // the latency. The linear phase FIRs are symmetric, so their response has
+    // ended twice the latency after the input; the minimum phase IIRs put most
+    // of their energy before the delay, which the same span leaves room for.
+    // The ADAA only remembers a sample or two at the oversampled rate, which
+    // the latency already includes.
+    const double sampleRate = getSampleRate();
+    if (sampleRate <= 0.0)
+        return filterTail;
+
+    return filterTail + 2.0 * getLatencySamples() / sampleRate;
 }
 
 int DistortionAudioProcessor::getNumPrograms()
@@ -118,20 +140,58 @@ void DistortionAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBl
     spec.maximumBlockSize = samplesPerBlock;
     spec.numChannels = getTotalNumOutputChannels();
 
-    sampleRate = static_cast<float>(spec.sampleRate);
+    this->sampleRate = static_cast<float>(spec.sampleRate);
     maxBlockSize = spec.maximumBlockSize;
     numChannels = spec.numChannels;
 
     inputVolume.prepare(spec);
     outputVolume.prepare(spec);
-    lowPassFilter.prepare(spec);
-    highPassFilter.prepare(spec);
+    lowPassFilter.Prepare(spec.sampleRate, (int)numChannels, (int)maxBlockSize);
+    highPassFilter.Prepare(spec.sampleRate, (int)numChannels, (int)maxBlockSize);
+
+    // Tone knob sweeps ramp the coefficients across the block.
+    lowPassFilter.SetInterpolation(true);
+    highPassFilter.SetInterpolation(true);
+
+    // The oversamplers keep filter state per channel, so they are rebuilt for the bus width.
+    for (size_t factor = 0; factor < oversamplers.size(); ++factor)
+    {
+        oversamplers[factor] = std::make_unique<juce::dsp::Oversampling<float>>(numChannels, factor, juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, false);
+        oversamplers[factor]->initProcessing(static_cast<size_t>(maxBlockSize));
+        linearPhaseOversamplers[factor].Prepare((int)numChannels, (int)factor, (int)maxBlockSize);
+    }
+    currentOversampling = -1;
+    currentFilterMode = -1;
+
+    adaa.Prepare((int)numChannels);
+    currentAntialiasing = -1;
+    silence.Prepare(spec.sampleRate);
+
+    // Reported before the first block, so the host compensates from the start.
+    pendingLatency = getLatencyFor((int)parameters.getRawParameterValue(IDs::oversampling)->load(),
+                                   (int)parameters.getRawParameterValue(IDs::filterMode)->load(),
+                                   (int)parameters.getRawParameterValue(IDs::antialiasing)->load());
+    setLatencySamples(pendingLatency);
+}
+
+void DistortionAudioProcessor::handleAsyncUpdate()
+{
+    // The host is only told when the rounded latency actually changes.
+    setLatencySamples(pendingLatency);
+}
 
-    oversampling->initProcessing(static_cast<size_t>(maxBlockSize));
+int DistortionAudioProcessor::getLatencyFor(int oversamplingIndex, int filterMode, int antialiasing) const
+{
+    const auto index = (size_t)juce::jlimit(0, (int)oversamplers.size() - 1, oversamplingIndex);
+    if (oversamplers[index] == nullptr)
+        return 0;
 
-    oversampling->reset();
-    lowPassFilter.reset();
-    highPassFilter.reset();
+    const double factor = (double)oversamplers[index]->getOversamplingFactor();
+    const double oversamplingLatency = filterMode == 0 ? (double)oversamplers[index]->getLatencyInSamples()
+                                                       : (double)linearPhaseOversamplers[index].GetLatencySamples();
+    const double shaperLatency = antialiasing == 0 ? 0.0 : AdaaShaper::GetDelay(antialiasing == 1 ? AdaaShaper::FIRST_ORDER : AdaaShaper::SECOND_ORDER);
+
+    return juce::roundToInt(oversamplingLatency + shaperLatency / factor);
 }
 
 void DistortionAudioProcessor::releaseResources()
@@ -143,26 +203,7 @@ void DistortionAudioProcessor::releaseResources()
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool DistortionAudioProcessor::isBusesLayoutSupported(const BusesLayout &layouts) const
 {
-#if JucePlugin_IsMidiEffect
-    juce::ignoreUnused(layouts);
-    return true;
-#else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-        && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
-
-    // This checks if the input layout matches the output layout
-#if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-        return false;
-#endif
-
-    return true;
-#endif
+    return IsMatchingBusesLayout(layouts);
 }
 #endif
 
@@ -173,7 +214,7 @@ void DistortionAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer, ju
 
     auto numSamples = buffer.getNumSamples();
 
-    for (auto i = juce::jmin(2, totalNumInputChannels); i < totalNumOutputChannels; ++i)
+    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, numSamples);
 
     float inputVol = *parameters.getRawParameterValue(IDs::inputVolume);
@@ -182,36 +223,77 @@ void DistortionAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer, ju
     auto inputdB = juce::Decibels::decibelsToGain(inputVol);
     auto outputdB = juce::Decibels::decibelsToGain(outputVol);
 
+    // Quiet input may be brought up a long way, so silence is judged after both
+    // volumes. Falling asleep clears the filters, and the oversampler and
+    // shaper are reset as if newly selected when the input comes back.
+    const bool wasSleeping = silence.IsSleeping();
+    if (silence.Process(buffer, totalNumInputChannels, getTailLengthSeconds(), inputdB * outputdB))
+    {
+        if (!wasSleeping)
+        {
+            lowPassFilter.Reset();
+            highPassFilter.Reset();
+            currentOversampling = -1;
+        }
+        return;
+    }
+
     if (inputVolume.getGainLinear() != inputdB)
         inputVolume.setGainLinear(inputdB);
     if (outputVolume.getGainLinear() != outputdB)
         outputVolume.setGainLinear(outputdB);
 
     float freqLowPass = *parameters.getRawParameterValue(IDs::LPFreq);
-    *lowPassFilter.state = *juce::dsp::IIR::Coefficients<float>::makeFirstOrderLowPass(sampleRate, freqLowPass);
+    lowPassFilter.SetParameters(BiquadFilter::FIRST_ORDER_LOW_PASS, freqLowPass);
     float freqHighPass = *parameters.getRawParameterValue(IDs::HPFreq);
-    *highPassFilter.state = *juce::dsp::IIR::Coefficients<float>::makeFirstOrderHighPass(sampleRate, freqHighPass);
+    highPassFilter.SetParameters(BiquadFilter::FIRST_ORDER_HIGH_PASS, freqHighPass);
 
     juce::dsp::AudioBlock<float> block(buffer);
-    if (block.getNumChannels() > 2)
-        block = block.getSubsetChannelBlock(0, 2);
 
     auto ctx = juce::dsp::ProcessContextReplacing<float>(block);
 
     juce::ScopedNoDenormals noDenormals;
     inputVolume.process(ctx);
-    highPassFilter.process(ctx);
-
-    juce::dsp::AudioBlock<float> oversampledBlock = oversampling->processSamplesUp(ctx.getInputBlock());
-    auto waveshaperContext = juce::dsp::ProcessContextReplacing<float>(oversampledBlock);
-
-    waveShapers.process(waveshaperContext);
-
-    waveshaperContext.getOutputBlock() *= 0.7f;
-
-    oversampling->processSamplesDown(ctx.getOutputBlock());
-
-    lowPassFilter.process(ctx);
+    highPassFilter.Process(ctx.getOutputBlock());
+
+    // A newly selected oversampler or shaper starts from silence rather than
+    // from whatever it held when it was last used.
+    const int oversamplingIndex = juce::jlimit(0, (int)oversamplers.size() - 1, (int)parameters.getRawParameterValue(IDs::oversampling)->load());
+    const int antialiasing = (int)parameters.getRawParameterValue(IDs::antialiasing)->load();
+    const int filterMode = (int)parameters.getRawParameterValue(IDs::filterMode)->load();
+    const auto curve = (Waveshapers::Curve)juce::jlimit(0, (int)Waveshapers::NUM_CURVES - 1, (int)parameters.getRawParameterValue(IDs::curve)->load());
+    if (oversamplingIndex != currentOversampling || filterMode != currentFilterMode || antialiasing != currentAntialiasing)
+    {
+        oversamplers[(size_t)oversamplingIndex]->reset();
+        linearPhaseOversamplers[(size_t)oversamplingIndex].Reset();
+        adaa.Reset();
+        currentOversampling = oversamplingIndex;
+        currentFilterMode = filterMode;
+        currentAntialiasing = antialiasing;
+
+        const int latency = getLatencyFor(oversamplingIndex, filterMode, antialiasing);
+        if (latency != pendingLatency.exchange(latency))
+            triggerAsyncUpdate();
+    }
+    auto &oversampling = *oversamplers[(size_t)oversamplingIndex];
+    auto &linearPhaseOversampling = linearPhaseOversamplers[(size_t)oversamplingIndex];
+
+    juce::dsp::AudioBlock<float> oversampledBlock = filterMode == 0 ? oversampling.processSamplesUp(ctx.getInputBlock())
+                                                                    : linearPhaseOversampling.ProcessUp(ctx.getInputBlock());
+
+    if (antialiasing == 0)
+        Waveshapers::Shape(curve, oversampledBlock);
+    else
+        adaa.Process(curve, antialiasing == 1 ? AdaaShaper::FIRST_ORDER : AdaaShaper::SECOND_ORDER, oversampledBlock);
+
+    oversampledBlock *= 0.7f;
+
+    if (filterMode == 0)
+        oversampling.processSamplesDown(ctx.getOutputBlock());
+    else
+        linearPhaseOversampling.ProcessDown(ctx.getOutputBlock());
+
+    lowPassFilter.Process(ctx.getOutputBlock());
     outputVolume.process(ctx);
 }
 
@@ -1,6 +1,11 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "Common/AdaaShaper.h"
+#include "Common/BiquadFilter.h"
+#include "Common/LinearPhaseOversampler.h"
+#include "Common/SilenceDetector.h"
+#include "Common/Waveshapers.h"
 namespace IDs {
 
 	const juce::String inputVolume("inputVolume");
@@ -8,6 +13,10 @@ namespace IDs {
 	const juce::String LPFreq("LPFreq");
 	const juce::String outputVolume("outputVolume");
 	const juce::String wetDry("wetDry");
+	const juce::String oversampling("oversampling");
+	const juce::String antialiasing("antialiasing");
+	const juce::String curve("curve");
+	const juce::String filterMode("filterMode");
 
 }
 
@@ -15,6 +24,7 @@ class DistortionAudioProcessor : public juce::AudioProcessor
 #if JucePlugin_Enable_ARA
 	, public juce::AudioProcessorARAExtension
 #endif
+	, private juce::AsyncUpdater
 {
 public:
 	
@@ -55,15 +65,35 @@ public:
 	void setStateInformation(const void* data, int sizeInBytes) override;
 
 	juce::AudioProcessorValueTreeState parameters;
-	juce::dsp::WaveShaper<float> waveShapers{std::tanh} ;
-	juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> lowPassFilter{ juce::dsp::IIR::Coefficients<float>::makeFirstOrderLowPass(44100.f, 20000.f) }, highPassFilter{ juce::dsp::IIR::Coefficients<float>::makeFirstOrderHighPass(44100.f, 20.f) };
-	std::unique_ptr<juce::dsp::Oversampling<float>> oversampling = std::make_unique<juce::dsp::Oversampling<float>>(2, 3, juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, false);
+	BiquadFilter lowPassFilter, highPassFilter;
+	// One oversampler per factor, 1x to 8x, and per filter mode, all prepared
+	// up front so either can change on the audio thread without allocating.
+	// The polyphase IIRs are minimum phase, for the least latency when playing
+	// live; the FIRs are linear phase with a whole number of samples of
+	// latency, for mixing.
+	std::array<std::unique_ptr<juce::dsp::Oversampling<float>>, 4> oversamplers;
+	std::array<LinearPhaseOversampler, 4> linearPhaseOversamplers;
+	int currentOversampling = -1;
+	int currentFilterMode = -1;
+	// Antiderivative antialiasing of the selected curve, at the oversampled rate.
+	AdaaShaper adaa;
+	int currentAntialiasing = -1;
 	juce::dsp::Gain<float> inputVolume, outputVolume;
+	SilenceDetector silence;
 
 	float sampleRate = 44100.0f;
 	uint32_t maxBlockSize = 512;
 	uint32_t numChannels = 2;
 private:
+	// Delay of the oversampling round trip and the shaper, rounded to whole
+	// samples at the host rate. Only minimum phase filters and first order
+	// ADAA add fractions.
+	int getLatencyFor(int oversamplingIndex, int filterMode, int antialiasing) const;
+
+	// A new latency chosen on the audio thread is reported from the message
+	// thread, as telling the host runs its listeners.
+	void handleAsyncUpdate() override;
+	std::atomic<int> pendingLatency{ 0 };
 
 	
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DistortionAudioProcessor)
@@ -1,6 +1,7 @@
 
 
 #include "PluginProcessor.h"
+#include "Common/Utils.h"
 
 
 FilterAudioProcessor::FilterAudioProcessor()
@@ -17,6 +18,7 @@ FilterAudioProcessor::FilterAudioProcessor()
 {
 	addParameter(filterChoice = new juce::AudioParameterChoice("filter choice", "Filter Type", { "LowPass","HighPass" }, 0));
 	addParameter(frequency = new juce::AudioParameterFloat("frequency", "Frequency", 20.0f, 20000.0f, 440.0f));
+	addParameter(smoothSweeps = new juce::AudioParameterBool("smooth sweeps", "Smooth Sweeps", true));
 }
 
 FilterAudioProcessor::~FilterAudioProcessor()
@@ -58,7 +60,8 @@ bool FilterAudioProcessor::isMidiEffect() const
 
 double FilterAudioProcessor::getTailLengthSeconds() const
 {
-	return 0.0;
+	// A Butterworth section rings at its cutoff.
+	return SilenceDetector::ResonanceTail(*frequency, 1.0 / juce::MathConstants<double>::sqrt2);
 }
 
 int FilterAudioProcessor::getNumPrograms()
@@ -87,20 +90,23 @@ void FilterAudioProcessor::changeProgramName(int index, const juce::String& newN
 
 void FilterAudioProcessor::reset()
 {
-	filter.reset();
+	filter.Reset();
+}
+
+void FilterAudioProcessor::updateFilter()
+{
+	// Only redesigns when the type or frequency changed, and with smooth sweeps
+	// the change is spread over the next block instead of applied at its start.
+	filter.SetInterpolation(smoothSweeps->get());
+	filter.SetParameters(filterChoice->getIndex() == 0 ? BiquadFilter::LOW_PASS : BiquadFilter::HIGH_PASS, *frequency);
 }
 
 
 void FilterAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-	this->sampleRate = sampleRate;
-	if (filterChoice->getIndex() == 0)
-		*filter.state = *juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, *frequency);
-	else if (filterChoice->getIndex() == 1)
-		*filter.state = *juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, *frequency);
-
-	juce::dsp::ProcessSpec spec{ sampleRate,static_cast<juce::uint32>(samplesPerBlock),2 };
-	filter.prepare(spec);
+	filter.Prepare(sampleRate, juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()), samplesPerBlock);
+	silence.Prepare(sampleRate);
+	updateFilter();
 }
 
 void FilterAudioProcessor::releaseResources()
@@ -112,39 +118,26 @@ void FilterAudioProcessor::releaseResources()
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool FilterAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-#if JucePlugin_IsMidiEffect
-	juce::ignoreUnused(layouts);
-	return true;
-#else
-	// This is the place where you check if the layout is supported.
-	// In this template code we only support mono or stereo.
-	// Some plugin hosts, such as certain GarageBand versions, will only
-	// load plugins that support stereo bus layouts.
-	if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-		&& layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-		return false;
-
-	// This checks if the input layout matches the output layout
-#if ! JucePlugin_IsSynth
-	if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-		return false;
-#endif
-
-	return true;
-#endif
+	return IsMatchingBusesLayout(layouts);
 }
 #endif
 
 void FilterAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-	if (filterChoice->getIndex() == 0)
-		*filter.state = *juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, *frequency);
-	else if (filterChoice->getIndex() == 1)
-		*filter.state = *juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, *frequency);
+	// With silent input and the filter rung out, the output is silent.
+	// A Butterworth low or high pass never boosts, so the threshold stays.
+	const bool wasSleeping = silence.IsSleeping();
+	if (silence.Process(buffer, buffer.getNumChannels(), getTailLengthSeconds()))
+	{
+		if (!wasSleeping)
+			filter.Reset();
+		return;
+	}
+
+	updateFilter();
 
 	juce::dsp::AudioBlock<float> block(buffer);
-	juce::dsp::ProcessContextReplacing<float> context(block);
-	filter.process(context);
+	filter.Process(block);
 }
 
 
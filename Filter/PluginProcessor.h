@@ -1,6 +1,8 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "Common/BiquadFilter.h"
+#include "Common/SilenceDetector.h"
 class FilterAudioProcessor  : public juce::AudioProcessor
 {
 public:
@@ -44,10 +46,13 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
 
 private:
+    void updateFilter();
+
     juce::AudioParameterChoice* filterChoice;
     juce::AudioParameterFloat* frequency;
-    double sampleRate;
-    juce::dsp::ProcessorDuplicator < juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float> > filter;
+    juce::AudioParameterBool* smoothSweeps;
+    BiquadFilter filter;
+    SilenceDetector silence;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FilterAudioProcessor)
 };
@@ -15,11 +15,11 @@ FlangerAudioProcessor::FlangerAudioProcessor()
 	),
 #endif
 	apvts(*this, nullptr),
-	mDelay(apvts, "Delay", "ms", 1.0f, 20.0f, 2.5f, [](float value) { return value * 0.001f; }),
-	mWidth(apvts, "Width", "ms", 1.0f, 20.0f, 10.0f, [](float value) { return value * 0.001f; }),
+	mDelay(apvts, "Delay", "ms", 1.0f, 20.0f, 2.5f),
+	mWidth(apvts, "Width", "ms", 1.0f, 20.0f, 10.0f),
 	mDepth(apvts, "Depth", "", 0.0f, 1.0f, 1.0f),
 	mFeedback(apvts, "Feedback", "", 0.0f, 1.0f, 1.0f),
-	mInverted(apvts, "Inverted mode", "", false, [](float value) {return value * (-2.0f) + 1.0f; }),
+	mInverted(apvts, "Inverted mode", "", false),
 	mFrequency(apvts, "LFO Frequency", "Hz", 0.05f, 2.0f, 0.2f),
 	mWaveForm(apvts, "LFO waveform", "", mWaveformItemsUI, Waveform::SINE),
 	mInterpolation(apvts, "Interpolation", "", mInterpolationItemsUI, Interpolation::LINEAR),
@@ -68,7 +68,8 @@ bool FlangerAudioProcessor::isMidiEffect() const
 
 double FlangerAudioProcessor::getTailLengthSeconds() const
 {
-	return 0.0;
+	// The feedback comes around after the base delay plus the LFO swing, at the longest.
+	return SilenceDetector::FeedbackTail(mDelay.GetHostValue() + mWidth.GetHostValue(), mFeedback.GetHostValue());
 }
 
 int FlangerAudioProcessor::getNumPrograms()
@@ -109,17 +110,17 @@ void FlangerAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock
 	mInterpolation.reset(sampleRate, smoothTime);
 	mStereo.reset(sampleRate, smoothTime);
 
-	float maxDelayTime = mDelay.maxValue + mWidth.maxValue;
-	mDelayBufferSamples = maxDelayTime * sampleRate;
-	if (mDelayBufferSamples < 1)
-		mDelayBufferSamples = 1;
+	// The slider ranges are in milliseconds.
+	float maxDelayTime = (mDelay.maxValue + mWidth.maxValue) * 0.001f;
+	int32_t maxDelaySamples = (int32_t)(maxDelayTime * sampleRate) + 1;
 
-	mDelayBufferChannels = getTotalNumInputChannels();
-	mDelayBuffer.setSize(mDelayBufferChannels, mDelayBufferSamples);
-	mDelayBuffer.clear();
+	mDelayLine.Prepare(getTotalNumInputChannels(), maxDelaySamples, samplesPerBlock);
+	mSilence.Prepare(sampleRate);
+	mDelayTimes.setSize(2, samplesPerBlock);
+	mDelayOutput.setSize(2, samplesPerBlock);
+	mParameterRamps.setSize(NUM_RAMPS, samplesPerBlock);
+	mLfo.Prepare(2, samplesPerBlock);
 
-	mDelayWritePosition = 0;
-	mLfoPhase = 0.0f;
 	mInverseSampleRate = 1.0f / sampleRate;
 }
 
@@ -132,121 +133,155 @@ void FlangerAudioProcessor::releaseResources()
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool FlangerAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-#if JucePlugin_IsMidiEffect
-	juce::ignoreUnused(layouts);
-	return true;
-#else
-	// This is the place where you check if the layout is supported.
-	// In this template code we only support mono or stereo.
-	// Some plugin hosts, such as certain GarageBand versions, will only
-	// load plugins that support stereo bus layouts.
-	if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-		&& layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-		return false;
-
-	// This checks if the input layout matches the output layout
-#if ! JucePlugin_IsSynth
-	if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-		return false;
-#endif
-
-	return true;
-#endif
+	return IsMatchingBusesLayout(layouts);
 }
 #endif
 
+const FlangerAudioProcessor::Kernel FlangerAudioProcessor::mKernels[NUM_INTERPOLATIONS][NUM_WAVEFORMS] = {
+	{
+		&FlangerAudioProcessor::Process<Interpolation::NEAREST_NEIGHBOUR, Waveform::SINE>,
+		&FlangerAudioProcessor::Process<Interpolation::NEAREST_NEIGHBOUR, Waveform::TRIANGLE>,
+		&FlangerAudioProcessor::Process<Interpolation::NEAREST_NEIGHBOUR, Waveform::SWATOOTH>,
+		&FlangerAudioProcessor::Process<Interpolation::NEAREST_NEIGHBOUR, Waveform::INVERSE_SWATOOTH>,
+	},
+	{
+		&FlangerAudioProcessor::Process<Interpolation::LINEAR, Waveform::SINE>,
+		&FlangerAudioProcessor::Process<Interpolation::LINEAR, Waveform::TRIANGLE>,
+		&FlangerAudioProcessor::Process<Interpolation::LINEAR, Waveform::SWATOOTH>,
+		&FlangerAudioProcessor::Process<Interpolation::LINEAR, Waveform::INVERSE_SWATOOTH>,
+	},
+	{
+		&FlangerAudioProcessor::Process<Interpolation::CUBIC, Waveform::SINE>,
+		&FlangerAudioProcessor::Process<Interpolation::CUBIC, Waveform::TRIANGLE>,
+		&FlangerAudioProcessor::Process<Interpolation::CUBIC, Waveform::SWATOOTH>,
+		&FlangerAudioProcessor::Process<Interpolation::CUBIC, Waveform::INVERSE_SWATOOTH>,
+	},
+};
+
 void FlangerAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
 	juce::ScopedNoDenormals noDenormals;
-	auto totalNumInputChannels = getTotalNumInputChannels();
-	auto totalNumOutputChannels = getTotalNumOutputChannels();
-	auto numSamples = buffer.getNumSamples();
 
-	float curDelay = mDelay.getNextValue();
-	float curWidth = mWidth.getNextValue();
-	float curDepth = mDepth.getNextValue();
-	float curFeedback = mFeedback.getNextValue();
-	float curInverted = mInverted.getNextValue();
-	float curFrequency = mFrequency.getNextValue();
+	// With silent input and the feedback died away, the output is silent.
+	// The ring and its feedback still hold the audio from before the silence,
+	// which a longer delay would play again, so they are cleared on falling
+	// asleep, and the LFO starts over.
+	const bool wasSleeping = mSilence.IsSleeping();
+	if (mSilence.Process(buffer, juce::jmin(getTotalNumInputChannels(), mDelayLine.GetNumChannels()), getTailLengthSeconds()))
+	{
+		if (!wasSleeping)
+		{
+			mDelayLine.Reset();
+			mLfo.Reset();
+		}
+		return;
+	}
 
+	UpdateParameters(mDelay, mWidth, mDepth, mFeedback, mInverted, mFrequency, mWaveForm, mInterpolation, mStereo);
 
-	int localWritePosition;
-	float phase;
-	float phaseMain;
+	BlockParameters parameters;
+	parameters.stereo = (bool)mStereo.getTargetValue();
 
-	for (int channel = 0; channel < totalNumInputChannels; ++channel)
-	{
-		float* channelData = buffer.getWritePointer(channel);
-		float* delayData = mDelayBuffer.getWritePointer(channel);
-		localWritePosition = mDelayWritePosition;
+	const int waveform = juce::jlimit(0, NUM_WAVEFORMS - 1, (int)mWaveForm.getTargetValue());
+	const int interpolation = juce::jlimit(0, NUM_INTERPOLATIONS - 1, (int)mInterpolation.getTargetValue());
+	(this->*mKernels[interpolation][waveform])(buffer, parameters);
+}
 
-		if (mStereo.getTargetValue() && channel != 0)
-			phase = fmodf(phase + 0.25f, 1.0f);
+template <Interpolation interpolation, Waveform waveform>
+void FlangerAudioProcessor::Process(juce::AudioBuffer<float>& buffer, const BlockParameters& parameters)
+{
+	auto numSamples = buffer.getNumSamples();
+	auto numChannels = juce::jmin(getTotalNumInputChannels(), mDelayLine.GetNumChannels());
 
-		for (int sample = 0; sample < numSamples; ++sample)
-		{
-			const float inData = channelData[sample];
-			float outData = 0.0f;
+	const float sampleRate = (float)getSampleRate();
 
-			float localDelayTime = (curDelay + curWidth * Lfo(phase, (Waveform)mWaveForm.getTargetValue())) * getSampleRate();
+	float* delayRamp = mParameterRamps.getWritePointer(DELAY_RAMP);
+	float* widthRamp = mParameterRamps.getWritePointer(WIDTH_RAMP);
+	float* wetGain = mParameterRamps.getWritePointer(WET_GAIN_RAMP);
+	float* invertedRamp = mParameterRamps.getWritePointer(INVERTED_RAMP);
+	float* feedback = mParameterRamps.getWritePointer(FEEDBACK_RAMP);
 
-			float readPosition = fmodf(localWritePosition - localDelayTime + mDelayBufferSamples, mDelayBufferSamples);
+	float* delayedData = mDelayOutput.getWritePointer(0);
+	float* feedbackData = mDelayOutput.getWritePointer(1);
 
-			int localReadPosition = floorf(readPosition);
+	// In stereo mode the odd (right) channels of the bus run a quarter cycle ahead
+	// of the even ones. Channels with the same phase share one LFO voice and one
+	// set of read positions, so wide buses only add the delay line reads.
+	const int numVoices = (parameters.stereo && numChannels > 1) ? 2 : 1;
+	const float phaseOffsets[2] = { 0.0f, 0.25f };
 
-			switch ((int)mInterpolation.getTargetValue())
-			{
-			case NEAREST_NEIGHBOUR:
+	for (int start = 0; start < numSamples; start += mDelayLine.GetMaxBlockSize())
+	{
+		const int blockSamples = juce::jmin(numSamples - start, mDelayLine.GetMaxBlockSize());
+
+		const bool constantDelay = mDelay.RenderRamp(delayRamp, blockSamples);
+		const bool constantWidth = mWidth.RenderRamp(widthRamp, blockSamples);
+		mDepth.RenderRamp(wetGain, blockSamples);
+		mInverted.RenderRamp(invertedRamp, blockSamples);
+		juce::FloatVectorOperations::multiply(wetGain, invertedRamp, blockSamples);
+		mFeedback.RenderRamp(feedback, blockSamples);
+
+		// The LFO rate only needs to follow the smoother once per block.
+		const float phaseIncrement = mFrequency.skip(blockSamples) * mInverseSampleRate;
+		mLfo.Render<waveform>(phaseIncrement, phaseOffsets, numVoices, blockSamples);
+
+		// The LFO never goes below zero, so the shortest base delay bounds how far
+		// ahead of the feedback write head a chunk may read.
+		float minDelaySamples = mDelay.getTargetValue() * sampleRate;
+
+		if (constantDelay && constantWidth)
+		{
+			for (int voice = 0; voice < numVoices; ++voice)
 			{
-				float closestSample = delayData[localReadPosition % mDelayBufferSamples];
-				outData = closestSample;
-				break;
+				float* delayTimes = mDelayTimes.getWritePointer(voice);
+				juce::FloatVectorOperations::multiply(delayTimes, mLfo.GetVoice(voice), mWidth.getTargetValue() * sampleRate, blockSamples);
+				juce::FloatVectorOperations::add(delayTimes, minDelaySamples, blockSamples);
 			}
-			case LINEAR:
+		}
+		else
+		{
+			juce::FloatVectorOperations::multiply(delayRamp, sampleRate, blockSamples);
+			juce::FloatVectorOperations::multiply(widthRamp, sampleRate, blockSamples);
+			minDelaySamples = juce::FloatVectorOperations::findMinimum(delayRamp, blockSamples);
+
+			for (int voice = 0; voice < numVoices; ++voice)
 			{
-				float fraction = readPosition - localReadPosition;
-				float delayed0 = delayData[(localReadPosition + 0)];
-				float delayed1 = delayData[(localReadPosition + 1) % mDelayBufferSamples];
-				outData = delayed0 + fraction * (delayed1 - delayed0);
-				break;
+				float* delayTimes = mDelayTimes.getWritePointer(voice);
+				juce::FloatVectorOperations::multiply(delayTimes, mLfo.GetVoice(voice), widthRamp, blockSamples);
+				juce::FloatVectorOperations::add(delayTimes, delayRamp, blockSamples);
 			}
-			case CUBIC:
+		}
+
+		for (int offset = 0; offset < blockSamples;)
+		{
+			const int chunkSamples = mDelayLine.GetChunkSize(minDelaySamples, blockSamples - offset);
+
+			for (int voice = 0; voice < numVoices; ++voice)
 			{
-				float fraction = readPosition - (float)localReadPosition;
-				float fractionSqrt = fraction * fraction;
-				float fractionCube = fractionSqrt * fraction;
-
-				float sample0 = delayData[(localReadPosition - 1 + mDelayBufferSamples) % mDelayBufferSamples];
-				float sample1 = delayData[(localReadPosition + 0)];
-				float sample2 = delayData[(localReadPosition + 1) % mDelayBufferSamples];
-				float sample3 = delayData[(localReadPosition + 2) % mDelayBufferSamples];
-
-				float a0 = -0.5f * sample0 + 1.5f * sample1 - 1.5f * sample2 + 0.5f * sample3;
-				float a1 = sample0 - 2.5f * sample1 + 2.0f * sample2 - 0.5f * sample3;
-				float a2 = -0.5f * sample0 + 0.5f * sample2;
-				float a3 = sample1;
-				outData = a0 * fractionCube + a1 * fractionSqrt + a2 * fraction + a3;
-				break;
-			}
-			}
+				mDelayLine.SetDelay(mDelayTimes.getReadPointer(voice, offset), chunkSamples);
 
-			channelData[sample] = inData + outData * curDepth * curInverted;
-			delayData[localWritePosition] = inData + outData * curFeedback;
+				for (int channel = voice; channel < numChannels; channel += numVoices)
+				{
+					float* channelData = buffer.getWritePointer(channel, start + offset);
+					mDelayLine.Read<interpolation>(channel, delayedData, chunkSamples);
 
-			if (++localWritePosition >= mDelayBufferSamples)
-				localWritePosition -= mDelayBufferSamples;
+					for (int sample = 0; sample < chunkSamples; ++sample)
+					{
+						const float inData = channelData[sample];
+						const float outData = delayedData[sample];
 
-			phase += curFrequency * mInverseSampleRate;
-			if (phase >= 1.0f)
-				phase -= 1.0f;
-		}
+						channelData[sample] = inData + outData * wetGain[offset + sample];
+						feedbackData[sample] = inData + outData * feedback[offset + sample];
+					}
 
-		if (channel == 0)
-			phaseMain = phase;
-	}
+					mDelayLine.Write(channel, feedbackData, chunkSamples);
+				}
+			}
 
-	mDelayWritePosition = localWritePosition;
-	mLfoPhase = phaseMain;
+			mDelayLine.Advance(chunkSamples);
+			offset += chunkSamples;
+		}
+	}
 }
 
 
@@ -8,6 +8,9 @@
 #include "Common/PluginParameterToggle.h"
 #include "Common/PluginParameterComboBox.h"
 #include "Common/Utils.h"
+#include "Common/DelayLine.h"
+#include "Common/LfoGenerator.h"
+#include "Common/SilenceDetector.h"
 
 class FlangerAudioProcessor : public juce::AudioProcessor
 #if JucePlugin_Enable_ARA
@@ -48,24 +51,51 @@ public:
 	void setStateInformation(const void *data, int sizeInBytes) override;
 
 private:
-	float mLfoPhase;
+	// Settings decoded once per block and handed to the processing kernel.
+	// The continuous parameters are rendered per sample by the kernel.
+	struct BlockParameters
+	{
+		bool stereo = false;
+	};
+
+	// Rows of mParameterRamps.
+	enum Ramp
+	{
+		DELAY_RAMP = 0,
+		WIDTH_RAMP,
+		WET_GAIN_RAMP,
+		INVERTED_RAMP,
+		FEEDBACK_RAMP,
+		NUM_RAMPS
+	};
+
+	// The processing loop is instantiated for every interpolation and LFO
+	// waveform, and processBlock() picks one from mKernels once per block.
+	template <Interpolation interpolation, Waveform waveform>
+	void Process(juce::AudioBuffer<float>& buffer, const BlockParameters& parameters);
+
+	using Kernel = void (FlangerAudioProcessor::*)(juce::AudioBuffer<float>&, const BlockParameters&);
+	static const Kernel mKernels[NUM_INTERPOLATIONS][NUM_WAVEFORMS];
+
+	LfoGenerator mLfo;
 	float mInverseSampleRate;
 
-	juce::AudioSampleBuffer mDelayBuffer;
-	int32_t mDelayBufferSamples;
-	int32_t mDelayBufferChannels;
-	int32_t mDelayWritePosition;
+	DelayLine mDelayLine;
+	SilenceDetector mSilence;
+	juce::AudioSampleBuffer mDelayTimes;
+	juce::AudioSampleBuffer mDelayOutput;
+	juce::AudioSampleBuffer mParameterRamps;
 
 	juce::AudioProcessorValueTreeState apvts;
-	PluginParameterSlider mDelay;
-	PluginParameterSlider mWidth;
-	PluginParameterSlider mDepth;
-	PluginParameterSlider mFeedback;
-	PluginParameterToggle mInverted;
-	PluginParameterSlider mFrequency;
-	PluginParameterComboBox mWaveForm;
-	PluginParameterComboBox mInterpolation;
-	PluginParameterToggle mStereo;
+	PluginParameterSlider<ParameterMillisecondsToSeconds> mDelay;
+	PluginParameterSlider<ParameterMillisecondsToSeconds> mWidth;
+	PluginParameterSlider<> mDepth;
+	PluginParameterSlider<> mFeedback;
+	PluginParameterToggle<ParameterToggleToSign> mInverted;
+	PluginParameterSlider<> mFrequency;
+	PluginParameterComboBox<> mWaveForm;
+	PluginParameterComboBox<> mInterpolation;
+	PluginParameterToggle<> mStereo;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FlangerAudioProcessor)
 };
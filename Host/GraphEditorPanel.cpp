@@ -26,6 +26,7 @@
 #include <JuceHeader.h>
 #include "GraphEditorPanel.h"
 #include "PluginInstanceFormat.h"
+#include "PluginInstanceProxy.h"
 #include "MainHostWindow.h"
 
 //==============================================================================
@@ -172,6 +173,7 @@ struct GraphEditorPanel::PinComponent final : public Component,
 //==============================================================================
 struct GraphEditorPanel::PluginComponent final : public Component,
                                                  public Timer,
+                                                 public SettableTooltipClient,
                                                  private AudioProcessorParameter::Listener,
                                                  private AsyncUpdater
 {
@@ -189,6 +191,9 @@ struct GraphEditorPanel::PluginComponent final : public Component,
             }
         }
 
+        if (getLoadMeter() != nullptr)
+            setTooltip ("DSP load in percent of the block period: mean / 99th percentile / max");
+
         setSize (150, 60);
     }
 
@@ -291,7 +296,16 @@ struct GraphEditorPanel::PluginComponent final : public Component,
         g.setColour (boxColour);
         g.fillRect (boxArea.toFloat());
 
-        g.setColour (findColour (TextEditor::textColourId));
+        auto textColour = findColour (TextEditor::textColourId);
+
+        if (loadText.isNotEmpty())
+        {
+            g.setColour (isLoadCritical ? Colours::red : textColour.withAlpha (0.7f));
+            g.setFont (Font (11.0f));
+            g.drawFittedText (loadText, boxArea.removeFromBottom (loadTextHeight).reduced (2, 0), Justification::centred, 1);
+        }
+
+        g.setColour (textColour);
         g.setFont (font);
         g.drawFittedText (getName(), boxArea, Justification::centred, 2);
     }
@@ -357,6 +371,9 @@ struct GraphEditorPanel::PluginComponent final : public Component,
         if (textWidth > 300)
             h = 100;
 
+        if (getLoadMeter() != nullptr)
+            h += loadTextHeight;
+
         setSize (w, h);
         setName (processor.getName() + formatSuffix);
 
@@ -396,6 +413,44 @@ struct GraphEditorPanel::PluginComponent final : public Component,
         return {};
     }
 
+    ProcessLoadMeter* getLoadMeter() const
+    {
+        if (auto* proxy = dynamic_cast<PluginInstanceProxy*> (getProcessor()))
+            return &proxy->getLoadMeter();
+
+        return nullptr;
+    }
+
+    void updateLoad()
+    {
+        auto* meter = getLoadMeter();
+
+        if (meter == nullptr)
+            return;
+
+        const auto stats = meter->getStats();
+
+        String newText;
+
+        if (stats.numBlocks > 0)
+            newText << String (stats.mean, 1) << " / " << String (stats.p99, 1) << " / " << String (stats.max, 1) << "%";
+
+        if (stats.attributedXRuns > 0)
+            newText << "  xruns " << stats.attributedXRuns;
+
+        if (const auto latency = getProcessor()->getLatencySamples(); latency > 0)
+            newText << "  lat " << latency;
+
+        const auto newIsCritical = stats.overruns > 0 || stats.attributedXRuns > 0;
+
+        if (newText != loadText || newIsCritical != isLoadCritical)
+        {
+            loadText = newText;
+            isLoadCritical = newIsCritical;
+            repaint();
+        }
+    }
+
     bool isNodeUsingARA() const
     {
         if (auto node = graph.graph.getNodeForId (pluginID))
@@ -550,6 +605,10 @@ struct GraphEditorPanel::PluginComponent final : public Component,
     std::unique_ptr<PopupMenu> menu;
     std::unique_ptr<FileChooser> fileChooser;
     const String formatSuffix = getFormatSuffix (getProcessor());
+
+    static constexpr int loadTextHeight = 14;
+    String loadText;
+    bool isLoadCritical = false;
 };
 
 
@@ -991,6 +1050,57 @@ void GraphEditorPanel::endDraggingConnector (const MouseEvent& e)
     }
 }
 
+void GraphEditorPanel::updateLoadDisplays (int newXRuns)
+{
+    PluginComponent* busiest = nullptr;
+    float busiestPeak = 0.0f;
+
+    for (auto* fc : nodes)
+    {
+        if (auto* meter = fc->getLoadMeter())
+        {
+            const auto peak = meter->takeRecentPeak();
+
+            if (peak > busiestPeak)
+            {
+                busiest = fc;
+                busiestPeak = peak;
+            }
+        }
+    }
+
+    if (newXRuns > 0 && busiest != nullptr)
+        busiest->getLoadMeter()->addAttributedXRuns (newXRuns);
+
+    for (auto* fc : nodes)
+        fc->updateLoad();
+}
+
+String GraphEditorPanel::getLoadStatisticsAsCsv() const
+{
+    String csv ("node,name,blocks,mean %,p99 %,max %,overruns,xruns,latency samples\n");
+
+    for (auto* fc : nodes)
+    {
+        if (auto* meter = fc->getLoadMeter())
+        {
+            const auto stats = meter->getStats();
+
+            csv << (int) fc->pluginID.uid << ","
+                << fc->getProcessor()->getName().quoted() << ","
+                << stats.numBlocks << ","
+                << String (stats.mean, 2) << ","
+                << String (stats.p99, 2) << ","
+                << String (stats.max, 2) << ","
+                << stats.overruns << ","
+                << stats.attributedXRuns << ","
+                << fc->getProcessor()->getLatencySamples() << "\n";
+        }
+    }
+
+    return csv;
+}
+
 void GraphEditorPanel::timerCallback()
 {
     // this should only be called on touch devices
@@ -1037,6 +1147,33 @@ struct GraphDocumentComponent::TooltipBar final : public Component,
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TooltipBar)
 };
 
+//==============================================================================
+struct GraphDocumentComponent::LoadMonitor final : private Timer
+{
+    explicit LoadMonitor (GraphDocumentComponent& graphDocumentComponent)
+        : owner (graphDocumentComponent)
+    {
+        startTimerHz (10);
+    }
+
+    void timerCallback() override
+    {
+        // Devices that can't count xruns report -1, and a newly opened device starts again from zero.
+        auto* device = owner.deviceManager.getCurrentAudioDevice();
+        const auto xRunCount = device != nullptr ? device->getXRunCount() : -1;
+        const auto newXRuns = (xRunCount >= 0 && lastXRunCount >= 0) ? jmax (0, xRunCount - lastXRunCount) : 0;
+        lastXRunCount = xRunCount;
+
+        if (owner.graphPanel != nullptr)
+            owner.graphPanel->updateLoadDisplays (newXRuns);
+    }
+
+    GraphDocumentComponent& owner;
+    int lastXRunCount = -1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoadMonitor)
+};
+
 //==============================================================================
 class GraphDocumentComponent::TitleBarComponent final : public Component,
                                                         private Button::Listener
@@ -1224,7 +1361,9 @@ void GraphDocumentComponent::init()
 
     graphPanel.reset (new GraphEditorPanel (*graph));
     addAndMakeVisible (graphPanel.get());
-    graphPlayer.setProcessor (&graph->graph);
+    graphRenderer.reset (new ParallelGraphRenderer (graph->graph));
+    graphRenderer->setParallelRenderingEnabled (getAppProperties().getUserSettings()->getBoolValue ("parallelGraphRendering", false));
+    graphPlayer.setProcessor (graphRenderer.get());
 
     keyState.addListener (&graphPlayer.getMidiMessageCollector());
 
@@ -1232,6 +1371,7 @@ void GraphDocumentComponent::init()
     addAndMakeVisible (keyboardComp.get());
     statusBar.reset (new TooltipBar());
     addAndMakeVisible (statusBar.get());
+    loadMonitor.reset (new LoadMonitor (*this));
 
     graphPanel->updateComponents();
 
@@ -1302,6 +1442,8 @@ void GraphDocumentComponent::releaseGraph()
     deviceManager.removeAudioCallback (&graphPlayer);
     deviceManager.removeMidiInputDeviceCallback ({}, &graphPlayer.getMidiMessageCollector());
 
+    loadMonitor = nullptr;
+
     if (graphPanel != nullptr)
     {
         deviceManager.removeChangeListener (graphPanel.get());
@@ -1312,6 +1454,7 @@ void GraphDocumentComponent::releaseGraph()
     statusBar = nullptr;
 
     graphPlayer.setProcessor (nullptr);
+    graphRenderer = nullptr;
     graph = nullptr;
 }
 
@@ -1375,6 +1518,43 @@ void GraphDocumentComponent::setDoublePrecision (bool doublePrecision)
     graphPlayer.setDoublePrecisionProcessing (doublePrecision);
 }
 
+void GraphDocumentComponent::setParallelRendering (bool parallelRendering)
+{
+    if (graphRenderer != nullptr)
+        graphRenderer->setParallelRenderingEnabled (parallelRendering);
+}
+
+void GraphDocumentComponent::exportLoadStatistics()
+{
+    if (graphPanel == nullptr)
+        return;
+
+    // Take the numbers now rather than once a file has been chosen, so they match what's on screen.
+    const auto csv = graphPanel->getLoadStatisticsAsCsv();
+
+    loadStatisticsChooser = std::make_unique<FileChooser> ("Export DSP load statistics",
+                                                           File::getSpecialLocation (File::userDocumentsDirectory).getChildFile ("DSP Load.csv"),
+                                                           "*.csv");
+
+    const auto onChosen = [ref = SafePointer<GraphDocumentComponent> (this), csv] (const FileChooser& chooser)
+    {
+        const auto result = chooser.getResult();
+
+        if (ref == nullptr || result == File())
+            return;
+
+        if (! result.replaceWithText (csv))
+        {
+            auto options = MessageBoxOptions::makeOptionsOk (MessageBoxIconType::WarningIcon,
+                                                             TRANS ("Couldn't export DSP load statistics"),
+                                                             result.getFullPathName());
+            ref->messageBox = AlertWindow::showScopedAsync (options, nullptr);
+        }
+    };
+
+    loadStatisticsChooser->launchAsync (FileBrowserComponent::saveMode | FileBrowserComponent::warnAboutOverwriting, onChosen);
+}
+
 bool GraphDocumentComponent::closeAnyOpenPluginWindows()
 {
     return graphPanel->graph.closeAnyOpenPluginWindows();
@@ -26,6 +26,7 @@
 #pragma once
 
 #include "PluginGraph.h"
+#include "ParallelGraphRenderer.h"
 
 class MainHostWindow;
 
@@ -56,6 +57,12 @@ public:
     //==============================================================================
     void updateComponents();
 
+    /** Refreshes the DSP load shown on the nodes. Device xruns that happened
+        since the last call are blamed on the node with the highest recent load.
+    */
+    void updateLoadDisplays (int newXRuns);
+    String getLoadStatisticsAsCsv() const;
+
     //==============================================================================
     void showPopupMenu (Point<int> position);
 
@@ -113,7 +120,9 @@ public:
     //==============================================================================
     void createNewPlugin (const PluginDescriptionAndPreference&, Point<int> position);
     void setDoublePrecision (bool doublePrecision);
+    void setParallelRendering (bool parallelRendering);
     bool closeAnyOpenPluginWindows();
+    void exportLoadStatistics();
 
     //==============================================================================
     std::unique_ptr<PluginGraph> graph;
@@ -141,12 +150,18 @@ private:
     KnownPluginList& pluginList;
 
     AudioProcessorPlayer graphPlayer;
+    std::unique_ptr<ParallelGraphRenderer> graphRenderer;
     MidiKeyboardState keyState;
     MidiOutput* midiOutput = nullptr;
 
     struct TooltipBar;
     std::unique_ptr<TooltipBar> statusBar;
 
+    struct LoadMonitor;
+    std::unique_ptr<LoadMonitor> loadMonitor;
+    std::unique_ptr<FileChooser> loadStatisticsChooser;
+    ScopedMessageBox messageBox;
+
     class TitleBarComponent;
     std::unique_ptr<TitleBarComponent> titleBarComponent;
 
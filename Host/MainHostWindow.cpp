@@ -552,6 +552,10 @@ PopupMenu MainHostWindow::getMenuForIndex (int topLevelMenuIndex, const String&
         menu.addSeparator();
         menu.addCommandItem (&getCommandManager(), CommandIDs::showAudioSettings);
         menu.addCommandItem (&getCommandManager(), CommandIDs::toggleDoublePrecision);
+        menu.addCommandItem (&getCommandManager(), CommandIDs::toggleParallelRendering);
+       #if ! (JUCE_IOS || JUCE_ANDROID)
+        menu.addCommandItem (&getCommandManager(), CommandIDs::exportLoadStatistics);
+       #endif
 
         if (autoScaleOptionAvailable)
             menu.addCommandItem (&getCommandManager(), CommandIDs::autoScalePluginWindows);
@@ -738,10 +742,12 @@ void MainHostWindow::getAllCommands (Array<CommandID>& commands)
                               CommandIDs::open,
                               CommandIDs::save,
                               CommandIDs::saveAs,
+                              CommandIDs::exportLoadStatistics,
                              #endif
                               CommandIDs::showPluginListEditor,
                               CommandIDs::showAudioSettings,
                               CommandIDs::toggleDoublePrecision,
+                              CommandIDs::toggleParallelRendering,
                               CommandIDs::aboutBox,
                               CommandIDs::allWindowsForward,
                               CommandIDs::autoScalePluginWindows
@@ -778,6 +784,12 @@ void MainHostWindow::getCommandInfo (const CommandID commandID, ApplicationComma
                         category, 0);
         result.defaultKeypresses.add (KeyPress ('s', ModifierKeys::shiftModifier | ModifierKeys::commandModifier, 0));
         break;
+
+    case CommandIDs::exportLoadStatistics:
+        result.setInfo ("Export DSP Load Statistics...",
+                        "Saves the measured load of every node as a CSV file",
+                        category, 0);
+        break;
    #endif
 
     case CommandIDs::showPluginListEditor:
@@ -794,6 +806,10 @@ void MainHostWindow::getCommandInfo (const CommandID commandID, ApplicationComma
         updatePrecisionMenuItem (result);
         break;
 
+    case CommandIDs::toggleParallelRendering:
+        updateParallelRenderingMenuItem (result);
+        break;
+
     case CommandIDs::aboutBox:
         result.setInfo ("About...", {}, category, 0);
         break;
@@ -856,6 +872,11 @@ bool MainHostWindow::perform (const InvocationInfo& info)
         if (graphHolder != nullptr && graphHolder->graph != nullptr)
             graphHolder->graph->saveAsAsync ({}, true, true, true, nullptr);
         break;
+
+    case CommandIDs::exportLoadStatistics:
+        if (graphHolder != nullptr)
+            graphHolder->exportLoadStatistics();
+        break;
    #endif
 
     case CommandIDs::showPluginListEditor:
@@ -884,6 +905,21 @@ bool MainHostWindow::perform (const InvocationInfo& info)
         }
         break;
 
+    case CommandIDs::toggleParallelRendering:
+        if (auto* props = getAppProperties().getUserSettings())
+        {
+            auto newIsParallel = ! isParallelRenderingEnabled();
+            props->setValue ("parallelGraphRendering", var (newIsParallel));
+
+            ApplicationCommandInfo cmdInfo (info.commandID);
+            updateParallelRenderingMenuItem (cmdInfo);
+            menuItemsChanged();
+
+            if (graphHolder != nullptr)
+                graphHolder->setParallelRendering (newIsParallel);
+        }
+        break;
+
     case CommandIDs::autoScalePluginWindows:
         if (auto* props = getAppProperties().getUserSettings())
         {
@@ -1016,6 +1052,14 @@ bool MainHostWindow::isDoublePrecisionProcessingEnabled()
     return false;
 }
 
+bool MainHostWindow::isParallelRenderingEnabled()
+{
+    if (auto* props = getAppProperties().getUserSettings())
+        return props->getBoolValue ("parallelGraphRendering", false);
+
+    return false;
+}
+
 bool MainHostWindow::isAutoScalePluginWindowsEnabled()
 {
     if (auto* props = getAppProperties().getUserSettings())
@@ -1030,6 +1074,12 @@ void MainHostWindow::updatePrecisionMenuItem (ApplicationCommandInfo& info)
     info.setTicked (isDoublePrecisionProcessingEnabled());
 }
 
+void MainHostWindow::updateParallelRenderingMenuItem (ApplicationCommandInfo& info)
+{
+    info.setInfo ("Parallel Graph Rendering", "Render independent branches of the graph on several cores", "General", 0);
+    info.setTicked (isParallelRenderingEnabled());
+}
+
 void MainHostWindow::updateAutoScaleMenuItem (ApplicationCommandInfo& info)
 {
     info.setInfo ("Auto-Scale Plug-in Windows", {}, "General", 0);
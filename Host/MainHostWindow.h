@@ -44,6 +44,10 @@ namespace CommandIDs
     static const int allWindowsForward      = 0x30400;
     static const int toggleDoublePrecision  = 0x30500;
     static const int autoScalePluginWindows = 0x30600;
+    static const int toggleParallelRendering = 0x30700;
+   #if ! (JUCE_IOS || JUCE_ANDROID)
+    static const int exportLoadStatistics   = 0x30800;
+   #endif
 }
 
 //==============================================================================
@@ -118,9 +122,11 @@ private:
     //==============================================================================
     static bool isDoublePrecisionProcessingEnabled();
     static bool isAutoScalePluginWindowsEnabled();
+    static bool isParallelRenderingEnabled();
 
     static void updatePrecisionMenuItem (ApplicationCommandInfo& info);
     static void updateAutoScaleMenuItem (ApplicationCommandInfo& info);
+    static void updateParallelRenderingMenuItem (ApplicationCommandInfo& info);
 
     void showAudioSettings();
 
@@ -0,0 +1,697 @@
+#include <JuceHeader.h>
+#include "ParallelGraphRenderer.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+namespace
+{
+    // With fewer effect nodes than this, or when no two of them can run at the
+    // same time, a block is faster on one thread than split across several.
+    constexpr int minParallelNodes = 3;
+    constexpr int maxWorkers = 7;
+
+    // Workers spin this many times for the next block before going to sleep,
+    // and for a task to become ready before leaving the block to the others.
+    constexpr int spinsBeforeSleeping = 2000;
+    constexpr int spinsBeforeLeaving = 2000;
+
+    // Share of a block's duration after which the audio thread stops waiting
+    // for the workers and renders whatever has not started yet itself.
+    constexpr double maxParallelWait = 0.5;
+
+    /** Tells the core a spin loop is waiting, without giving up the time slice. */
+    inline void pause() noexcept
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #elif JUCE_ARM && (JUCE_GCC || JUCE_CLANG)
+        __asm__ __volatile__ ("yield");
+       #endif
+    }
+
+    //==============================================================================
+    /** Chase-Lev deque of task indices with a fixed capacity, emptied between blocks.
+
+        The owning thread pushes and pops at the bottom, any other thread steals
+        from the top. Every task is pushed once per block, so the capacity never
+        wraps.
+    */
+    class WorkStealingDeque
+    {
+    public:
+        void prepare (int numTasks)
+        {
+            capacity = jmax (1, numTasks);
+            slots.reset (new std::atomic<int>[(size_t) capacity]);
+            clear();
+        }
+
+        void clear() noexcept
+        {
+            top.store (0, std::memory_order_relaxed);
+            bottom.store (0, std::memory_order_relaxed);
+        }
+
+        void push (int task) noexcept
+        {
+            const auto b = bottom.load (std::memory_order_relaxed);
+            slots[(size_t) (b % capacity)].store (task, std::memory_order_relaxed);
+            std::atomic_thread_fence (std::memory_order_release);
+            bottom.store (b + 1, std::memory_order_relaxed);
+        }
+
+        int pop() noexcept
+        {
+            const auto b = bottom.load (std::memory_order_relaxed) - 1;
+            bottom.store (b, std::memory_order_relaxed);
+            std::atomic_thread_fence (std::memory_order_seq_cst);
+            auto t = top.load (std::memory_order_relaxed);
+
+            if (t > b)
+            {
+                bottom.store (b + 1, std::memory_order_relaxed);
+                return -1;
+            }
+
+            auto task = slots[(size_t) (b % capacity)].load (std::memory_order_relaxed);
+
+            if (t == b)
+            {
+                // The last task: whoever moves the top first gets it.
+                if (! top.compare_exchange_strong (t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    task = -1;
+
+                bottom.store (b + 1, std::memory_order_relaxed);
+            }
+
+            return task;
+        }
+
+        int steal() noexcept
+        {
+            auto t = top.load (std::memory_order_acquire);
+            std::atomic_thread_fence (std::memory_order_seq_cst);
+            const auto b = bottom.load (std::memory_order_acquire);
+
+            if (t >= b)
+                return -1;
+
+            const auto task = slots[(size_t) (t % capacity)].load (std::memory_order_relaxed);
+
+            if (! top.compare_exchange_strong (t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return -1;
+
+            return task;
+        }
+
+    private:
+        std::unique_ptr<std::atomic<int>[]> slots;
+        int64 capacity = 1;
+        alignas (64) std::atomic<int64> top { 0 };
+        alignas (64) std::atomic<int64> bottom { 0 };
+    };
+}
+
+//==============================================================================
+struct ParallelGraphRenderer::Plan
+{
+    enum class Kind { processor, audioInput, audioOutput, midiInput, midiOutput };
+
+    struct AudioInput
+    {
+        int source, sourceChannel, channel;
+    };
+
+    /** A node with the buffer it renders into, and where its input comes from. */
+    struct Task
+    {
+        AudioProcessorGraph::Node::Ptr node;
+        Kind kind = Kind::processor;
+
+        AudioBuffer<float> buffer;
+        MidiBuffer midi;
+
+        std::vector<AudioInput> audioInputs;
+        std::vector<int> midiSources;
+        std::vector<int> successors;
+
+        int numDependencies = 0;
+        std::atomic<int> pendingDependencies { 0 };
+
+        // Set by whichever thread renders the task, as the audio thread may take
+        // tasks without going through the deques.
+        std::atomic<bool> claimed { false };
+    };
+
+    void render (Task& task)
+    {
+        task.buffer.clear (0, numSamples);
+        task.midi.clear();
+
+        for (const auto& input : task.audioInputs)
+            task.buffer.addFrom (input.channel, 0, tasks[input.source]->buffer, input.sourceChannel, 0, numSamples);
+
+        for (auto source : task.midiSources)
+            task.midi.addEvents (tasks[source]->midi, 0, numSamples, 0);
+
+        switch (task.kind)
+        {
+            case Kind::audioInput:
+                for (int channel = jmin (task.buffer.getNumChannels(), deviceBuffer->getNumChannels()); --channel >= 0;)
+                    task.buffer.copyFrom (channel, 0, *deviceBuffer, channel, 0, numSamples);
+                break;
+
+            case Kind::midiInput:
+                task.midi.addEvents (*deviceMidi, 0, numSamples, 0);
+                break;
+
+            case Kind::processor:
+            {
+                // The processor's callback lock is not taken: a worker blocked on
+                // it by the message thread would hold up the whole block.
+                AudioBuffer<float> block (task.buffer.getArrayOfWritePointers(), task.buffer.getNumChannels(), numSamples);
+                auto* processor = task.node->getProcessor();
+
+                if (processor->isSuspended())
+                    block.clear();
+                else if (task.node->isBypassed())
+                    processor->processBlockBypassed (block, task.midi);
+                else
+                    processor->processBlock (block, task.midi);
+
+                break;
+            }
+
+            // Collected once the block is done.
+            case Kind::audioOutput:
+            case Kind::midiOutput:
+                break;
+        }
+    }
+
+    OwnedArray<Task> tasks;
+    std::vector<int> order;
+    std::vector<int> roots;
+    std::vector<int> outputs;
+    std::unique_ptr<WorkStealingDeque[]> deques;
+    int maxBlockSize = 0;
+    bool isParallel = false;
+
+    // The block being rendered.
+    AudioBuffer<float>* deviceBuffer = nullptr;
+    MidiBuffer* deviceMidi = nullptr;
+    int numSamples = 0;
+};
+
+//==============================================================================
+class ParallelGraphRenderer::Worker final : public Thread
+{
+public:
+    Worker (ParallelGraphRenderer& o, int participantIndex)
+        : Thread ("Graph worker " + String (participantIndex)),
+          owner (o),
+          participant (participantIndex)
+    {
+    }
+
+    void wake()
+    {
+        if (sleeping.exchange (false))
+            event.signal();
+    }
+
+    void run() override
+    {
+        // Core 0 is left to the audio device thread. There are fewer workers
+        // than cores, so every worker gets a core of its own that exists.
+        if (participant < jmin (32, SystemStats::getNumCpus()))
+            Thread::setCurrentThreadAffinityMask ((uint32) 1 << participant);
+
+        auto lastCycle = owner.cycle.load();
+
+        while (! threadShouldExit())
+        {
+            if (! waitForCycle (lastCycle))
+                continue;
+
+            lastCycle = owner.cycle.load();
+
+            // A worker arriving after the barrier finds the block closed.
+            owner.activeWorkers.fetch_add (1);
+
+            if (owner.cycleOpen.load())
+                owner.runTasks (participant);
+
+            owner.activeWorkers.fetch_sub (1);
+        }
+    }
+
+private:
+    bool waitForCycle (uint32 lastCycle)
+    {
+        for (int i = 0; i < spinsBeforeSleeping; ++i)
+            if (owner.cycle.load() != lastCycle)
+                return true;
+
+        sleeping = true;
+
+        if (owner.cycle.load() == lastCycle)
+            event.wait (100);
+
+        sleeping = false;
+        return owner.cycle.load() != lastCycle;
+    }
+
+    ParallelGraphRenderer& owner;
+    const int participant;
+    WaitableEvent event;
+    std::atomic<bool> sleeping { false };
+};
+
+//==============================================================================
+ParallelGraphRenderer::ParallelGraphRenderer (AudioProcessorGraph& g)
+    : graph (g),
+      numWorkers (jlimit (0, maxWorkers, SystemStats::getNumCpus() - 1))
+{
+    graph.addChangeListener (this);
+}
+
+ParallelGraphRenderer::~ParallelGraphRenderer()
+{
+    graph.removeChangeListener (this);
+    setParallelRenderingEnabled (false);
+}
+
+void ParallelGraphRenderer::setParallelRenderingEnabled (bool shouldBeEnabled)
+{
+    if (shouldBeEnabled == parallelEnabled)
+        return;
+
+    if (shouldBeEnabled)
+    {
+        startWorkers();
+
+        const SpinLock::ScopedLockType sl (planLock);
+        parallelEnabled = true;
+    }
+    else
+    {
+        // Once the flag is down under the lock no block can start on the workers.
+        {
+            const SpinLock::ScopedLockType sl (planLock);
+            parallelEnabled = false;
+        }
+
+        stopWorkers();
+    }
+}
+
+bool ParallelGraphRenderer::isRenderingInParallel() const noexcept
+{
+    const SpinLock::ScopedLockType sl (planLock);
+    return parallelEnabled && plan != nullptr && plan->isParallel;
+}
+
+void ParallelGraphRenderer::waitForWorkersToLeave()
+{
+    // A worker may still be leaving the last block, which only takes it a few
+    // loads of the plan's atomics.
+    while (activeWorkers.load() > 0)
+        Thread::yield();
+}
+
+void ParallelGraphRenderer::startWorkers()
+{
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto* worker = workers.add (new Worker (*this, i + 1));
+        worker->startRealtimeThread (Thread::RealtimeOptions{}.withPriority (10));
+    }
+}
+
+void ParallelGraphRenderer::stopWorkers()
+{
+    for (auto* worker : workers)
+    {
+        worker->signalThreadShouldExit();
+        worker->wake();
+    }
+
+    for (auto* worker : workers)
+        worker->stopThread (1000);
+
+    workers.clear();
+}
+
+//==============================================================================
+void ParallelGraphRenderer::prepareToPlay (double sampleRate, int estimatedSamplesPerBlock)
+{
+    graph.setProcessingPrecision (getProcessingPrecision());
+    graph.setPlayConfigDetails (getTotalNumInputChannels(), getTotalNumOutputChannels(), sampleRate, estimatedSamplesPerBlock);
+    graph.prepareToPlay (sampleRate, estimatedSamplesPerBlock);
+
+    rebuildPlan();
+}
+
+void ParallelGraphRenderer::releaseResources()
+{
+    std::unique_ptr<Plan> oldPlan;
+
+    {
+        const SpinLock::ScopedLockType sl (planLock);
+        std::swap (plan, oldPlan);
+    }
+
+    waitForWorkersToLeave();
+    oldPlan.reset();
+
+    graph.releaseResources();
+}
+
+void ParallelGraphRenderer::reset()
+{
+    graph.reset();
+}
+
+void ParallelGraphRenderer::setNonRealtime (bool isNonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime (isNonRealtime);
+    graph.setNonRealtime (isNonRealtime);
+}
+
+void ParallelGraphRenderer::changeListenerCallback (ChangeBroadcaster*)
+{
+    rebuildPlan();
+}
+
+void ParallelGraphRenderer::rebuildPlan()
+{
+    // The graph only prepares new nodes on the message thread; it sends a change
+    // message once it has, and the plan is built from there.
+    if (! MessageManager::existsAndIsCurrentThread() || getBlockSize() <= 0)
+        return;
+
+    graph.rebuild();
+
+    using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+
+    auto newPlan = std::make_unique<Plan>();
+    newPlan->maxBlockSize = getBlockSize();
+
+    bool needsLatencyCompensation = false;
+    std::map<uint32, int> taskIndices;
+
+    for (auto* node : graph.getNodes())
+    {
+        auto* processor = node->getProcessor();
+        auto* task = newPlan->tasks.add (new Plan::Task());
+        task->node = node;
+
+        if (auto* io = dynamic_cast<IOProcessor*> (processor))
+        {
+            switch (io->getType())
+            {
+                case IOProcessor::audioInputNode:   task->kind = Plan::Kind::audioInput;  break;
+                case IOProcessor::audioOutputNode:  task->kind = Plan::Kind::audioOutput; break;
+                case IOProcessor::midiInputNode:    task->kind = Plan::Kind::midiInput;   break;
+                case IOProcessor::midiOutputNode:   task->kind = Plan::Kind::midiOutput;  break;
+                default:                            break;
+            }
+        }
+
+        if (processor->getLatencySamples() > 0)
+            needsLatencyCompensation = true;
+
+        const auto numChannels = jmax (1, processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels());
+        task->buffer.setSize (numChannels, newPlan->maxBlockSize);
+        task->midi.ensureSize (2048);
+
+        if (task->kind == Plan::Kind::audioOutput || task->kind == Plan::Kind::midiOutput)
+            newPlan->outputs.push_back (newPlan->tasks.size() - 1);
+
+        taskIndices[node->nodeID.uid] = newPlan->tasks.size() - 1;
+    }
+
+    for (const auto& connection : graph.getConnections())
+    {
+        const auto source = taskIndices.find (connection.source.nodeID.uid);
+        const auto destination = taskIndices.find (connection.destination.nodeID.uid);
+
+        if (source == taskIndices.end() || destination == taskIndices.end())
+            continue;
+
+        auto& sourceTask = *newPlan->tasks[source->second];
+        auto& task = *newPlan->tasks[destination->second];
+
+        if (connection.source.isMIDI())
+        {
+            task.midiSources.push_back (source->second);
+        }
+        else if (connection.source.channelIndex < sourceTask.buffer.getNumChannels()
+                 && connection.destination.channelIndex < task.buffer.getNumChannels())
+        {
+            task.audioInputs.push_back ({ source->second, connection.source.channelIndex, connection.destination.channelIndex });
+        }
+
+        auto& successors = sourceTask.successors;
+        if (std::find (successors.begin(), successors.end(), destination->second) == successors.end())
+        {
+            successors.push_back (destination->second);
+            ++task.numDependencies;
+        }
+    }
+
+    // Depth of every node along its longest input path; nodes at the same depth
+    // can always run at the same time.
+    const auto numTasks = newPlan->tasks.size();
+    std::vector<int> depths ((size_t) numTasks, 0), pending ((size_t) numTasks), ready;
+    std::map<int, int> widths;
+
+    for (int i = 0; i < numTasks; ++i)
+    {
+        pending[(size_t) i] = newPlan->tasks[i]->numDependencies;
+
+        if (pending[(size_t) i] == 0)
+        {
+            newPlan->roots.push_back (i);
+            ready.push_back (i);
+        }
+    }
+
+    int numProcessors = 0;
+
+    while (! ready.empty())
+    {
+        const auto index = ready.back();
+        ready.pop_back();
+        newPlan->order.push_back (index);
+
+        if (newPlan->tasks[index]->kind == Plan::Kind::processor)
+        {
+            ++numProcessors;
+            ++widths[depths[(size_t) index]];
+        }
+
+        for (auto successor : newPlan->tasks[index]->successors)
+        {
+            depths[(size_t) successor] = jmax (depths[(size_t) successor], depths[(size_t) index] + 1);
+
+            if (--pending[(size_t) successor] == 0)
+                ready.push_back (successor);
+        }
+    }
+
+    int maxWidth = 0;
+    for (const auto& width : widths)
+        maxWidth = jmax (maxWidth, width.second);
+
+    newPlan->isParallel = numWorkers > 0
+                       && ! needsLatencyCompensation
+                       && numProcessors >= minParallelNodes
+                       && maxWidth >= 2;
+
+    newPlan->deques.reset (new WorkStealingDeque[(size_t) numWorkers + 1]);
+    for (int i = 0; i <= numWorkers; ++i)
+        newPlan->deques[(size_t) i].prepare (numTasks);
+
+    {
+        const SpinLock::ScopedLockType sl (planLock);
+        std::swap (plan, newPlan);
+    }
+
+    // The old plan goes once no worker can be looking at it.
+    waitForWorkersToLeave();
+}
+
+//==============================================================================
+void ParallelGraphRenderer::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midi)
+{
+    if (! renderInParallel (buffer, midi))
+        graph.processBlock (buffer, midi);
+}
+
+void ParallelGraphRenderer::processBlock (AudioBuffer<double>& buffer, MidiBuffer& midi)
+{
+    graph.processBlock (buffer, midi);
+}
+
+bool ParallelGraphRenderer::renderInParallel (AudioBuffer<float>& buffer, MidiBuffer& midi)
+{
+    const SpinLock::ScopedTryLockType sl (planLock);
+
+    if (! sl.isLocked() || ! parallelEnabled || plan == nullptr || ! plan->isParallel
+        || buffer.getNumSamples() > plan->maxBlockSize)
+        return false;
+
+    // A worker still on its way out of the last block would see this one's
+    // deques being reset, so this block goes to the serial renderer instead
+    // of waiting for it.
+    if (activeWorkers.load() > 0)
+        return false;
+
+    auto& p = *plan;
+    p.deviceBuffer = &buffer;
+    p.deviceMidi = &midi;
+    p.numSamples = buffer.getNumSamples();
+
+    for (auto* task : p.tasks)
+    {
+        task->pendingDependencies.store (task->numDependencies, std::memory_order_relaxed);
+        task->claimed.store (false, std::memory_order_relaxed);
+    }
+
+    for (int i = 0; i <= numWorkers; ++i)
+        p.deques[(size_t) i].clear();
+
+    // Spread the first nodes so the workers do not start by stealing.
+    for (size_t i = 0; i < p.roots.size(); ++i)
+        p.deques[i % (size_t) (numWorkers + 1)].push (p.roots[i]);
+
+    activePlan = &p;
+    remainingTasks.store (p.tasks.size());
+    cycleOpen.store (true);
+    cycle.fetch_add (1);
+
+    for (auto* worker : workers)
+        worker->wake();
+
+    const auto deadline = Time::getHighResolutionTicks()
+                        + (int64) (maxParallelWait * p.numSamples / getSampleRate() * (double) Time::getHighResolutionTicksPerSecond());
+
+    while (remainingTasks.load (std::memory_order_acquire) > 0)
+    {
+        const auto index = takeTask (0);
+
+        if (index >= 0)
+            runTask (0, index);
+        else if (Time::getHighResolutionTicks() < deadline)
+            pause();
+        else
+            renderRemainingTasks();
+    }
+
+    // Workers leave on their own once they see nothing is left.
+    cycleOpen.store (false);
+
+    buffer.clear();
+    midi.clear();
+
+    for (auto index : p.outputs)
+    {
+        auto& task = *p.tasks[index];
+
+        if (task.kind == Plan::Kind::midiOutput)
+        {
+            midi.addEvents (task.midi, 0, p.numSamples, 0);
+            continue;
+        }
+
+        for (int channel = jmin (task.buffer.getNumChannels(), buffer.getNumChannels()); --channel >= 0;)
+            buffer.addFrom (channel, 0, task.buffer, channel, 0, p.numSamples);
+    }
+
+    return true;
+}
+
+void ParallelGraphRenderer::renderRemainingTasks()
+{
+    auto& p = *activePlan;
+
+    // The workers finish the node they are on and take no more. Every node not
+    // started yet is rendered here in serial order, so the only thing left to
+    // wait for is a node that was already running on a worker.
+    cycleOpen.store (false);
+
+    for (auto index : p.order)
+    {
+        auto& task = *p.tasks[index];
+
+        if (task.claimed.exchange (true, std::memory_order_acq_rel))
+            continue;
+
+        while (task.pendingDependencies.load (std::memory_order_acquire) > 0)
+            pause();
+
+        runTask (0, index);
+    }
+
+    while (remainingTasks.load (std::memory_order_acquire) > 0)
+        pause();
+}
+
+int ParallelGraphRenderer::takeTask (int participant)
+{
+    auto& p = *activePlan;
+    const int numParticipants = numWorkers + 1;
+    auto index = p.deques[(size_t) participant].pop();
+
+    for (int i = 1; index < 0 && i < numParticipants; ++i)
+        index = p.deques[(size_t) ((participant + i) % numParticipants)].steal();
+
+    // Past the deadline the audio thread takes tasks straight from the plan.
+    if (index >= 0 && p.tasks[index]->claimed.exchange (true, std::memory_order_acq_rel))
+        return -1;
+
+    return index;
+}
+
+void ParallelGraphRenderer::runTask (int participant, int index)
+{
+    auto& p = *activePlan;
+    auto& task = *p.tasks[index];
+    p.render (task);
+
+    for (auto successor : task.successors)
+        if (p.tasks[successor]->pendingDependencies.fetch_sub (1, std::memory_order_acq_rel) == 1)
+            p.deques[(size_t) participant].push (successor);
+
+    remainingTasks.fetch_sub (1, std::memory_order_acq_rel);
+}
+
+void ParallelGraphRenderer::runTasks (int participant)
+{
+    int idleSpins = 0;
+
+    while (cycleOpen.load() && remainingTasks.load (std::memory_order_acquire) > 0)
+    {
+        const auto index = takeTask (participant);
+
+        if (index >= 0)
+        {
+            runTask (participant, index);
+            idleSpins = 0;
+        }
+        else if (++idleSpins < spinsBeforeLeaving)
+        {
+            pause();
+        }
+        else
+        {
+            // Nothing has been ready for a while; the audio thread and the
+            // other workers finish the block.
+            return;
+        }
+    }
+}
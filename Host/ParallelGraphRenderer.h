@@ -0,0 +1,104 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Plays an AudioProcessorGraph with its independent branches spread over
+    several cores.
+
+    The renderer sits between the AudioProcessorPlayer and the graph. With
+    parallel rendering off, or for graphs where it cannot pay for the
+    synchronisation, every block simply goes to the graph's own serial render
+    sequence. Otherwise the nodes are scheduled by their connections: a node is
+    ready once every node feeding it has run, and ready nodes are taken by the
+    audio thread and a pool of pinned real-time workers. Each thread owns a
+    lock-free work-stealing deque of ready nodes and steals from the others
+    when its own runs dry. The audio thread never yields or sleeps: when it
+    finds nothing ready it spins, and once half the block's duration has gone
+    it stops the workers from taking more nodes and renders every node not yet
+    started itself, so it only ever waits for nodes already running. A block
+    starts in parallel only when every worker has left the previous one,
+    otherwise it goes to the serial renderer.
+
+    The plan is rebuilt on the message thread whenever the graph changes, and
+    handed to the audio thread under a spin lock, like the graph does with its
+    own render sequence. Graphs that need latency compensation, double
+    precision processing and blocks larger than prepared are left to the graph.
+*/
+class ParallelGraphRenderer final : public AudioProcessor,
+                                    private ChangeListener
+{
+public:
+    //==============================================================================
+    explicit ParallelGraphRenderer (AudioProcessorGraph&);
+    ~ParallelGraphRenderer() override;
+
+    //==============================================================================
+    void setParallelRenderingEnabled (bool shouldBeEnabled);
+    bool isParallelRenderingEnabled() const noexcept        { return parallelEnabled; }
+
+    /** True when the current graph is rendered in parallel rather than serially. */
+    bool isRenderingInParallel() const noexcept;
+
+    //==============================================================================
+    const String getName() const override                   { return graph.getName(); }
+    void prepareToPlay (double sampleRate, int estimatedSamplesPerBlock) override;
+    void releaseResources() override;
+    void reset() override;
+    void setNonRealtime (bool isNonRealtime) noexcept override;
+
+    void processBlock (AudioBuffer<float>&, MidiBuffer&) override;
+    void processBlock (AudioBuffer<double>&, MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return graph.supportsDoublePrecisionProcessing(); }
+
+    double getTailLengthSeconds() const override            { return graph.getTailLengthSeconds(); }
+    bool acceptsMidi() const override                       { return true; }
+    bool producesMidi() const override                      { return true; }
+    bool hasEditor() const override                         { return false; }
+    AudioProcessorEditor* createEditor() override           { return nullptr; }
+    int getNumPrograms() override                           { return 0; }
+    int getCurrentProgram() override                        { return 0; }
+    void setCurrentProgram (int) override                   {}
+    const String getProgramName (int) override              { return {}; }
+    void changeProgramName (int, const String&) override    {}
+    void getStateInformation (MemoryBlock&) override        {}
+    void setStateInformation (const void*, int) override    {}
+
+private:
+    //==============================================================================
+    struct Plan;
+    class Worker;
+
+    void changeListenerCallback (ChangeBroadcaster*) override;
+    void rebuildPlan();
+
+    void startWorkers();
+    void stopWorkers();
+
+    bool renderInParallel (AudioBuffer<float>&, MidiBuffer&);
+    void renderRemainingTasks();
+    int takeTask (int participant);
+    void runTask (int participant, int index);
+    void runTasks (int participant);
+    void waitForWorkersToLeave();
+
+    //==============================================================================
+    AudioProcessorGraph& graph;
+
+    std::unique_ptr<Plan> plan;
+    SpinLock planLock;
+    bool parallelEnabled = false;
+
+    OwnedArray<Worker> workers;
+    const int numWorkers;
+
+    // State of the block being rendered, shared between the audio thread and the workers.
+    Plan* activePlan = nullptr;
+    std::atomic<uint32> cycle { 0 };
+    std::atomic<bool> cycleOpen { false };
+    std::atomic<int> remainingTasks { 0 };
+    std::atomic<int> activeWorkers { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParallelGraphRenderer)
+};
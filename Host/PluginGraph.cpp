@@ -70,6 +70,21 @@ void PluginGraph::changeListenerCallback (ChangeBroadcaster*)
             activePluginWindows.remove (i);
 }
 
+void PluginGraph::audioProcessorChanged (AudioProcessor* processor, const ChangeDetails& details)
+{
+    if (processor == &graph)
+    {
+        changed();
+        return;
+    }
+
+    // A plugin changed its latency, possibly from the audio thread. The graph
+    // only recomputes its delay compensation when it is rebuilt, which the
+    // renderer does on the message thread in answer to the change message.
+    if (details.latencyChanged)
+        graph.sendChangeMessage();
+}
+
 AudioProcessorGraph::Node::Ptr PluginGraph::getNodeForName (const String& name) const
 {
     for (auto* node : graph.getNodes())
@@ -119,6 +134,7 @@ void PluginGraph::addPluginCallback (std::unique_ptr<AudioPluginInstance> instan
 
         if (auto node = graph.addNode (std::move (instance)))
         {
+            node->getProcessor()->addListener (this);
             node->properties.set ("x", pos.x);
             node->properties.set ("y", pos.y);
             node->properties.set ("useARA", useARA == PluginDescriptionAndPreference::UseARA::yes);
@@ -457,6 +473,8 @@ void PluginGraph::createNodeFromXml (const XmlElement& xml)
 
         if (auto node = graph.addNode (std::move (instance), NodeID ((uint32) xml.getIntAttribute ("uid"))))
         {
+            node->getProcessor()->addListener (this);
+
             if (auto* state = xml.getChildByName ("STATE"))
             {
                 MemoryBlock m;
@@ -83,7 +83,7 @@ public:
 
     //==============================================================================
     void audioProcessorParameterChanged (AudioProcessor*, int, float) override {}
-    void audioProcessorChanged (AudioProcessor*, const ChangeDetails&) override { changed(); }
+    void audioProcessorChanged (AudioProcessor*, const ChangeDetails&) override;
 
     //==============================================================================
     std::unique_ptr<XmlElement> createXml() const;
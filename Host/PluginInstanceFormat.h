@@ -25,7 +25,7 @@
 
 #pragma once
 
-#include "PluginGraph.h"
+#include <JuceHeader.h>
 
 //==============================================================================
 /**
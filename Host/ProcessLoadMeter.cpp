@@ -0,0 +1,54 @@
+#include "ProcessLoadMeter.h"
+
+void ProcessLoadMeter::record (int64 elapsedTicks, int numSamples, double sampleRate) noexcept
+{
+    if (numSamples <= 0 || sampleRate <= 0.0)
+        return;
+
+    const auto period = (double) numSamples / sampleRate;
+    const auto load = (float) (100.0 * Time::highResolutionTicksToSeconds (elapsedTicks) / period);
+
+    // Only the audio thread writes, so plain loads and stores are enough.
+    const auto index = numRecorded.load (std::memory_order_relaxed);
+    loads[(size_t) (index % ringSize)].store (load, std::memory_order_relaxed);
+    numRecorded.store (index + 1, std::memory_order_release);
+
+    if (load > recentPeak.load (std::memory_order_relaxed))
+        recentPeak.store (load, std::memory_order_relaxed);
+
+    if (load >= 100.0f)
+        overruns.fetch_add (1, std::memory_order_relaxed);
+}
+
+ProcessLoadMeter::Stats ProcessLoadMeter::getStats() const
+{
+    Stats stats;
+    stats.overruns = overruns.load (std::memory_order_relaxed);
+    stats.attributedXRuns = attributedXRuns;
+
+    const auto recorded = numRecorded.load (std::memory_order_acquire);
+    stats.numBlocks = (int) jmin ((uint32) ringSize, recorded);
+
+    if (stats.numBlocks == 0)
+        return stats;
+
+    // The oldest entries may be overwritten while copying; at this ring size
+    // that blurs the statistics by a block or two at most.
+    std::array<float, ringSize> values;
+    double sum = 0.0;
+
+    for (int i = 0; i < stats.numBlocks; ++i)
+    {
+        values[(size_t) i] = loads[(size_t) ((recorded - 1 - (uint32) i) % ringSize)].load (std::memory_order_relaxed);
+        sum += values[(size_t) i];
+        stats.max = jmax (stats.max, values[(size_t) i]);
+    }
+
+    stats.mean = (float) (sum / stats.numBlocks);
+
+    const auto p99Index = (size_t) ((stats.numBlocks - 1) * 99 / 100);
+    std::nth_element (values.begin(), values.begin() + (std::ptrdiff_t) p99Index, values.begin() + stats.numBlocks);
+    stats.p99 = values[p99Index];
+
+    return stats;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Measures how much of the block period one node's processBlock takes.
+
+    The audio thread records every block into a fixed ring of loads without
+    locking or allocating; the message thread reads the ring back to compute
+    statistics over the most recent blocks. Loads are in percent of the block
+    period, so 100% on one node alone is a guaranteed dropout.
+*/
+class ProcessLoadMeter
+{
+public:
+    struct Stats
+    {
+        int numBlocks = 0;
+        float mean = 0.0f, p99 = 0.0f, max = 0.0f;
+        int overruns = 0;
+        int attributedXRuns = 0;
+    };
+
+    //==============================================================================
+    /** Times a processBlock call on the audio thread. */
+    struct ScopedTimer
+    {
+        ScopedTimer (ProcessLoadMeter& m, int samples, double rate) noexcept
+            : meter (m), numSamples (samples), sampleRate (rate), start (Time::getHighResolutionTicks())
+        {
+        }
+
+        ~ScopedTimer() noexcept
+        {
+            meter.record (Time::getHighResolutionTicks() - start, numSamples, sampleRate);
+        }
+
+        ProcessLoadMeter& meter;
+        const int numSamples;
+        const double sampleRate;
+        const int64 start;
+    };
+
+    void record (int64 elapsedTicks, int numSamples, double sampleRate) noexcept;
+
+    //==============================================================================
+    /** Statistics over the blocks still in the ring. */
+    Stats getStats() const;
+
+    /** The highest load since the last call, used to pin device xruns on a node. */
+    float takeRecentPeak() noexcept         { return recentPeak.exchange (0.0f); }
+
+    void addAttributedXRuns (int numXRuns)  { attributedXRuns += numXRuns; }
+
+private:
+    static constexpr int ringSize = 1024;
+
+    std::array<std::atomic<float>, ringSize> loads {};
+    std::atomic<uint32> numRecorded { 0 };
+    std::atomic<int> overruns { 0 };
+    std::atomic<float> recentPeak { 0.0f };
+
+    // Message thread only.
+    int attributedXRuns = 0;
+};
@@ -1,6 +1,13 @@
 
 #include "PluginProcessor.h"
+#include "Common/Utils.h"
 
+namespace
+{
+    // Every change of lookahead is a change of latency, which the host has to
+    // compensate, so it is a choice rather than a continuous value.
+    const float lookaheadChoicesMs[] = { 0.0f, 1.0f, 2.0f, 5.0f, GateEngine::MAX_LOOKAHEAD_MS };
+}
 
 NoiseGateAudioProcessor::NoiseGateAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -8,6 +15,7 @@ NoiseGateAudioProcessor::NoiseGateAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
@@ -16,10 +24,18 @@ NoiseGateAudioProcessor::NoiseGateAudioProcessor()
 {
     addParameter(threshold = new juce::AudioParameterFloat("threshold", "Threshold", 0.0f, 1.0f, 0.5f));
     addParameter(alpha = new juce::AudioParameterFloat("alpha","Alpha",0.0f,1.0f,0.8f));
+    addParameter(attack = new juce::AudioParameterFloat("attack", "Attack", juce::NormalisableRange<float>(0.1f, 50.0f, 0.0f, 0.5f), 1.0f, "ms"));
+    addParameter(hold = new juce::AudioParameterFloat("hold", "Hold", juce::NormalisableRange<float>(0.0f, 1000.0f, 0.0f, 0.5f), 50.0f, "ms"));
+    addParameter(release = new juce::AudioParameterFloat("release", "Release", juce::NormalisableRange<float>(1.0f, 1000.0f, 0.0f, 0.5f), 100.0f, "ms"));
+    addParameter(lookahead = new juce::AudioParameterChoice("lookahead", "Lookahead", juce::StringArray{ "Off", "1 ms", "2 ms", "5 ms", "10 ms" }, 0));
+    addParameter(keySource = new juce::AudioParameterChoice("key", "Key", juce::StringArray{ "Input", "Sidechain" }, 0));
+    addParameter(keyFilter = new juce::AudioParameterChoice("keyFilter", "Key Filter", juce::StringArray{ "Off", "High Pass", "Low Pass" }, 0));
+    addParameter(keyFrequency = new juce::AudioParameterFloat("keyFrequency", "Key Frequency", juce::NormalisableRange<float>(20.0f, 20000.0f, 0.0f, 0.25f), 1000.0f, "Hz"));
 }
 
 NoiseGateAudioProcessor::~NoiseGateAudioProcessor()
 {
+    cancelPendingUpdate();
 }
 
 
@@ -57,7 +73,8 @@ bool NoiseGateAudioProcessor::isMidiEffect() const
 
 double NoiseGateAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // Whatever is in the lookahead still comes out, the gate adds nothing.
+    return lookaheadChoicesMs[appliedLookahead.load()] * 0.001;
 }
 
 int NoiseGateAudioProcessor::getNumPrograms()
@@ -87,8 +104,21 @@ void NoiseGateAudioProcessor::changeProgramName (int index, const juce::String&
 
 void NoiseGateAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    lowPassCoeff = 0.0f;
-    sampleCountDown = 0;
+    // The key is at most as wide as the widest input bus.
+    gate.Prepare(sampleRate, getMainBusNumInputChannels(), samplesPerBlock,
+                 juce::jmax(getMainBusNumInputChannels(), getTotalNumInputChannels() - getMainBusNumInputChannels()));
+    appliedLookahead = lookahead->getIndex();
+    gate.SetParameters(getGateParameters());
+    setLatencySamples(gate.GetLatencySamples());
+    silence.Prepare(sampleRate);
+}
+
+void NoiseGateAudioProcessor::handleAsyncUpdate()
+{
+    // The same rounding as the gate's, so the reported latency is its delay.
+    const int index = lookahead->getIndex();
+    setLatencySamples(juce::roundToInt(lookaheadChoicesMs[index] * (0.001 * getSampleRate())));
+    appliedLookahead = index;
 }
 
 void NoiseGateAudioProcessor::releaseResources()
@@ -100,37 +130,57 @@ void NoiseGateAudioProcessor::releaseResources()
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool NoiseGateAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-	return layouts.getMainInputChannelSet() == layouts.getMainOutputChannelSet()&& !layouts.getMainInputChannelSet().isDisabled();
+	if (!IsMatchingBusesLayout(layouts))
+		return false;
+
+	// The sidechain is optional, mono or stereo.
+	if (layouts.inputBuses.size() > 1)
+	{
+		const auto sideChain = layouts.getChannelSet(true, 1);
+		return sideChain.isDisabled() || sideChain == juce::AudioChannelSet::mono() || sideChain == juce::AudioChannelSet::stereo();
+	}
+	return true;
 }
 #endif
 
 void NoiseGateAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-	auto mainInputOutput = getBusBuffer(buffer, true, 0);                                 
+	auto mainInputOutput = getBusBuffer(buffer, true, 0);
 
-	auto alphaCopy = alpha->get();                                                         
-	auto thresholdCopy = threshold->get();
+	// Bus buffers refer to the host's channels, so the key is never copied.
+	const bool useSideChain = keySource->getIndex() == 1 && getBusCount(true) > 1 && getChannelCountOfBus(true, 1) > 0;
+	auto key = getBusBuffer(buffer, true, useSideChain ? 1 : 0);
 
-	for (auto j = 0; j < buffer.getNumSamples(); ++j)                                     
-	{
-		auto mixedSamples = 0.0f;
-
-		for (auto i = 0; i < mainInputOutput.getNumChannels(); ++i)
-			mixedSamples += mainInputOutput.getReadPointer(i)[j];
+	if (lookahead->getIndex() != appliedLookahead.load())
+		triggerAsyncUpdate();
 
-		mixedSamples /= static_cast<float> (mainInputOutput.getNumChannels());
-		lowPassCoeff = (alphaCopy * lowPassCoeff) + ((1.0f - alphaCopy) * mixedSamples); 
+	gate.SetParameters(getGateParameters());
 
-		if (lowPassCoeff >= thresholdCopy)                                               
-			sampleCountDown = (int)getSampleRate();
+	// A gate only ever passes or mutes its input, so silence needs no processing.
+	// The envelope and the hold time still move on as if it had run, which
+	// needs a silent key as well.
+	const bool inputIsSilent = silence.Process(mainInputOutput, mainInputOutput.getNumChannels(), getTailLengthSeconds());
+	if (inputIsSilent && (!useSideChain || SilenceDetector::IsSilent(key, key.getNumChannels())))
+	{
+		gate.Skip(buffer.getNumSamples());
+		return;
+	}
 
-		for (auto i = 0; i < mainInputOutput.getNumChannels(); ++i)
-			*mainInputOutput.getWritePointer(i, j) = sampleCountDown > 0 ? *mainInputOutput.getReadPointer(i, j)
-			: 0.0f;
+	gate.Process(juce::dsp::AudioBlock<float>(mainInputOutput), juce::dsp::AudioBlock<float>(key));
+}
 
-		if (sampleCountDown > 0)                                                         
-			--sampleCountDown;
-	}
+GateEngine::Parameters NoiseGateAudioProcessor::getGateParameters() const
+{
+	GateEngine::Parameters parameters;
+	parameters.threshold = threshold->get();
+	parameters.smoothing = alpha->get();
+	parameters.attackMs = attack->get();
+	parameters.holdMs = hold->get();
+	parameters.releaseMs = release->get();
+	parameters.lookaheadMs = lookaheadChoicesMs[appliedLookahead.load()];
+	parameters.keyFilter = (GateEngine::KeyFilter)keyFilter->getIndex();
+	parameters.keyFrequency = keyFrequency->get();
+	return parameters;
 }
 
 
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <JuceHeader.h>
-class NoiseGateAudioProcessor  : public juce::AudioProcessor
+#include "Common/GateEngine.h"
+#include "Common/SilenceDetector.h"
+class NoiseGateAudioProcessor  : public juce::AudioProcessor,
+                                 private juce::AsyncUpdater
 {
 public:
     
@@ -42,10 +45,26 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
 
 private:
+    GateEngine::Parameters getGateParameters() const;
+
+    // Applies a new lookahead choice together with the latency it reports,
+    // which the host must only be told from the message thread.
+    void handleAsyncUpdate() override;
+
     juce::AudioParameterFloat* threshold;
     juce::AudioParameterFloat* alpha;
-    int sampleCountDown;
-    float lowPassCoeff;
+    juce::AudioParameterFloat* attack;
+    juce::AudioParameterFloat* hold;
+    juce::AudioParameterFloat* release;
+    juce::AudioParameterChoice* lookahead;
+    // The lookahead choice the gate runs with; until a new one is applied the
+    // current delay stays.
+    std::atomic<int> appliedLookahead { 0 };
+    juce::AudioParameterChoice* keySource;
+    juce::AudioParameterChoice* keyFilter;
+    juce::AudioParameterFloat* keyFrequency;
+    GateEngine gate;
+    SilenceDetector silence;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NoiseGateAudioProcessor)
 };
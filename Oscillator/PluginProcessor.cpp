@@ -1,4 +1,48 @@
 #include "PluginProcessor.h"
+#include "Common/Utils.h"
+#include "Common/AssetEditor.h"
+
+namespace
+{
+	constexpr int WAVETABLE_SIZE = 2048;
+
+	// Anything longer is not a single cycle.
+	constexpr double MAX_WAVETABLE_SECONDS = 1.0;
+
+	// The whole file is one cycle: the channels are mixed, stretched to
+	// WAVETABLE_SIZE samples and normalised to a peak of 1. A guard sample
+	// repeats the start so the interpolation never wraps.
+	std::shared_ptr<const std::vector<float>> CreateWavetable(const AudioAsset& asset)
+	{
+		const auto& buffer = asset.GetBuffer();
+		const int length = buffer.getNumSamples();
+
+		std::vector<float> cycle((size_t)length, 0.0f);
+		for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+			for (int i = 0; i < length; ++i)
+				cycle[(size_t)i] += buffer.getSample(channel, i) / (float)buffer.getNumChannels();
+
+		auto table = std::make_shared<std::vector<float>>(WAVETABLE_SIZE + 1);
+		float peak = 0.0f;
+		for (int i = 0; i < WAVETABLE_SIZE; ++i)
+		{
+			const double position = (double)i * length / WAVETABLE_SIZE;
+			const int index = (int)position;
+			const float fraction = (float)(position - index);
+			const float sample0 = cycle[(size_t)index];
+			const float sample1 = cycle[(size_t)((index + 1) % length)];
+			(*table)[(size_t)i] = sample0 + fraction * (sample1 - sample0);
+			peak = juce::jmax(peak, std::abs((*table)[(size_t)i]));
+		}
+
+		if (peak > 0.0f)
+			for (auto& sample : *table)
+				sample /= peak;
+
+		(*table)[WAVETABLE_SIZE] = (*table)[0];
+		return table;
+	}
+}
 
 OscillatorAudioProcessor::OscillatorAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -14,9 +58,7 @@ OscillatorAudioProcessor::OscillatorAudioProcessor()
 {
 	addParameter(frequency = new juce::AudioParameterFloat("frequency", "Frequency", 0.0f, 20000.0f, 440.0f));
 
-	oscillator.initialise([](float x) {
-		return std::sin(x);
-		});
+	InitialiseOscillator();
 }
 
 OscillatorAudioProcessor::~OscillatorAudioProcessor()
@@ -102,31 +144,19 @@ void OscillatorAudioProcessor::releaseResources()
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool OscillatorAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-#if JucePlugin_IsMidiEffect
-	juce::ignoreUnused(layouts);
-	return true;
-#else
-	// This is the place where you check if the layout is supported.
-	// In this template code we only support mono or stereo.
-	// Some plugin hosts, such as certain GarageBand versions, will only
-	// load plugins that support stereo bus layouts.
-	if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-		&& layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-		return false;
-
-	// This checks if the input layout matches the output layout
-#if ! JucePlugin_IsSynth
-	if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-		return false;
-#endif
-
-	return true;
-#endif
+	return IsMatchingBusesLayout(layouts);
 }
 #endif
 
 void OscillatorAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+	const juce::SpinLock::ScopedTryLockType lock(oscillatorLock);
+	if (!lock.isLocked())
+	{
+		buffer.clear();
+		return;
+	}
+
 	if (*frequency != previousFrequency)
 	{
 		previousFrequency = *frequency;
@@ -146,21 +176,32 @@ bool OscillatorAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* OscillatorAudioProcessor::createEditor()
 {
-	return new juce::GenericAudioProcessorEditor(*this);
+	return new AssetEditor(*this, { "Load Wavetable...", "*.wav;*.aiff;*.flac",
+		[this](const juce::File& file) { return LoadWavetable(file); },
+		[this] { return GetWavetableFile(); } });
 }
 
 
 void OscillatorAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-	// You should use this method to store your parameters in the memory block.
-	// You could do that either as raw data, or use the XML or ValueTree classes
-	// as intermediaries to make it easy to save and load complex data.
+	juce::XmlElement xml("Oscillator");
+	xml.setAttribute(frequency->paramID, frequency->getValue());
+	xml.setAttribute("wavetable", wavetableFile.getFullPathName());
+	copyXmlToBinary(xml, destData);
 }
 
 void OscillatorAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
-	// You should use this method to restore your parameters from this memory block,
-	// whose contents will have been created by the getStateInformation() call.
+	auto xml = getXmlFromBinary(data, sizeInBytes);
+	if (xml == nullptr || !xml->hasTagName("Oscillator"))
+		return;
+
+	if (xml->hasAttribute(frequency->paramID))
+		frequency->setValueNotifyingHost((float)xml->getDoubleAttribute(frequency->paramID));
+
+	const auto path = xml->getStringAttribute("wavetable");
+	if (path.isNotEmpty() && juce::File::isAbsolutePath(path))
+		LoadWavetable(juce::File(path));
 }
 
 void OscillatorAudioProcessor::reset()
@@ -168,6 +209,49 @@ void OscillatorAudioProcessor::reset()
 	oscillator.reset();
 }
 
+bool OscillatorAudioProcessor::LoadWavetable(const juce::File& file)
+{
+	AssetOptions options;
+	options.maxSeconds = MAX_WAVETABLE_SECONDS;
+
+	auto asset = AssetCache::GetInstance().Load(file, options);
+	if (asset == nullptr)
+		return false;
+
+	auto table = AssetCache::GetInstance().GetDerived<std::vector<float>>(*asset, "Wavetable" + juce::String(WAVETABLE_SIZE), CreateWavetable);
+
+	{
+		const juce::SpinLock::ScopedLockType lock(oscillatorLock);
+		wavetableFile = file;
+		std::swap(wavetableAsset, asset);
+		std::swap(wavetable, table);
+		InitialiseOscillator();
+	}
+
+	// The previous table is released here, not on the audio thread.
+	return true;
+}
+
+void OscillatorAudioProcessor::InitialiseOscillator()
+{
+	if (wavetable == nullptr)
+	{
+		oscillator.initialise([](float x) {
+			return std::sin(x);
+			});
+		return;
+	}
+
+	// The phase runs from -pi to pi.
+	const float* table = wavetable->data();
+	oscillator.initialise([table](float x) {
+		const float position = (x + juce::MathConstants<float>::pi) * (WAVETABLE_SIZE / juce::MathConstants<float>::twoPi);
+		const int index = juce::jlimit(0, WAVETABLE_SIZE - 1, (int)position);
+		const float fraction = position - (float)index;
+		return table[index] + fraction * (table[index + 1] - table[index]);
+		});
+}
+
 
 // This creates new instances of the plugin..
 #ifdef EXPORT_CREATE_FILTER_FUNCTION
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "Common/AssetCache.h"
 
 class OscillatorAudioProcessor  : public juce::AudioProcessor
 {
@@ -38,10 +39,23 @@ public:
 
     void reset()override;
 
+    // Plays one cycle read from the file instead of a sine. The table is
+    // shared with every other instance using the same file.
+    bool LoadWavetable (const juce::File& file);
+    const juce::File& GetWavetableFile() const { return wavetableFile; }
+
 private:
+    void InitialiseOscillator();
+
     juce::dsp::Oscillator<float> oscillator;
     juce::AudioParameterFloat* frequency;
     float previousFrequency;
+
+    juce::File wavetableFile;
+    std::shared_ptr<const AudioAsset> wavetableAsset;
+    std::shared_ptr<const std::vector<float>> wavetable;
+    // Held while the message thread swaps the generator; the callback only try-locks.
+    juce::SpinLock oscillatorLock;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OscillatorAudioProcessor)
 };
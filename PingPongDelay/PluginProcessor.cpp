@@ -1,6 +1,7 @@
 
 
 #include "PluginProcessor.h"
+#include "Common/Utils.h"
 
 
 PingPongDelayAudioProcessor::PingPongDelayAudioProcessor()
@@ -62,7 +63,8 @@ bool PingPongDelayAudioProcessor::isMidiEffect() const
 
 double PingPongDelayAudioProcessor::getTailLengthSeconds() const
 {
-	return 0.0;
+	// Every bounce to the other side takes one delay time and is scaled by the feedback.
+	return SilenceDetector::FeedbackTail(mDelayParamDelayTime.GetHostValue(), mDelayParamFeedback.GetHostValue());
 }
 
 int PingPongDelayAudioProcessor::getNumPrograms()
@@ -93,20 +95,20 @@ void PingPongDelayAudioProcessor::changeProgramName(int index, const juce::Strin
 void PingPongDelayAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
 	const double smoothTime = 1e-3;
+	mDelayParamBalance.reset(sampleRate, smoothTime);
 	mDelayParamDelayTime.reset(sampleRate, smoothTime);
 	mDelayParamFeedback.reset(sampleRate, smoothTime);
 	mDelayParamMix.reset(sampleRate, smoothTime);
 
 	float maxDelayTime = mDelayParamDelayTime.maxValue;
-	mDelayBufferSamples = maxDelayTime * sampleRate + 1;
-	if (mDelayBufferSamples < 1)
-		mDelayBufferSamples = 1;
+	int32_t maxDelaySamples = (int32_t)(maxDelayTime * sampleRate) + 1;
 
-	mDelayBufferChannels = getTotalNumInputChannels();
-	mDelayBuffer.setSize(mDelayBufferChannels, mDelayBufferSamples);
-	mDelayBuffer.clear();
-
-	mDelayWritePosition = 0;
+	// Channels bounce in pairs, (0, 1), (2, 3) and so on across the bus.
+	const int numPairChannels = juce::jmax(2, getTotalNumInputChannels() & ~1);
+	mDelayLine.Prepare(numPairChannels, maxDelaySamples, samplesPerBlock);
+	mSilence.Prepare(sampleRate);
+	mDelayOutput.setSize(4, samplesPerBlock);
+	mParameterRamps.setSize(3, samplesPerBlock);
 }
 
 void PingPongDelayAudioProcessor::releaseResources()
@@ -118,26 +120,7 @@ void PingPongDelayAudioProcessor::releaseResources()
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool PingPongDelayAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-#if JucePlugin_IsMidiEffect
-	juce::ignoreUnused(layouts);
-	return true;
-#else
-	// This is the place where you check if the layout is supported.
-	// In this template code we only support mono or stereo.
-	// Some plugin hosts, such as certain GarageBand versions, will only
-	// load plugins that support stereo bus layouts.
-	if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-		&& layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-		return false;
-
-	// This checks if the input layout matches the output layout
-#if ! JucePlugin_IsSynth
-	if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-		return false;
-#endif
-
-	return true;
-#endif
+	return IsMatchingBusesLayout(layouts);
 }
 #endif
 
@@ -148,54 +131,89 @@ void PingPongDelayAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
 	auto totalNumOutputChannels = getTotalNumOutputChannels();
 	auto numSamples = buffer.getNumSamples();
 
-	float currentBalance = mDelayParamBalance.getNextValue() * 0.5f + 0.5f;
-	float currentDelayTime = mDelayParamDelayTime.getTargetValue() * (float)getSampleRate();
-	float currentFeedback = mDelayParamFeedback.getNextValue();
-	float currentMix = mDelayParamMix.getNextValue();
-
-	int localWritePosition = mDelayWritePosition;
+	// Ping-pong needs a left and a right channel to bounce between. Wider buses
+	// run one ping-pong per pair of channels, an odd last channel passes through.
+	for (int channel = totalNumInputChannels; channel < totalNumOutputChannels; ++channel)
+		buffer.clear(channel, 0, numSamples);
 
-	float* channelDataL = buffer.getWritePointer(0);
-	float* channelDataR = buffer.getWritePointer(1);
-	float* delayDataL = mDelayBuffer.getWritePointer(0);
-	float* delayDataR = mDelayBuffer.getWritePointer(1);
+	const int numPairs = juce::jmin(totalNumInputChannels, mDelayLine.GetNumChannels()) / 2;
+	if (numPairs == 0)
+		return;
 
-	for (int sample = 0; sample < numSamples; ++sample)
+	// With silent input and the last bounce gone, the output is silent.
+	// The ring still holds the audio from before the silence, which a longer
+	// delay or more feedback would play again, so it is cleared on falling asleep.
+	const bool wasSleeping = mSilence.IsSleeping();
+	if (mSilence.Process(buffer, numPairs * 2, getTailLengthSeconds()))
 	{
-		const float inL = (1.0f - currentBalance) * channelDataL[sample];
-		const float inR = currentBalance * channelDataR[sample];
-		float outL = 0.0f;
-		float outR = 0.0f;
+		if (!wasSleeping)
+			mDelayLine.Reset();
+		return;
+	}
+
+	UpdateParameters(mDelayParamBalance, mDelayParamDelayTime, mDelayParamFeedback, mDelayParamMix);
 
-		float readPosition = fmodf((float)localWritePosition - currentDelayTime + (float)mDelayBufferSamples, mDelayBufferSamples);
+	float currentDelayTime = mDelayParamDelayTime.getTargetValue() * (float)getSampleRate();
 
-		int localReadPosition = floorf(readPosition);
+	float* delayedDataL = mDelayOutput.getWritePointer(0);
+	float* delayedDataR = mDelayOutput.getWritePointer(1);
+	float* feedbackDataL = mDelayOutput.getWritePointer(2);
+	float* feedbackDataR = mDelayOutput.getWritePointer(3);
+	float* balanceRamp = mParameterRamps.getWritePointer(0);
+	float* feedbackRamp = mParameterRamps.getWritePointer(1);
+	float* mixRamp = mParameterRamps.getWritePointer(2);
 
-		if (localReadPosition != localWritePosition)
+	// A zero delay time leaves the signal untouched.
+	if (currentDelayTime > 0.0f)
+	{
+		for (int start = 0; start < numSamples;)
 		{
-			float fraction = readPosition - (float)localReadPosition;
-			float delayed1L = delayDataL[(localReadPosition + 0)];
-			float delayed1R = delayDataR[(localReadPosition + 0)];
-			float delayed2L = delayDataL[(localReadPosition + 1) % mDelayBufferSamples];
-			float delayed2R = delayDataR[(localReadPosition + 1) % mDelayBufferSamples];
-
-			outL = delayed1L + fraction * (delayed2L - delayed1L);
-			outR = delayed1R + fraction * (delayed2R - delayed1R);
-
-			channelDataL[sample] = inL + (outL - inL) * currentMix;
-			channelDataR[sample] = inR + (outR - inR) * currentMix;
-			delayDataL[localWritePosition] = inL + outR * currentFeedback;
-			delayDataR[localWritePosition] = inR + outL * currentFeedback;
+			const int chunkSamples = mDelayLine.GetChunkSize(currentDelayTime, numSamples - start);
+
+			mDelayParamBalance.RenderRamp(balanceRamp, chunkSamples);
+			mDelayParamFeedback.RenderRamp(feedbackRamp, chunkSamples);
+			mDelayParamMix.RenderRamp(mixRamp, chunkSamples);
+
+			mDelayLine.SetDelay(currentDelayTime, chunkSamples);
+
+			for (int pair = 0; pair < numPairs; ++pair)
+			{
+				const int left = pair * 2;
+				const int right = left + 1;
+				float* channelDataL = buffer.getWritePointer(left, start);
+				float* channelDataR = buffer.getWritePointer(right, start);
+
+				mDelayLine.Read<Interpolation::LINEAR>(left, delayedDataL, chunkSamples);
+				mDelayLine.Read<Interpolation::LINEAR>(right, delayedDataR, chunkSamples);
+
+				for (int sample = 0; sample < chunkSamples; ++sample)
+				{
+					const float balance = balanceRamp[sample] * 0.5f + 0.5f;
+					const float inL = (1.0f - balance) * channelDataL[sample];
+					const float inR = balance * channelDataR[sample];
+					const float outL = delayedDataL[sample];
+					const float outR = delayedDataR[sample];
+
+					channelDataL[sample] = inL + (outL - inL) * mixRamp[sample];
+					channelDataR[sample] = inR + (outR - inR) * mixRamp[sample];
+					feedbackDataL[sample] = inL + outR * feedbackRamp[sample];
+					feedbackDataR[sample] = inR + outL * feedbackRamp[sample];
+				}
+
+				mDelayLine.Write(left, feedbackDataL, chunkSamples);
+				mDelayLine.Write(right, feedbackDataR, chunkSamples);
+			}
+
+			mDelayLine.Advance(chunkSamples);
+			start += chunkSamples;
 		}
-
-		if (++localWritePosition >= mDelayBufferSamples)
-			localWritePosition -= mDelayBufferSamples;
 	}
-
-	mDelayWritePosition = localWritePosition;
-
-	for (int channel = totalNumInputChannels; channel < totalNumOutputChannels; ++channel)
-		buffer.clear(channel, 0, numSamples);
+	else
+	{
+		mDelayParamBalance.skip(numSamples);
+		mDelayParamFeedback.skip(numSamples);
+		mDelayParamMix.skip(numSamples);
+	}
 }
 
 
@@ -2,6 +2,8 @@
 
 #include <JuceHeader.h>
 #include "Common/PluginParameterSlider.h"
+#include "Common/DelayLine.h"
+#include "Common/SilenceDetector.h"
 
 class PingPongDelayAudioProcessor  : public juce::AudioProcessor
                             #if JucePlugin_Enable_ARA
@@ -46,17 +48,17 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
-	juce::AudioSampleBuffer mDelayBuffer;
-	int32_t mDelayBufferSamples;
-	int32_t mDelayBufferChannels;
-	int32_t mDelayWritePosition;
+	DelayLine mDelayLine;
+	SilenceDetector mSilence;
+	juce::AudioSampleBuffer mDelayOutput;
+	juce::AudioSampleBuffer mParameterRamps;
 
 	juce::AudioProcessorValueTreeState mDelayParameters;
 
-	PluginParameterSlider mDelayParamBalance;
-	PluginParameterSlider mDelayParamDelayTime;
-	PluginParameterSlider mDelayParamFeedback;
-	PluginParameterSlider mDelayParamMix;
+	PluginParameterSlider<> mDelayParamBalance;
+	PluginParameterSlider<> mDelayParamDelayTime;
+	PluginParameterSlider<> mDelayParamFeedback;
+	PluginParameterSlider<> mDelayParamMix;
 
 private:
     
@@ -1,6 +1,33 @@
 
 
 #include "PluginProcessor.h"
+#include "Common/Utils.h"
+#include "Common/AssetEditor.h"
+
+namespace
+{
+	// Longer responses are cut, which bounds what one instance can hold.
+	constexpr double MAX_IMPULSE_SECONDS = 20.0;
+
+	// Unit energy on the loudest channel, so responses of any length come out at a similar level.
+	std::shared_ptr<const ConvolutionImpulse> CreateImpulse(const AudioAsset& asset)
+	{
+		juce::AudioBuffer<float> response(asset.GetBuffer());
+
+		double energy = 0.0;
+		for (int channel = 0; channel < response.getNumChannels(); ++channel)
+		{
+			double channelEnergy = 0.0;
+			for (int i = 0; i < response.getNumSamples(); ++i)
+				channelEnergy += (double)response.getSample(channel, i) * response.getSample(channel, i);
+			energy = juce::jmax(energy, channelEnergy);
+		}
+		if (energy > 0.0)
+			response.applyGain((float)(1.0 / std::sqrt(energy)));
+
+		return ConvolutionImpulse::Create(response, asset.GetSampleRate());
+	}
+}
 
 
 ReverbAudioProcessor::ReverbAudioProcessor()
@@ -20,6 +47,8 @@ ReverbAudioProcessor::ReverbAudioProcessor()
 	addParameter(width = new juce::AudioParameterFloat("Width", "Width", 0.0f, 1.0f, 0.5f));
 	addParameter(dry_Wet = new juce::AudioParameterFloat("Dry/Wet", "Dry/Wet", 0.0f, 1.0f, 0.5f));
 	addParameter(freeze = new juce::AudioParameterFloat("Freeze", "Freeze",0.0f,1.0f,0.5f));
+	addParameter(mode = new juce::AudioParameterChoice("Mode", "Mode", { "Algorithmic", "Convolution", "FDN" }, ALGORITHMIC));
+	addParameter(fdnSize = new juce::AudioParameterChoice("FDN Size", "FDN Size", { "Auto", "8 Lines", "16 Lines", "32 Lines" }, 0));
 }
 
 ReverbAudioProcessor::~ReverbAudioProcessor()
@@ -61,7 +90,19 @@ bool ReverbAudioProcessor::isMidiEffect() const
 
 double ReverbAudioProcessor::getTailLengthSeconds() const
 {
-	return 0.0;
+	juce::dsp::Reverb::Parameters current;
+	current.roomSize = *roomSize;
+	current.freezeMode = *freeze;
+
+	switch (mode->getIndex())
+	{
+	case CONVOLUTION:
+		return impulseSeconds.load();
+	case FDN:
+		return FdnReverb::GetTailLengthSeconds(current);
+	default:
+		return StereoReverb::GetTailLengthSeconds(current);
+	}
 }
 
 int ReverbAudioProcessor::getNumPrograms()
@@ -91,14 +132,62 @@ void ReverbAudioProcessor::changeProgramName(int index, const juce::String& newN
 
 void ReverbAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-	juce::dsp::ProcessSpec spec;
+	const int numReverbs = (getTotalNumInputChannels() + 1) / 2;
+	reverbs.clear();
+	for (int i = 0; i < numReverbs; ++i)
+		reverbs.add(new StereoReverb())->Prepare(sampleRate);
+
+	autoNumLines = FdnReverb::GetAutoNumLines(sampleRate);
+	networks.clear();
+	for (int i = 0; i < numReverbs; ++i)
+		networks.add(new FdnReverb())->Prepare(sampleRate);
+
+	dryBuffer.setSize(juce::jmax(1, getTotalNumInputChannels()), samplesPerBlock);
+	silence.Prepare(sampleRate);
+	UpdateConvolver();
+}
 
-	spec.sampleRate = sampleRate;
-	spec.maximumBlockSize = samplesPerBlock;
-	spec.numChannels = 1;
+bool ReverbAudioProcessor::LoadImpulseResponse(const juce::File& file)
+{
+	if (!file.existsAsFile())
+		return false;
+
+	impulseFile = file;
+	UpdateConvolver();
+
+	// Before prepareToPlay nothing is read yet, the file is checked once the rate is known.
+	return getSampleRate() <= 0.0 || impulseAsset != nullptr;
+}
 
-	leftReverb.prepare(spec);
-	rightReverb.prepare(spec);
+void ReverbAudioProcessor::UpdateConvolver()
+{
+	std::unique_ptr<PartitionedConvolver> newConvolver;
+	impulseAsset = nullptr;
+
+	if (impulseFile != juce::File() && getSampleRate() > 0.0)
+	{
+		AssetOptions options;
+		options.sampleRate = getSampleRate();
+		options.maxSeconds = MAX_IMPULSE_SECONDS;
+
+		// Instances using the same file at the same rate share the decoded
+		// response and its spectra, only the first one computes them.
+		impulseAsset = AssetCache::GetInstance().Load(impulseFile, options);
+		if (impulseAsset != nullptr)
+		{
+			newConvolver = std::make_unique<PartitionedConvolver>();
+			newConvolver->Prepare(AssetCache::GetInstance().GetDerived<ConvolutionImpulse>(*impulseAsset, "ConvolutionImpulse", CreateImpulse),
+				juce::jmax(1, getTotalNumInputChannels()));
+		}
+	}
+
+	{
+		const juce::SpinLock::ScopedLockType lock(convolverLock);
+		std::swap(convolver, newConvolver);
+	}
+	impulseSeconds = impulseAsset != nullptr ? impulseAsset->GetLength() / impulseAsset->GetSampleRate() : 0.0;
+
+	// The old convolver leaves the worker pool here, not on the audio thread.
 }
 
 void ReverbAudioProcessor::releaseResources()
@@ -110,26 +199,7 @@ void ReverbAudioProcessor::releaseResources()
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool ReverbAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-#if JucePlugin_IsMidiEffect
-	juce::ignoreUnused(layouts);
-	return true;
-#else
-	// This is the place where you check if the layout is supported.
-	// In this template code we only support mono or stereo.
-	// Some plugin hosts, such as certain GarageBand versions, will only
-	// load plugins that support stereo bus layouts.
-	if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-		&& layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-		return false;
-
-	// This checks if the input layout matches the output layout
-#if ! JucePlugin_IsSynth
-	if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-		return false;
-#endif
-
-	return true;
-#endif
+	return IsMatchingBusesLayout(layouts);
 }
 #endif
 
@@ -155,20 +225,91 @@ void ReverbAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::
 	params.dryLevel = 1.0f-params.wetLevel;
 	params.freezeMode = *freeze;
 
-	leftReverb.setParameters(params);
-	rightReverb.setParameters(params);
+	const int numChannels = juce::jmin(totalNumInputChannels, buffer.getNumChannels());
+
+	// With silent input and the tail died away, the output is silent. The
+	// convolver is not reset, since that waits for its workers; what it holds
+	// by now is below the threshold.
+	const bool wasSleeping = silence.IsSleeping();
+	if (silence.Process(buffer, numChannels, getTailLengthSeconds()))
+	{
+		if (!wasSleeping)
+		{
+			for (auto* reverb : reverbs)
+				reverb->Reset();
+			for (auto* network : networks)
+				network->Reset();
+		}
+		return;
+	}
+
+	if (mode->getIndex() == CONVOLUTION)
+	{
+		ProcessConvolution(buffer, numChannels);
+		return;
+	}
+
+	if (mode->getIndex() == FDN)
+	{
+		ProcessNetworks(buffer, numChannels);
+		return;
+	}
+
+	for (int i = 0; i < reverbs.size() && i * 2 < numChannels; ++i)
+	{
+		float* right = i * 2 + 1 < numChannels ? buffer.getWritePointer(i * 2 + 1) : nullptr;
+
+		reverbs[i]->SetParameters(params);
+		reverbs[i]->Process(buffer.getWritePointer(i * 2), right, buffer.getNumSamples());
+	}
+}
+
+
+void ReverbAudioProcessor::ProcessConvolution(juce::AudioBuffer<float>& buffer, int numChannels)
+{
+	const juce::SpinLock::ScopedTryLockType lock(convolverLock);
+
+	// Without a response, or while a new one is swapped in, the input passes through.
+	if (!lock.isLocked() || convolver == nullptr || numChannels < dryBuffer.getNumChannels())
+		return;
 
 	juce::dsp::AudioBlock<float> block(buffer);
+	const int maxBlockSize = dryBuffer.getNumSamples();
+	convolver->SetNonRealtime(isNonRealtime());
+
+	for (int offset = 0; offset < buffer.getNumSamples(); offset += maxBlockSize)
+	{
+		const int numSamples = juce::jmin(maxBlockSize, buffer.getNumSamples() - offset);
 
-	if (block.getNumChannels() > 2)
-		block = block.getSubsetChannelBlock(0, 2);
+		for (int channel = 0; channel < dryBuffer.getNumChannels(); ++channel)
+			dryBuffer.copyFrom(channel, 0, buffer, channel, offset, numSamples);
 
-	juce::dsp::ProcessContextReplacing<float> leftContext(block);
-	juce::dsp::ProcessContextReplacing<float> rightContext(block);
-	leftReverb.process(leftContext);
-	rightReverb.process(rightContext);
+		convolver->Process(block.getSubsetChannelBlock(0, (size_t)dryBuffer.getNumChannels()).getSubBlock((size_t)offset, (size_t)numSamples));
+
+		for (int channel = 0; channel < dryBuffer.getNumChannels(); ++channel)
+		{
+			buffer.applyGain(channel, offset, numSamples, params.wetLevel);
+			buffer.addFrom(channel, offset, dryBuffer, channel, 0, numSamples, params.dryLevel);
+		}
+	}
 }
 
+void ReverbAudioProcessor::ProcessNetworks(juce::AudioBuffer<float>& buffer, int numChannels)
+{
+	// "Auto", then 8, 16 and 32 lines.
+	const int numLines = fdnSize->getIndex() == 0 ? autoNumLines : 4 << fdnSize->getIndex();
+
+	for (int i = 0; i < networks.size() && i * 2 < numChannels; ++i)
+	{
+		float* right = i * 2 + 1 < numChannels ? buffer.getWritePointer(i * 2 + 1) : nullptr;
+
+		if (networks[i]->GetNumLines() != numLines)
+			networks[i]->SetNumLines(numLines);
+
+		networks[i]->SetParameters(params);
+		networks[i]->Process(buffer.getWritePointer(i * 2), right, buffer.getNumSamples());
+	}
+}
 
 bool ReverbAudioProcessor::hasEditor() const
 {
@@ -177,21 +318,38 @@ bool ReverbAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* ReverbAudioProcessor::createEditor()
 {
-	return new juce::GenericAudioProcessorEditor(*this);
+	return new AssetEditor(*this, { "Load IR...", "*.wav;*.aiff;*.flac",
+		[this](const juce::File& file) { return LoadImpulseResponse(file); },
+		[this] { return GetImpulseResponseFile(); } });
 }
 
 
 void ReverbAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-	// You should use this method to store your parameters in the memory block.
-	// You could do that either as raw data, or use the XML or ValueTree classes
-	// as intermediaries to make it easy to save and load complex data.
+	juce::XmlElement xml("Reverb");
+
+	for (auto* parameter : getParameters())
+		if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+			xml.setAttribute(ranged->paramID, ranged->getValue());
+
+	xml.setAttribute("impulseResponse", impulseFile.getFullPathName());
+	copyXmlToBinary(xml, destData);
 }
 
 void ReverbAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
-	// You should use this method to restore your parameters from this memory block,
-	// whose contents will have been created by the getStateInformation() call.
+	auto xml = getXmlFromBinary(data, sizeInBytes);
+	if (xml == nullptr || !xml->hasTagName("Reverb"))
+		return;
+
+	for (auto* parameter : getParameters())
+		if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+			if (xml->hasAttribute(ranged->paramID))
+				ranged->setValueNotifyingHost((float)xml->getDoubleAttribute(ranged->paramID));
+
+	const auto path = xml->getStringAttribute("impulseResponse");
+	if (path.isNotEmpty() && juce::File::isAbsolutePath(path))
+		LoadImpulseResponse(juce::File(path));
 }
 
 
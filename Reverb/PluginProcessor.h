@@ -1,6 +1,12 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "Common/AssetCache.h"
+#include "Common/FdnReverb.h"
+#include "Common/PartitionedConvolver.h"
+#include "Common/SilenceDetector.h"
+#include "Common/StereoReverb.h"
+
 class ReverbAudioProcessor  : public juce::AudioProcessor
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
@@ -44,14 +50,47 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    // Loads an impulse response for the convolution mode. It is resampled to
+    // the processing rate, and shared with every other instance using it.
+    bool LoadImpulseResponse(const juce::File& file);
+    const juce::File& GetImpulseResponseFile() const { return impulseFile; }
+
+    enum Mode
+    {
+        ALGORITHMIC,
+        CONVOLUTION,
+        FDN
+    };
+
 private:
+    void UpdateConvolver();
+    void ProcessConvolution(juce::AudioBuffer<float>& buffer, int numChannels);
+    void ProcessNetworks(juce::AudioBuffer<float>& buffer, int numChannels);
+
     juce::AudioParameterFloat* roomSize;
     juce::AudioParameterFloat* damping;
     juce::AudioParameterFloat* width;
     juce::AudioParameterFloat* dry_Wet;
     juce::AudioParameterFloat* freeze;
+    juce::AudioParameterChoice* mode;
+    juce::AudioParameterChoice* fdnSize;
     juce::dsp::Reverb::Parameters params;
-    juce::dsp::Reverb leftReverb, rightReverb;
+    // One stereo reverb per pair of channels, an odd last channel gets a mono one.
+    juce::OwnedArray<StereoReverb> reverbs;
+    juce::OwnedArray<FdnReverb> networks;
+    // What "Auto" stands for at the rate given to prepareToPlay.
+    int autoNumLines = 8;
+
+    juce::File impulseFile;
+    std::shared_ptr<const AudioAsset> impulseAsset;
+    // Swapped in by the message thread; the callback only ever try-locks.
+    std::unique_ptr<PartitionedConvolver> convolver;
+    juce::SpinLock convolverLock;
+    juce::AudioBuffer<float> dryBuffer;
+    // Length of the loaded response, for getTailLengthSeconds() on any thread.
+    std::atomic<double> impulseSeconds { 0.0 };
+
+    SilenceDetector silence;
 
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReverbAudioProcessor)
@@ -1,5 +1,6 @@
 
 #include "PluginProcessor.h"
+#include "Common/Utils.h"
 
 
 
@@ -88,23 +89,9 @@ void SimpleDistortionAudioProcessor::changeProgramName (int index, const juce::S
 
 void SimpleDistortionAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    processChain.reset();
-
-    juce::dsp::ProcessSpec spec;
-    spec.numChannels = 2;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.sampleRate = sampleRate;
-
-    processChain.prepare(spec);
-
-    auto& waveShaper = processChain.get<waveShaperIndex>();
-    waveShaper.functionToUse = [](float x)
-    {
-        return juce::jlimit(-0.1f, 0.1f, x);
-    };
-
 	auto phase = *invertPhase ? -1.0f : 1.0f;
 	previousGain = *gain;
+	silence.Prepare(sampleRate);
 }
 
 void SimpleDistortionAudioProcessor::releaseResources()
@@ -116,31 +103,16 @@ void SimpleDistortionAudioProcessor::releaseResources()
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool SimpleDistortionAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
-  #if JucePlugin_IsMidiEffect
-    juce::ignoreUnused (layouts);
-    return true;
-  #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
-
-    // This checks if the input layout matches the output layout
-   #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-        return false;
-   #endif
-
-    return true;
-  #endif
+    return IsMatchingBusesLayout (layouts);
 }
 #endif
 
 void SimpleDistortionAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+	// Nothing here has memory, so silence in is silence out straight away.
+	if (silence.Process(buffer, getTotalNumInputChannels(), getTailLengthSeconds()))
+		return;
+
 	auto phase = *invertPhase ? -1.0f : 1.0f;
 	auto currentGain = gain->get() * phase;
 	if (currentGain == previousGain)
@@ -156,11 +128,7 @@ void SimpleDistortionAudioProcessor::processBlock (juce::AudioBuffer<float>& buf
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     juce::dsp::AudioBlock<float> block(buffer);
-    if (block.getNumChannels() > 2)
-        block = block.getSubsetChannelBlock(0, 2);
-
-	juce::dsp::ProcessContextReplacing<float> context(block);
-	processChain.process(context);
+	Waveshapers::Shape(block, clipper);
 }
 
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "Common/SilenceDetector.h"
+#include "Common/Waveshapers.h"
 
 class SimpleDistortionAudioProcessor  : public juce::AudioProcessor
                             #if JucePlugin_Enable_ARA
@@ -47,16 +49,13 @@ public:
 
 private:
 
-    enum
-    {
-        waveShaperIndex
-    };
-
-    juce::dsp::ProcessorChain<juce::dsp::WaveShaper<float>> processChain;
+    // Clips at -20 dBFS, a whole block at a time.
+    Waveshapers::HardClip clipper{ 0.1f };
 
 	juce::AudioParameterFloat* gain;
 	juce::AudioParameterBool* invertPhase;
 	float previousGain;
+	SilenceDetector silence;
 
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleDistortionAudioProcessor)
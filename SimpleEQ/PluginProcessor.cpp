@@ -1,6 +1,7 @@
 
 
 #include "PluginProcessor.h"
+#include "Common/Utils.h"
 
 
 SimpleEQAudioProcessor::SimpleEQAudioProcessor()
@@ -85,7 +86,9 @@ bool SimpleEQAudioProcessor::isMidiEffect() const
 
 double SimpleEQAudioProcessor::getTailLengthSeconds() const
 {
-	return 0.0;
+	// Each cut rings at its frequency for as long as its quality lets it.
+	return juce::jmax(SilenceDetector::ResonanceTail(*lowCutFreq, *lowCutQuality),
+		SilenceDetector::ResonanceTail(*highCutFreq, *highCutQuality));
 }
 
 int SimpleEQAudioProcessor::getNumPrograms()
@@ -115,25 +118,12 @@ void SimpleEQAudioProcessor::changeProgramName(int index, const juce::String& ne
 
 void SimpleEQAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-	juce::dsp::ProcessSpec spec;
-	spec.maximumBlockSize = samplesPerBlock;
-	spec.numChannels = 1;
-	spec.sampleRate = sampleRate;
+	cascade.Prepare(juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()), 2, samplesPerBlock);
 
-	leftChain.prepare(spec);
-	rightChain.prepare(spec);
+	silence.Prepare(sampleRate);
 
-	auto lowCutCoefficients = juce::dsp::IIR::Coefficients<float>::makeHighPass(getSampleRate(),
-		*lowCutFreq,
-		*lowCutQuality); 
-	leftChain.get<0>().coefficients = *lowCutCoefficients;
-	rightChain.get<0>().coefficients = *lowCutCoefficients;
-
-	auto highCutCoefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(getSampleRate(),
-		*highCutFreq,
-		*highCutQuality);
-	leftChain.get<1>().coefficients = *highCutCoefficients;
-	rightChain.get<1>().coefficients = *highCutCoefficients;
+	designedSampleRate = 0.0;
+	updateFilters(sampleRate);
 }
 
 void SimpleEQAudioProcessor::releaseResources()
@@ -145,26 +135,7 @@ void SimpleEQAudioProcessor::releaseResources()
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool SimpleEQAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-#if JucePlugin_IsMidiEffect
-	juce::ignoreUnused(layouts);
-	return true;
-#else
-	// This is the place where you check if the layout is supported.
-	// In this template code we only support mono or stereo.
-	// Some plugin hosts, such as certain GarageBand versions, will only
-	// load plugins that support stereo bus layouts.
-	if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-		&& layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-		return false;
-
-	// This checks if the input layout matches the output layout
-#if ! JucePlugin_IsSynth
-	if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-		return false;
-#endif
-
-	return true;
-#endif
+	return IsMatchingBusesLayout(layouts);
 }
 #endif
 
@@ -174,30 +145,43 @@ void SimpleEQAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce
 	auto totalNumInputChannels = getTotalNumInputChannels();
 	auto totalNumOutputChannels = getTotalNumOutputChannels();
 
-	auto lowCutCoefficients = juce::dsp::IIR::Coefficients<float>::makeHighPass(getSampleRate(),
-		*lowCutFreq,
-		*lowCutQuality);
-	leftChain.get<0>().coefficients = *lowCutCoefficients;
-	rightChain.get<0>().coefficients = *lowCutCoefficients;
+	// With silent input and the filters rung out, the output is silent.
+	// Resonant cuts boost around their frequency, which lowers the threshold.
+	const float maxGain = SilenceDetector::ResonanceGain(*lowCutQuality) * SilenceDetector::ResonanceGain(*highCutQuality);
+	const bool wasSleeping = silence.IsSleeping();
+	if (silence.Process(buffer, buffer.getNumChannels(), getTailLengthSeconds(), maxGain))
+	{
+		if (!wasSleeping)
+			cascade.Reset();
+		return;
+	}
 
-	auto highCutCoefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(getSampleRate(),
-		*highCutFreq,
-		*highCutQuality);
-	leftChain.get<1>().coefficients = *highCutCoefficients;
-	rightChain.get<1>().coefficients = *highCutCoefficients;
+	updateFilters(getSampleRate());
 
 	juce::dsp::AudioBlock<float> block(buffer);
+	cascade.Process(block);
+}
 
-	auto leftBlock = block.getSingleChannelBlock(0);
-	auto rightBlock = block.getSingleChannelBlock(1);
 
-	juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-	juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+void SimpleEQAudioProcessor::updateFilters(double sampleRate)
+{
+	const bool sampleRateChanged = sampleRate != designedSampleRate;
+	designedSampleRate = sampleRate;
 
-	leftChain.process(leftContext);
-	rightChain.process(rightContext);
-}
+	if (sampleRateChanged || *lowCutFreq != designedLowCut[0] || *lowCutQuality != designedLowCut[1])
+	{
+		designedLowCut[0] = *lowCutFreq;
+		designedLowCut[1] = *lowCutQuality;
+		cascade.SetSection(0, BiquadDesign::HighPass(sampleRate, designedLowCut[0], designedLowCut[1]));
+	}
 
+	if (sampleRateChanged || *highCutFreq != designedHighCut[0] || *highCutQuality != designedHighCut[1])
+	{
+		designedHighCut[0] = *highCutFreq;
+		designedHighCut[1] = *highCutQuality;
+		cascade.SetSection(1, BiquadDesign::LowPass(sampleRate, designedHighCut[0], designedHighCut[1]));
+	}
+}
 
 bool SimpleEQAudioProcessor::hasEditor() const
 {
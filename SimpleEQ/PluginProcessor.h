@@ -1,6 +1,8 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "Common/BiquadCascade.h"
+#include "Common/SilenceDetector.h"
 class SimpleEQAudioProcessor : public juce::AudioProcessor
 #if JucePlugin_Enable_ARA
 	, public juce::AudioProcessorARAExtension
@@ -51,7 +53,17 @@ private:
 	juce::AudioParameterFloat* highCutFreq;
 	juce::AudioParameterFloat* highCutQuality;
 
-	juce::dsp::ProcessorChain< juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Filter<float>> leftChain, rightChain;
+	// Low cut in section 0 and high cut in section 1, all channels at once.
+	BiquadCascade cascade;
+	SilenceDetector silence;
+
+	// Redesigns a cut filter only when its frequency, quality or the sample rate
+	// changed.
+	void updateFilters(double sampleRate);
+
+	float designedLowCut[2] = {};
+	float designedHighCut[2] = {};
+	double designedSampleRate = 0.0;
 
 	
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SimpleEQAudioProcessor)
@@ -1,7 +1,16 @@
 
 
 #include "PluginProcessor.h"
+#include "Common/Utils.h"
 
+namespace
+{
+	// Quality of the most resonant section of a Butterworth filter of the given order.
+	double ButterworthQuality(int order)
+	{
+		return 1.0 / (2.0 * std::sin(juce::MathConstants<double>::pi / (2.0 * order)));
+	}
+}
 
 ThreeBandEqualizerAudioProcessor::ThreeBandEqualizerAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -57,7 +66,11 @@ bool ThreeBandEqualizerAudioProcessor::isMidiEffect() const
 
 double ThreeBandEqualizerAudioProcessor::getTailLengthSeconds() const
 {
-	return 0.0;
+	// Whichever filter rings longest, the cuts at the quality of their slope.
+	const auto settings = getChainSettings(apvts);
+	return juce::jmax(SilenceDetector::ResonanceTail(settings.peakFreq, settings.peakQuality),
+		SilenceDetector::ResonanceTail(settings.lowCutFreq, ButterworthQuality(2 * (settings.lowCutSlope + 1))),
+		SilenceDetector::ResonanceTail(settings.highCutFreq, ButterworthQuality(2 * (settings.highCutSlope + 1))));
 }
 
 int ThreeBandEqualizerAudioProcessor::getNumPrograms()
@@ -87,32 +100,12 @@ void ThreeBandEqualizerAudioProcessor::changeProgramName(int index, const juce::
 
 void ThreeBandEqualizerAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-	juce::dsp::ProcessSpec spec;
-	spec.maximumBlockSize = samplesPerBlock;
-	spec.numChannels = 1;
-	spec.sampleRate = sampleRate;
-
-	leftChain.prepare(spec);
-	rightChain.prepare(spec);
+	cascade.Prepare(juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()), ChainIndex::NumSlots, samplesPerBlock);
 
-	auto chainSettings = getChainSettings(apvts); 
-	updatePeakFilter(chainSettings);
+	silence.Prepare(sampleRate);
 
-	auto lowCutCoefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, 2 * (chainSettings.lowCutSlope + 1));
-
-	auto& leftLowCut = leftChain.get<ChainIndex::LowCut>();
-	auto& rightLowCut = rightChain.get<ChainIndex::LowCut>(); 
-	
-	updateCutFilter(leftLowCut, lowCutCoefficients, (Slope)chainSettings.lowCutSlope);
-	updateCutFilter(rightLowCut, lowCutCoefficients, (Slope)chainSettings.lowCutSlope);
-
-	auto highCutCoefficient = juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq,sampleRate, 2 * (chainSettings.highCutSlope + 1));
-
-	auto& leftHighCut = leftChain.get<ChainIndex::HighCut>();
-	auto& rightHighCut = rightChain.get<ChainIndex::HighCut>();
-
-	updateCutFilter(leftHighCut, highCutCoefficient, (Slope)chainSettings.highCutSlope);
-	updateCutFilter(rightHighCut, highCutCoefficient, (Slope)chainSettings.highCutSlope);
+	designedSampleRate = 0.0;
+	updateFilters(getChainSettings(apvts), sampleRate);
 }
 
 void ThreeBandEqualizerAudioProcessor::releaseResources()
@@ -124,26 +117,7 @@ void ThreeBandEqualizerAudioProcessor::releaseResources()
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool ThreeBandEqualizerAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-#if JucePlugin_IsMidiEffect
-	juce::ignoreUnused(layouts);
-	return true;
-#else
-	// This is the place where you check if the layout is supported.
-	// In this template code we only support mono or stereo.
-	// Some plugin hosts, such as certain GarageBand versions, will only
-	// load plugins that support stereo bus layouts.
-	if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-		&& layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-		return false;
-
-	// This checks if the input layout matches the output layout
-#if ! JucePlugin_IsSynth
-	if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-		return false;
-#endif
-
-	return true;
-#endif
+	return IsMatchingBusesLayout(layouts);
 }
 #endif
 
@@ -162,36 +136,24 @@ void ThreeBandEqualizerAudioProcessor::processBlock(juce::AudioBuffer<float>& bu
 	for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
 		buffer.clear(i, 0, buffer.getNumSamples());
 
+	// With silent input and the filters rung out, the output is silent.
+	// The peak filter may boost, which lowers the threshold; the Butterworth
+	// cuts never do.
 	auto chainSettings = getChainSettings(apvts);
+	const bool wasSleeping = silence.IsSleeping();
+	if (silence.Process(buffer, totalNumInputChannels, getTailLengthSeconds(),
+						juce::Decibels::decibelsToGain(juce::jmax(0.0f, chainSettings.peakChainInDecibels))))
+	{
+		if (!wasSleeping)
+			cascade.Reset();
+		return;
+	}
 
-	updatePeakFilter(chainSettings);
-
-	auto lowCutCoefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, getSampleRate(), 2 * (chainSettings.lowCutSlope + 1));
-
-	auto& leftLowCut = leftChain.get<ChainIndex::LowCut>();
-	auto& rightLowCut = rightChain.get<ChainIndex::LowCut>();
-
-	updateCutFilter(leftLowCut, lowCutCoefficients, (Slope)chainSettings.lowCutSlope);
-	updateCutFilter(rightLowCut, lowCutCoefficients, (Slope)chainSettings.lowCutSlope);
-
-	auto highCutCoefficient = juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, getSampleRate(), 2 * (chainSettings.highCutSlope + 1));
-
-	auto& leftHighCut = leftChain.get<ChainIndex::HighCut>();
-	auto& rightHighCut = rightChain.get<ChainIndex::HighCut>();
-
-	updateCutFilter(leftHighCut, highCutCoefficient, (Slope)chainSettings.highCutSlope);
-	updateCutFilter(rightHighCut, highCutCoefficient, (Slope)chainSettings.highCutSlope);
+	if (chainSettings != designedSettings || getSampleRate() != designedSampleRate)
+		updateFilters(chainSettings, getSampleRate());
 
 	juce::dsp::AudioBlock<float> block(buffer);
-
-	auto leftBlock = block.getSingleChannelBlock(0);
-	auto rightBlock = block.getSingleChannelBlock(1);
-
-	juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-	juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
-
-	leftChain.process(leftContext);
-	rightChain.process(rightContext);
+	cascade.Process(block);
 }
 
 
@@ -244,15 +206,34 @@ juce::AudioProcessorValueTreeState::ParameterLayout ThreeBandEqualizerAudioProce
 	return layout;
 }
 
-void ThreeBandEqualizerAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings)
+void ThreeBandEqualizerAudioProcessor::updateFilters(const ChainSettings& chainSettings, double sampleRate)
 {
-	auto peakCoefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(), chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakChainInDecibels));
+	cascade.SetSection(ChainIndex::Peak, BiquadDesign::Peak(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakChainInDecibels)));
 
-	*leftChain.get<ChainIndex::Peak>().coefficients = *peakCoefficients;
-	*rightChain.get<ChainIndex::Peak>().coefficients = *peakCoefficients;
+	BiquadCoefficients sections[4];
+
+	int numSections = BiquadDesign::ButterworthHighPass(sampleRate, chainSettings.lowCutFreq, 2 * (chainSettings.lowCutSlope + 1), sections);
+	updateCutFilter(ChainIndex::LowCut, sections, numSections);
+
+	numSections = BiquadDesign::ButterworthLowPass(sampleRate, chainSettings.highCutFreq, 2 * (chainSettings.highCutSlope + 1), sections);
+	updateCutFilter(ChainIndex::HighCut, sections, numSections);
+
+	designedSettings = chainSettings;
+	designedSampleRate = sampleRate;
+}
+
+void ThreeBandEqualizerAudioProcessor::updateCutFilter(int firstSlot, const BiquadCoefficients* sections, int numSections)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		if (i < numSections)
+			cascade.SetSection(firstSlot + i, sections[i]);
+
+		cascade.SetSectionEnabled(firstSlot + i, i < numSections);
+	}
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+ChainSettings getChainSettings(const juce::AudioProcessorValueTreeState& apvts)
 {
 	ChainSettings settings;
 	settings.lowCutFreq = apvts.getRawParameterValue("LowCutFreq")->load();
@@ -1,12 +1,17 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "Common/BiquadCascade.h"
+#include "Common/SilenceDetector.h"
 
+// Slots of the filter cascade: up to four low cut sections, the peak and up to
+// four high cut sections.
 enum ChainIndex
 {
-	LowCut,
-	Peak,
-	HighCut
+	LowCut = 0,
+	Peak = 4,
+	HighCut = 5,
+	NumSlots = 9
 };
 
 enum Slope
@@ -26,9 +31,17 @@ struct ChainSettings
 	int32_t lowCutSlope = SLOPE_12;
 	float highCutFreq = 0.0f;
 	int32_t highCutSlope = SLOPE_12;
+
+	bool operator==(const ChainSettings& other) const
+	{
+		return peakFreq == other.peakFreq && peakChainInDecibels == other.peakChainInDecibels && peakQuality == other.peakQuality
+			&& lowCutFreq == other.lowCutFreq && lowCutSlope == other.lowCutSlope
+			&& highCutFreq == other.highCutFreq && highCutSlope == other.highCutSlope;
+	}
+	bool operator!=(const ChainSettings& other) const { return !(*this == other); }
 };
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+ChainSettings getChainSettings(const juce::AudioProcessorValueTreeState& apvts);
 
 class ThreeBandEqualizerAudioProcessor : public juce::AudioProcessor
 #if JucePlugin_Enable_ARA
@@ -75,69 +88,21 @@ public:
 
 private:
 
-	using Filter = juce::dsp::IIR::Filter<float>;
-	using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-	using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
-
 	juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
-	void updatePeakFilter(const ChainSettings& chainSettings);
 
-	template<typename ChainType, typename CoefficientType>
-	void updateCutFilter(ChainType& leftLowCut,const CoefficientType& cutCoefficients,const Slope& lowCutSlope);
+	// Coefficients are only redesigned when the settings or the sample rate
+	// change, and are written into the cascade slots between two blocks.
+	void updateFilters(const ChainSettings& chainSettings, double sampleRate);
+	void updateCutFilter(int firstSlot, const BiquadCoefficients* sections, int numSections);
+
+	BiquadCascade cascade;
+	SilenceDetector silence;
 
-	MonoChain leftChain, rightChain;
+	ChainSettings designedSettings;
+	double designedSampleRate = 0.0;
 
 	juce::AudioProcessorValueTreeState apvts;
 
 	
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ThreeBandEqualizerAudioProcessor)
 };
-
-template<typename ChainType, typename CoefficientType>
-inline void ThreeBandEqualizerAudioProcessor::updateCutFilter(ChainType& leftLowCut, const CoefficientType& cutCoefficients, const Slope& lowCutSlope)
-{
-	leftLowCut.template setBypassed<0>(true);
-	leftLowCut.template setBypassed<1>(true);
-	leftLowCut.template setBypassed<2>(true);
-	leftLowCut.template setBypassed<3>(true);
-
-	switch (lowCutSlope)
-	{
-	case SLOPE_12:
-	{
-		*leftLowCut.template get<0>().coefficients = *cutCoefficients[0];
-		leftLowCut.template setBypassed<0>(false);
-		break;
-	}
-	case SLOPE_24:
-	{
-		*leftLowCut.template get<0>().coefficients = *cutCoefficients[0];
-		leftLowCut.template setBypassed<0>(false);
-		*leftLowCut.template get<1>().coefficients = *cutCoefficients[1];
-		leftLowCut.template setBypassed<1>(false);
-		break;
-	}
-	case SLOPE_36:
-	{
-		*leftLowCut.template get<0>().coefficients = *cutCoefficients[0];
-		leftLowCut.template setBypassed<0>(false);
-		*leftLowCut.template get<1>().coefficients = *cutCoefficients[1];
-		leftLowCut.template setBypassed<1>(false);
-		*leftLowCut.template get<2>().coefficients = *cutCoefficients[2];
-		leftLowCut.template setBypassed<2>(false);
-		break;
-	}
-	case SLOPE_48:
-	{
-		*leftLowCut.template get<0>().coefficients = *cutCoefficients[0];
-		leftLowCut.template setBypassed<0>(false);
-		*leftLowCut.template get<1>().coefficients = *cutCoefficients[1];
-		leftLowCut.template setBypassed<1>(false);
-		*leftLowCut.template get<2>().coefficients = *cutCoefficients[2];
-		leftLowCut.template setBypassed<2>(false);
-		*leftLowCut.template get<3>().coefficients = *cutCoefficients[3];
-		leftLowCut.template setBypassed<3>(false);
-		break;
-	}
-	}
-}